@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "modified_irr.h"
+#include "portfolio.h"
+
+//----------------------------------------------------------------------------------
+//	MIRR (Modified Internal Rate of Return)
+namespace mirr {
+
+	//----------------------------------------------------------------------------------
+	// The rate found for one series of cash flows in a batch, whether or not the search
+	// for it succeeded and what it cost.
+	struct BatchResult {
+		Rate_t			rate_ = 0.0;
+		solve_status_e	status_ = solve_status_e::failed;
+		std::int32_t	iterations_ = 0;
+		std::int32_t	evaluations_ = 0;
+		std::int64_t	nanoseconds_ = 0; // Time taken to search including compiling the cash flows.
+		double			residual_ = std::numeric_limits<double>::quiet_NaN(); // NPV at the rate found by a mixed precision search.
+	};
+
+	//----------------------------------------------------------------------------------
+	// A summary of a batch's results: how many searches succeeded, the throughput and
+	// the spread of the time each search took.
+	struct BatchStats {
+		std::size_t		count_ = 0;
+		std::size_t		solved_ = 0;
+		std::size_t		not_bracketed_ = 0;
+		std::size_t		failed_ = 0;
+		double			seconds_ = 0.0;			// Elapsed time for the whole batch.
+		double			per_second_ = 0.0;		// Searches per second of elapsed time.
+		double			mean_evaluations_ = 0.0;
+		std::int64_t	p50_nanoseconds_ = 0;
+		std::int64_t	p90_nanoseconds_ = 0;
+		std::int64_t	p99_nanoseconds_ = 0;
+		std::int64_t	p999_nanoseconds_ = 0;
+		std::int64_t	max_nanoseconds_ = 0;
+		double			max_residual_ = 0.0;	// Largest absolute residual of the searches that report one.
+	};
+
+	//----------------------------------------------------------------------------------
+	// Summarize the results of a batch that took in_seconds of elapsed time.
+	BatchStats	CalculateBatchStats(const std::vector<BatchResult>& in_results, double in_seconds);
+
+	//----------------------------------------------------------------------------------
+	// Return the name of a search's outcome for reporting.
+	const char*	SolveStatusName(solve_status_e in_status);
+
+	//----------------------------------------------------------------------------------
+	// Find the rates of return for many series of cash flows (e.g. every account in a
+	// portfolio) by spreading them over a pool of worker threads.  Each worker uses
+	// its own Calculator so the searches do not share any state.
+	class BatchCalculator {
+
+	public:
+		// A thread count of zero uses one thread per hardware core.
+		BatchCalculator(unsigned in_thread_count = 0);
+
+		// Search for the rate of each of the cash flow lists.  The result at each
+		// index corresponds to the cash flow list at the same index.
+		std::vector<BatchResult>	GetRates(CashFlowList* in_cash_flows, std::size_t in_count);
+		std::vector<BatchResult>	GetRates(std::vector<CashFlowList>& in_cash_flows);
+
+		// Search for the rate of each account in a portfolio using its views, so the
+		// cash flows are not copied (e.g. from a mapped file).
+		std::vector<BatchResult>	GetRates(const Portfolio& in_portfolio);
+
+		unsigned	GetThreadCount() const { return thread_count_; }
+		void		SetThreadCount(unsigned in_thread_count);
+
+		std::size_t	chunk_size_ = 64; // Number of lists a worker claims at a time.
+
+		SolverOptions	options_; // Used by every worker's Calculator.
+
+		// If set, every worker's Calculator writes its log here.  Otherwise the logs are
+		// not printed.  Use a sink that queues the text (e.g. logging::AsyncFdSink) so the
+		// workers do not wait for each other on the output.
+		logging::LogSink*	log_sink_ = nullptr;
+
+		// If not zero, every worker's Calculator keeps a trace of the last this many steps
+		// of each search, and the trace of a search that is not solved is written to
+		// log_sink_ (see roots::SolverTrace).
+		std::size_t	trace_capacity_ = 0;
+
+	private:
+
+		// Spread the searches over the workers.  in_get_rate(calculator, i) searches for
+		// the rate of the i-th series of cash flows.
+		template <class GET_RATE_T>
+		std::vector<BatchResult>	Solve(std::size_t in_count, const GET_RATE_T& in_get_rate);
+
+		// Search for the rates of the series claimed by one worker until none are left.
+		template <class GET_RATE_T>
+		void	SolveChunks(std::atomic<std::size_t>& io_next_index, std::size_t in_count, std::size_t in_chunk_size,
+							const GET_RATE_T& in_get_rate, BatchResult* out_results);
+
+		unsigned	thread_count_ = 1;
+	};
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "portfolio.h"
+
+//----------------------------------------------------------------------------------
+//	MIRR (Modified Internal Rate of Return)
+namespace mirr {
+
+	//----------------------------------------------------------------------------------
+	// Identify the outcome of writing or reading a binary cash flow file.
+	enum file_status_e
+	{
+		file_ok = 0,
+		file_not_opened = 1,	// The file could not be opened or mapped.
+		file_bad_header = 2,	// Not a cash flow file, another version or byte order, or the header checksum is wrong.
+		file_bad_layout = 3,	// The sections or offsets do not fit in the file.
+		file_bad_checksum = 4,	// A section's checksum is wrong.
+		file_write_failed = 5
+	};
+
+	//----------------------------------------------------------------------------------
+	// The header at the start of a binary cash flow file.  The file holds a portfolio's
+	// columns (see PortfolioColumns) as sections that each start at a multiple of 64
+	// bytes, in the byte order of the machine that wrote it (checked by byte_order_):
+	//   offsets		uint64 x (account_count + 1)
+	//   id offsets		uint64 x (account_count + 1)
+	//   start dates	int32 x account_count
+	//   days			int32 x cash_flow_count
+	//   amounts		double x cash_flow_count
+	//   ids			char x ids_size
+	// The header has its own checksum, which is always checked, and one for each
+	// section, which are only checked if asked for since reading them all takes as
+	// long as reading the file.
+	struct CashFlowFileHeader {
+		enum section_e
+		{
+			offsets = 0,
+			id_offsets = 1,
+			start_dates = 2,
+			days = 3,
+			amounts = 4,
+			ids = 5,
+			section_count = 6
+		};
+
+		char			magic_[8];				// "MIRRCFC\0"
+		std::uint32_t	version_;
+		std::uint32_t	byte_order_;			// 0x01020304 as written.
+		std::uint64_t	account_count_;
+		std::uint64_t	cash_flow_count_;
+		std::uint64_t	ids_size_;
+		std::uint64_t	positions_[section_count];	// Offset of each section from the start of the file.
+		std::uint64_t	checksums_[section_count];
+		std::uint64_t	header_checksum_;		// Checksum of the header before this field.
+	};
+
+	//----------------------------------------------------------------------------------
+	// Write a portfolio to a binary cash flow file.
+	file_status_e	WriteCashFlowsBinary(const std::string& in_path, const Portfolio& in_portfolio);
+
+	//----------------------------------------------------------------------------------
+	// Map a binary cash flow file and have the portfolio use its columns directly, so
+	// opening it only reads the header and the offsets.  The file stays mapped for as
+	// long as the portfolio uses it.  The sections' checksums are checked if
+	// in_verify_data is set.
+	file_status_e	ReadCashFlowsBinary(const std::string& in_path, Portfolio& out_portfolio, bool in_verify_data = false);
+
+	//----------------------------------------------------------------------------------
+	// Return a checksum of a block of bytes.  Eight bytes are combined at a time so it
+	// runs at close to memory speed.
+	std::uint64_t	CalculateChecksum(const void* in_data, std::size_t in_size);
+
+	//----------------------------------------------------------------------------------
+	// Return a description of the outcome of writing or reading a file.
+	const char*	FileStatusName(file_status_e in_status);
+};
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "modified_irr.h"
+
+//----------------------------------------------------------------------------------
+//	MIRR (Modified Internal Rate of Return)
+namespace mirr {
+
+	//----------------------------------------------------------------------------------
+	// The NPV at a rate with its first and second derivatives with respect to the rate.
+	template <class VALUE_T>
+	struct BasicNPVDerivatives {
+		VALUE_T	npv_ = 0.0;
+		VALUE_T	first_ = 0.0;
+		VALUE_T	second_ = 0.0;
+	};
+
+	using NPVDerivatives = BasicNPVDerivatives<NPV_t>;
+
+	//----------------------------------------------------------------------------------
+	// A series of cash flows compiled once for calculating its NPV at many rates.  The
+	// cash flows are sorted by date and each one's exponent for the compounding
+	// convention (e.g. days from the start divided by the days in the range) is
+	// calculated in advance, so the NPV at a rate is one log1p() followed by a single
+	// exp/multiply-add pass with no searching.  A daily rate's exponents are whole days
+	// so its NPV is found with powers built by multiplication instead.  When the gaps
+	// between the cash flows repeat (e.g. weekly or monthly contributions) the discounts
+	// are walked: one exp() per distinct gap and a multiplication per cash flow.  A plan
+	// whose cash flows fall on a grid of months also keeps the amount in each period of
+	// the grid, the coefficients of a polynomial in the discount per
+	// period.  The plan does not change after it is built.
+	class CashFlowPlan {
+	public:
+		CashFlowPlan() {}
+		CashFlowPlan(const CashFlowList& in_cash_flows, compounding_e in_compounding = compounding_e::since_inception);
+		CashFlowPlan(const CashFlowView& in_cash_flows, compounding_e in_compounding = compounding_e::since_inception);
+
+		// Given a discount rate, calculate the value of the series of
+		// cash flows discounted by that rate.
+		NPV_t	calculateNPV(const Rate_t& in_daily_discount_rate) const;
+
+		// Calculate the same value in double precision using the fastest vector
+		// kernel the processor supports.
+		double	calculateNPVDouble(double in_daily_discount_rate) const;
+
+		// Calculate the NPV at each of several rates with the vector kernel.
+		void	calculateNPVDouble(const double* in_daily_discount_rates, std::size_t in_rate_count, double* out_npvs) const;
+		std::vector<double>	calculateNPVDouble(const std::vector<double>& in_daily_discount_rates) const;
+
+		// Calculate the NPV at in_count rates evenly spaced in log(1 + rate), starting at
+		// log(1 + rate) = in_first_log_rate and going up by in_log_rate_step, e.g. to scan
+		// a grid of rates for changes of sign.  The even spacing lets each cash flow's
+		// discounts be found by multiplying rather than with one exp() for each rate.
+		void	calculateNPVGridDouble(double in_first_log_rate, double in_log_rate_step, std::size_t in_count, double* out_npvs) const;
+
+		// Calculate the NPV and its derivatives with respect to the rate in a single
+		// pass.  The second derivative is only calculated if it is requested.
+		NPVDerivatives	calculateNPVDerivatives(const Rate_t& in_daily_discount_rate, bool in_second = true) const;
+
+		// Calculate the NPV, or the NPV and its derivatives, with a numeric policy from
+		// precision.h.  LongDoublePrecision is the calculation above.
+		template <class PRECISION_T>
+		typename PRECISION_T::value_t	calculateNPV(const typename PRECISION_T::value_t& in_daily_discount_rate) const;
+
+		template <class PRECISION_T>
+		BasicNPVDerivatives<typename PRECISION_T::value_t>	calculateNPVDerivatives(
+																const typename PRECISION_T::value_t& in_daily_discount_rate,
+																bool in_second = true) const;
+
+		std::size_t	size() const { return exponents_.size(); }
+
+		// Return how the rates of the plan are compounded.
+		compounding_e	GetCompounding() const { return compounding_; }
+
+		// Return the number of distinct gaps in days between consecutive cash flows, or 0
+		// if there are too many to walk the discounts, and whether they are walked.  They
+		// are walked when that needs at most half as many exp() calls.
+		std::size_t	GetDistinctGaps() const { return gap_exponents_.size(); }
+		bool		IsDiscountWalked() const { return walk_discounts_; }
+
+		// Walk the discounts or calculate each with exp() (e.g. to compare them).  The
+		// discounts can only be walked if there are few enough distinct gaps.
+		void	SetDiscountWalk(bool in_walk) { walk_discounts_ = in_walk && (gap_indexes_.size() == size()); }
+
+		// Return whether or not the cash flows fall on a grid of months from the first (see
+		// CashFlowList::FindMonthlyGrid()) and the months between its points.  Only a
+		// plan built from a list or from a view with a start date can be periodic.
+		bool	IsPeriodic() const { return (grid_months_ > 0); }
+		int		GetGridMonths() const { return grid_months_; }
+
+		// Return the sum of the amounts in each period of the grid from the first cash
+		// flow's, or nothing if the plan is not periodic.
+		const std::vector<NPV_t>&	GetPeriodicAmounts() const { return periodic_amounts_; }
+
+		// Calculate the NPV with each amount discounted by the whole periods of the grid
+		// from the first cash flow at a rate per period.  This is a polynomial in the
+		// discount 1 / (1 + rate) so it is evaluated by Horner's scheme with no exp() or
+		// pow().  Months differ in length so it is close to, rather than equal to, the
+		// NPV at the equivalent rate for the plan's compounding.
+		NPV_t	calculatePeriodicNPV(const Rate_t& in_periodic_rate) const;
+
+		// Return the rate per period of the grid that makes the periodic NPV zero, found
+		// with the polynomial solver in roots.h.  NaN if the plan is not periodic or the
+		// periodic amounts do not change sign exactly once, which is when the rate is
+		// unique.
+		Rate_t	GetPeriodicRate() const;
+
+		// Convert a rate per period of the grid to the equivalent rate for the plan's
+		// compounding, e.g. as an estimate of the plan's rate.
+		Rate_t	ConvertPeriodicRate(const Rate_t& in_periodic_rate) const;
+
+		// Return the number of periods the rate is compounded over from the first cash flow
+		// to the last: 1 for a since inception rate, otherwise the years or days in the
+		// range (or 1 if the range is empty).  Dividing log(1 + rate) for the whole range
+		// by it gives log(1 + rate) for the plan's rates, e.g. to scale a range of rates
+		// to search.
+		Rate_t	GetPeriodsInRange() const { return (last_exponent_ > 0.0) ? last_exponent_ : 1.0; }
+
+		// Return the number of days between the first and last cash flows.
+		Day_t	GetDaysInRange() const { return days_in_range_; }
+
+		// Return the number of cash flows paid in (positive) and out (negative).
+		std::size_t	GetPositiveCount() const { return positive_count_; }
+		std::size_t	GetNegativeCount() const { return negative_count_; }
+
+		// Return the number of times the sign of the amounts changes in date order.
+		// This is the most roots the NPV can have (Descartes' rule of signs).
+		std::size_t	GetSignChanges() const { return sign_changes_; }
+
+		// Return whether or not there are both positive and negative amounts on more than
+		// one day which is needed for the NPV to have a root.  Cash flows all on one day
+		// have the same NPV at every rate.
+		bool	HasRoot() const { return ((positive_count_ > 0) && (negative_count_ > 0) && (days_in_range_ > 0)); }
+
+		// Return the Modified Dietz return of the cash flows: the gain divided by the
+		// cash flows weighted by the part of the range they were invested for.  With
+		// annual or daily compounding this is a rate per year or day.
+		Rate_t	GetModifiedDietzRate() const;
+
+		// Return the root of the first-order Taylor expansion of the NPV about a rate of
+		// zero: sum(amount) / sum(exponent * amount).
+		Rate_t	GetTaylorRate() const;
+
+		const std::vector<Rate_t>&			GetExponents() const { return exponents_; }
+		const std::vector<CashFlowAmt_t>&	GetAmounts() const { return amounts_; }
+
+	private:
+
+		// Build the plan from columns of days and amounts in any order.
+		template <class AMOUNT_T>
+		void	Compile(const Day_t* in_days, const AMOUNT_T* in_amounts, std::size_t in_count);
+
+		// Sum the amounts in each period of a grid of in_grid_months months, given each
+		// cash flow's period.
+		template <class AMOUNT_T>
+		void	CompilePeriodic(int in_grid_months, const std::vector<std::size_t>& in_periods, const AMOUNT_T* in_amounts);
+
+		// Return the exponent of a number of days from the first cash flow.
+		Rate_t	CalculateExponent(Day_t in_days) const;
+
+		// Call a function with each cash flow's index and discount factor.
+		template <class VALUE_T, class FUNCTION_T>
+		void	ForEachDiscount(VALUE_T in_log_rate, FUNCTION_T&& in_function) const;
+
+		// Calculate the NPV of a daily rate from tables of its powers.
+		template <class PRECISION_T>
+		typename PRECISION_T::value_t	calculateDailyNPV(const typename PRECISION_T::value_t& in_daily_discount_rate) const;
+
+		// Properties
+
+		compounding_e				compounding_ = compounding_e::since_inception;
+		std::vector<Day_t>			days_; // Days from the first cash flow.
+		std::vector<Rate_t>			exponents_;
+		std::vector<CashFlowAmt_t>	amounts_;
+		std::vector<double>			exponents_double_;
+		std::vector<double>			amounts_double_;
+		std::vector<Rate_t>			gap_exponents_; // Exponent of each distinct gap between consecutive cash flows.
+		std::vector<std::uint8_t>	gap_indexes_; // Index of each cash flow's gap from the one before it.
+		bool						walk_discounts_ = false;
+		int							grid_months_ = 0;
+		std::vector<NPV_t>			periodic_amounts_; // Sum of the amounts in each period of the grid.
+		std::vector<double>			periodic_amounts_double_;
+
+		Day_t			days_in_range_ = 0;
+		std::size_t		positive_count_ = 0;
+		std::size_t		negative_count_ = 0;
+		std::size_t		sign_changes_ = 0;
+		Rate_t			last_exponent_ = 0.0;
+		NPV_t			sum_amounts_ = 0.0;
+		NPV_t			sum_weighted_amounts_ = 0.0; // Sum of each amount times its exponent.
+	};
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+
+#include "modified_irr.h"
+
+//----------------------------------------------------------------------------------
+//	MIRR (Modified Internal Rate of Return)
+namespace mirr {
+
+	//----------------------------------------------------------------------------------
+	// Identify the format of a file of cash flows or results.
+	enum file_format_e
+	{
+		format_auto = 0,	// Binary if the file starts with the binary header, otherwise CSV.
+		format_csv = 1,
+		format_binary = 2
+	};
+
+	//----------------------------------------------------------------------------------
+	// Identify what the command line asks the program to do.
+	enum command_e
+	{
+		command_solve = 0,	// Find the rate of every account in the input.
+		command_help = 1,
+		command_test = 2,	// Run the tests.
+		command_bench = 3	// Run the benchmarks.
+	};
+
+	//----------------------------------------------------------------------------------
+	// The settings read from the command line.
+	struct CommandLineOptions {
+		command_e		command_ = command_e::command_solve;
+		std::string		input_path_;
+		std::string		output_path_;				// Empty writes CSV to the standard output.
+		std::string		binary_path_;				// If set, the input is also written here as a binary cash flow file.
+		std::string		log_path_;					// If set, the solvers' logs are written here.
+		file_format_e	input_format_ = file_format_e::format_auto;
+		file_format_e	output_format_ = file_format_e::format_auto;	// Binary if the output path ends in ".bin".
+		unsigned		thread_count_ = 0;			// Zero uses one thread per hardware core.
+		std::size_t		chunk_size_ = 64;
+		std::size_t		trace_capacity_ = 0;		// If set, the last steps of each search that is not solved are logged.
+		SolverOptions	options_;
+		bool			verify_ = false;			// Check the checksums of a binary input file.
+		bool			print_stats_ = false;
+	};
+
+	//----------------------------------------------------------------------------------
+	// Read the command line into the options.  Returns false with a description of the
+	// problem if an argument is not recognized or a value is not valid.
+	bool	ParseCommandLine(int argc, const char* const* argv, CommandLineOptions& out_options, std::string& out_error);
+
+	//----------------------------------------------------------------------------------
+	// Write a description of the command line.
+	void	PrintUsage(std::ostream& io_stream);
+
+	//----------------------------------------------------------------------------------
+	// Read the input, find the rate of every account and write the results and, if
+	// asked for, the statistics (to the standard error so they are kept apart from
+	// results written to the standard output).  Returns the program's exit code: 0 if
+	// the results were written, 2 if the input could not be read and 3 if the output
+	// could not be written.  Accounts whose rate was not found are reported in the
+	// results and do not change the exit code.
+	int		RunCommandLine(const CommandLineOptions& in_options);
+};
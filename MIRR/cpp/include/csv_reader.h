@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "portfolio.h"
+
+//----------------------------------------------------------------------------------
+//	MIRR (Modified Internal Rate of Return)
+namespace mirr {
+
+	//----------------------------------------------------------------------------------
+	// The outcome of reading a file of cash flows.
+	struct CsvReadStats {
+		std::size_t		bytes_ = 0;				// Size of the file.
+		std::size_t		rows_ = 0;				// Rows read into the portfolio.
+		std::size_t		bad_rows_ = 0;			// Rows skipped because a field could not be parsed.
+		std::size_t		first_bad_offset_ = 0;	// Offset in the file of the first row skipped.
+		unsigned		threads_ = 0;			// Threads used to parse the file.
+	};
+
+	//----------------------------------------------------------------------------------
+	// Read a file of cash flows for many accounts with one per line as
+	//   account_id,date,amount
+	// e.g. "A1001,2015-02-13,-122444.29".  The dates are YYYY-MM-DD.  A first line that
+	// does not parse (a header) is skipped; other lines that do not parse are counted
+	// and skipped.  Fields are not quoted.
+	//
+	// The file is mapped into memory and split into one chunk per thread at line ends.
+	// Each thread parses its chunk and groups its rows by account using the ids in the
+	// mapped file, so no strings are copied per row.  The accounts are in the order they
+	// first appear and each account's cash flows are in file order.  A thread count of
+	// zero uses one thread per hardware core.  Returns false if the file cannot be read.
+	bool	ReadCashFlowsCsv(const std::string& in_path, unsigned in_thread_count,
+								Portfolio& out_portfolio, CsvReadStats& out_stats);
+
+	//----------------------------------------------------------------------------------
+	// Parse the same format from text in memory.
+	void	ParseCashFlowsCsv(const char* in_text, std::size_t in_size, unsigned in_thread_count,
+								Portfolio& out_portfolio, CsvReadStats& out_stats);
+};
@@ -3,6 +3,8 @@
 #include <ctime>
 #include <assert.h>
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <iomanip>
 #include <string>
 #include <sstream> 
@@ -16,6 +18,116 @@ namespace dates {
 	static int daysInMonths[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
 	static const long	kSecondsPerDay = (60 * 60 * 24);
 
+	//----------------------------------------------------------------------------------
+	// A date as the number of days since 1970-01-01.  Comparing dates and finding the
+	// days between them are plain integer operations and do not depend on the time
+	// zone.  32 bits covers about +/- 5.8 million years.
+	using Date_t = std::int32_t;
+
+	//----------------------------------------------------------------------------------
+	// A date as its year, month (1 to 12) and day of the month (1 to 31).
+	struct CivilDate {
+		int			year_;
+		unsigned	month_;
+		unsigned	day_;
+	};
+
+	//----------------------------------------------------------------------------------
+	// Convert between civil dates and days since 1970-01-01 in the proleptic Gregorian
+	// calendar (H. Hinnant's days_from_civil/civil_from_days algorithms).  The years are
+	// counted from March in 400 year eras (146097 days) so that the leap day falls at
+	// the end of the year.  Each step is a single expression so the conversions can be
+	// evaluated when compiled.
+
+	// Return the year counted from March (January and February belong to the year before).
+	constexpr int		MarchYear(int in_year, unsigned in_month) { return in_year - ((in_month <= 2) ? 1 : 0); }
+
+	// Return the 400 year era that a year counted from March (or a day counted from
+	// 0000-03-01) falls in.
+	constexpr int		EraOfYear(int in_march_year) { return ((in_march_year >= 0) ? in_march_year : in_march_year - 399) / 400; }
+	constexpr int		EraOfDay(std::int32_t in_day) { return ((in_day >= 0) ? in_day : in_day - 146096) / 146097; }
+
+	// Return the day of the year counted from March 1st (0 to 365).
+	constexpr unsigned	MarchDayOfYear(unsigned in_month, unsigned in_day)
+	{
+		return ((153 * ((in_month > 2) ? in_month - 3 : in_month + 9) + 2) / 5) + in_day - 1;
+	}
+
+	// Return the day of the era (0 to 146096) for a year of the era and day of the year.
+	constexpr unsigned	DayOfEra(unsigned in_year_of_era, unsigned in_day_of_year)
+	{
+		return (in_year_of_era * 365) + (in_year_of_era / 4) - (in_year_of_era / 100) + in_day_of_year;
+	}
+
+	// Return the number of days since 1970-01-01 of a year, month (1 to 12) and day.
+	constexpr Date_t	DaysFromCivil(int in_year, unsigned in_month, unsigned in_day)
+	{
+		return (EraOfYear(MarchYear(in_year, in_month)) * 146097)
+			+ static_cast<Date_t>(DayOfEra(static_cast<unsigned>(MarchYear(in_year, in_month) - (EraOfYear(MarchYear(in_year, in_month)) * 400)),
+											MarchDayOfYear(in_month, in_day)))
+			- 719468;
+	}
+
+	// Return the day of the era (0 to 146096) of a number of days since 1970-01-01.
+	constexpr unsigned	DayOfEraFromDays(Date_t in_days)
+	{
+		return static_cast<unsigned>((in_days + 719468) - (EraOfDay(in_days + 719468) * 146097));
+	}
+
+	// Return the year of the era (0 to 399) of a day of the era.
+	constexpr unsigned	YearOfEra(unsigned in_day_of_era)
+	{
+		return (in_day_of_era - (in_day_of_era / 1460) + (in_day_of_era / 36524) - (in_day_of_era / 146096)) / 365;
+	}
+
+	// Return the day of the year counted from March 1st of a day of the era.
+	constexpr unsigned	MarchDayOfEra(unsigned in_day_of_era)
+	{
+		return in_day_of_era - DayOfEra(YearOfEra(in_day_of_era), 0);
+	}
+
+	// Return the month counted from March (0 to 11) of a day of the year counted from March.
+	constexpr unsigned	MarchMonth(unsigned in_march_day) { return ((5 * in_march_day) + 2) / 153; }
+
+	// Return the month (1 to 12) of a number of days since 1970-01-01.
+	constexpr unsigned	MonthFromDays(Date_t in_days)
+	{
+		return (MarchMonth(MarchDayOfEra(DayOfEraFromDays(in_days))) < 10)
+			? MarchMonth(MarchDayOfEra(DayOfEraFromDays(in_days))) + 3
+			: MarchMonth(MarchDayOfEra(DayOfEraFromDays(in_days))) - 9;
+	}
+
+	// Return the day of the month (1 to 31) of a number of days since 1970-01-01.
+	constexpr unsigned	DayFromDays(Date_t in_days)
+	{
+		return MarchDayOfEra(DayOfEraFromDays(in_days))
+			- (((153 * MarchMonth(MarchDayOfEra(DayOfEraFromDays(in_days)))) + 2) / 5) + 1;
+	}
+
+	// Return the year of a number of days since 1970-01-01.
+	constexpr int		YearFromDays(Date_t in_days)
+	{
+		return static_cast<int>(YearOfEra(DayOfEraFromDays(in_days))) + (EraOfDay(in_days + 719468) * 400)
+			+ ((MonthFromDays(in_days) <= 2) ? 1 : 0);
+	}
+
+	// Return the year, month and day of a number of days since 1970-01-01.
+	constexpr CivilDate	CivilFromDays(Date_t in_days)
+	{
+		return CivilDate{ YearFromDays(in_days), MonthFromDays(in_days), DayFromDays(in_days) };
+	}
+
+	// Return the date (in UTC) of a time.
+	constexpr Date_t	DateFromTime(std::time_t in_time)
+	{
+		return static_cast<Date_t>(((in_time >= 0) ? in_time : in_time - (kSecondsPerDay - 1)) / kSecondsPerDay);
+	}
+
+	static_assert(DaysFromCivil(1970, 1, 1) == 0, "The epoch is day 0");
+	static_assert(DaysFromCivil(2000, 3, 1) == 11017, "Day after a 400 year leap day");
+	static_assert(YearFromDays(-1) == 1969 && MonthFromDays(-1) == 12 && DayFromDays(-1) == 31, "Day before the epoch");
+	static_assert(DayFromDays(DaysFromCivil(2016, 2, 29)) == 29, "Leap day round trip");
+
 	//----------------------------------------------------------------------------------
 	// Return whether or not a year is a leap year.
 	bool IsLeapYear(int year);
@@ -32,6 +144,12 @@ namespace dates {
 	// Return the date n months after the date provided.
 	time_t AddMonths(const time_t &in_date, int months);
 
+	//----------------------------------------------------------------------------------
+	// Return the date n months after (or before if negative) the date provided.  The
+	// last day of a month maps to the last day of the resulting month; other days are
+	// limited to the days in the resulting month.
+	Date_t AddMonths(Date_t in_date, int months);
+
 	//----------------------------------------------------------------------------------
 	// Return the difference between two date/times in seconds.
 	double GetDifferenceSeconds(const time_t& in_lhs, const time_t& in_rhs);
@@ -44,13 +162,38 @@ namespace dates {
 	// Return a string representation of a time.
 	std::string	Date2String(const time_t& in_date);
 
+	//----------------------------------------------------------------------------------
+	// Return a string representation (as YYYY-MM-DD) of a date.
+	std::string	Date2String(Date_t in_date);
+
 	//----------------------------------------------------------------------------------
 	// Return a string representation of a time.
 	std::string	Time2String(const time_t& in_date);
 
 	//----------------------------------------------------------------------------------
-	// Given a string date (as YYYY-MM-DD), return a time structure for it.
-	time_t	MakeDate(const std::string& in_date);
+	// Given a string date (as YYYY-MM-DD), return the days since 1970-01-01 for it.
+	Date_t	MakeDate(const std::string& in_date);
+
+	//----------------------------------------------------------------------------------
+	// Identify the outcome of parsing a date.
+	enum parse_status_e
+	{
+		parsed = 0,
+		bad_length = 1,		// Not exactly 10 characters.
+		bad_character = 2,	// Not digits separated by '-' as YYYY-MM-DD.
+		bad_month = 3,		// Month not 01 to 12.
+		bad_day = 4			// Day not in the month.
+	};
+
+	//----------------------------------------------------------------------------------
+	// Parse a date as YYYY-MM-DD straight to the days since 1970-01-01 without streams,
+	// locales or mktime().  out_date is only set if the date is parsed.
+	parse_status_e	ParseDate(const char* in_text, std::size_t in_length, Date_t& out_date);
+	parse_status_e	ParseDate(const std::string& in_text, Date_t& out_date);
+
+	//----------------------------------------------------------------------------------
+	// Return a description of the outcome of parsing a date.
+	const char*	ParseStatusName(parse_status_e in_status);
 
 }
 
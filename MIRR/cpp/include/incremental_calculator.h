@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+
+#include "cash_flow_plan.h"
+#include "modified_irr.h"
+
+//----------------------------------------------------------------------------------
+//	MIRR (Modified Internal Rate of Return)
+namespace mirr {
+
+	//----------------------------------------------------------------------------------
+	// A list of cash flows that grows over time (e.g. an account that gets a cash flow
+	// or two each day) kept with the rate last found for it.  After cash flows are
+	// appended the rate is searched for starting from the previous one, which usually
+	// needs one to three NPV evaluations rather than a full search.
+	class IncrementalCalculator {
+
+	public:
+		IncrementalCalculator();
+
+		// Add a cash flow to the list.  The rate is searched for again by the next call
+		// to GetRate().
+		void	push_back(const CashFlow& in_new);
+
+		// Return the rate of the cash flows, searching again from the previous rate if
+		// any cash flows have been added since it was found.
+		Rate_t	GetRate();
+
+		// Forget the previous rate so the next search starts from the seed in the options.
+		void	Reset();
+
+		// Remove all of the cash flows and the previous rate.
+		void	clear();
+
+		std::size_t	size() const { return cash_flows_.size(); }
+
+		const CashFlowList&	GetCashFlows() const { return cash_flows_; }
+
+		// Return whether or not the last search found a rate that the next one can start from.
+		bool	HasRate() const { return has_rate_; }
+
+		// Return the calculator (e.g. to set its options or read the evaluations used).
+		Calculator&	GetCalculator() { return calculator_; }
+
+	private:
+		// Properties
+
+		CashFlowList	cash_flows_;
+		Calculator		calculator_;
+		Rate_t			rate_ = 0.0;
+		bool			has_rate_ = false;
+		bool			changed_ = false;
+	};
+};
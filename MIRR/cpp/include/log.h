@@ -7,6 +7,23 @@
 //----------------------------------------------------------------------------------
 // Provide a facility to record events in a log.
 
+//----------------------------------------------------------------------------------
+// Entries below this level are removed when compiled.  Define it (e.g. with
+// /D LOGGING_MIN_LEVEL=logging::trace) to strip the debug tracing from the loops that
+// use LOG_IF_LOGGED().  By default every level is compiled and the log's own level
+// decides at run time.
+#ifndef LOGGING_MIN_LEVEL
+#define LOGGING_MIN_LEVEL logging::debug
+#endif
+
+//----------------------------------------------------------------------------------
+// Start a log entry only if its level is logged, e.g.
+//   LOG_IF_LOGGED(calc_log, debug) << count << estimate;
+// Nothing after the macro is formatted (or even evaluated) when the level is not
+// logged, so an entry that is filtered out costs one comparison.
+#define LOG_IF_LOGGED(io_log, in_level) \
+	if (!(io_log).IsLogged(in_level)) {} else (io_log).log(in_level)
+
 namespace logging {
 
 	// Set the level at which messages will be logged.  Each log entry
@@ -79,6 +96,10 @@ namespace logging {
 		
 		Log&	operator=(const Log& in_rhs);
 
+		// Take the entries and level of another log without copying the entries.  The
+		// other log is left with this log's previous entries.
+		void	MoveFrom(Log& io_from);
+
 		LogEntry&	log(LogEntry& in_entry);
 		LogEntry&	log(const level_logged_e in_level = error);
 
@@ -87,6 +108,13 @@ namespace logging {
 		level_logged_e	GetLevel() const { return level_logged_; }
 		void			SetLevel(level_logged_e in_level) { level_logged_ = in_level; }
 
+		// Return whether or not entries at a level are compiled in and at or above the
+		// level of the log.  Check this before formatting an entry.
+		bool	IsLogged(level_logged_e in_level) const
+		{
+			return ((in_level >= LOGGING_MIN_LEVEL) && (in_level >= level_logged_));
+		}
+
 		bool	buffer_ = true; // Hold a collection of the log entries rather than writing each separately.
 
 	private:
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------------------
+// Provide a facility to record events in a log.
+
+namespace logging {
+
+	//----------------------------------------------------------------------------------
+	// Somewhere that flushed log text is written to (e.g. the console or a file).
+	class LogSink {
+	public:
+		virtual ~LogSink() {}
+
+		// Write text that has been flushed from a log.
+		virtual void	Write(const std::string& in_text) = 0;
+
+		// Wait until everything written so far has reached its output.
+		virtual void	Flush() {}
+	};
+
+	//----------------------------------------------------------------------------------
+	// Write log text straight to an output stream on the calling thread.  This is what
+	// the calculator does with the console when it has no other sink.
+	class StreamSink : public LogSink {
+	public:
+		StreamSink(std::ostream& io_output)
+			: output_(io_output)
+		{}
+
+		void	Write(const std::string& in_text) override;
+		void	Flush() override;
+
+	private:
+
+		std::ostream&	output_;
+		std::mutex		mutex_; // Keep text from different threads whole.
+	};
+
+	//----------------------------------------------------------------------------------
+	// A queue of text with a single producer thread and a single consumer thread that
+	// needs no locks.  Its slots are allocated once; each slot's string keeps its
+	// memory as it is reused so steady use does not allocate.
+	class SpscQueue {
+	public:
+		// The capacity is rounded up to a power of two.
+		SpscQueue(std::size_t in_capacity);
+
+		// Add text to the queue.  Returns false without waiting if the queue is full.
+		// Only called by the producer thread.
+		bool	TryPush(const std::string& in_text);
+
+		// Take the oldest text from the queue by swapping it into io_text.  Returns false
+		// if the queue is empty.  Only called by the consumer thread.
+		bool	TryPop(std::string& io_text);
+
+		bool	empty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+
+	private:
+		// Properties
+
+		std::vector<std::string>	slots_;
+		std::size_t					mask_ = 0;
+
+		// Keep the indexes on separate cache lines so the producer and consumer do not
+		// contend for the same line.
+		alignas(64) std::atomic<std::size_t>	head_; // Next slot to pop (written by the consumer).
+		alignas(64) std::atomic<std::size_t>	tail_; // Next slot to push (written by the producer).
+	};
+
+	//----------------------------------------------------------------------------------
+	// Write log text to a file descriptor from a background thread.  Each thread that
+	// writes gets its own single producer queue, so writing is a copy into a slot and
+	// never waits for the output or for another thread.  If a thread's queue is full
+	// the text is dropped and counted rather than waiting.
+	class AsyncFdSink : public LogSink {
+	public:
+		// Write to an open file descriptor (e.g. 1 for standard output) that the sink
+		// does not close.
+		AsyncFdSink(int in_fd, std::size_t in_queue_capacity = 1024);
+
+		// Open a file to append to.  The sink closes it when it is destroyed.
+		AsyncFdSink(const std::string& in_path, std::size_t in_queue_capacity = 1024);
+
+		// Write everything still queued and stop the background thread.
+		~AsyncFdSink();
+
+		AsyncFdSink(const AsyncFdSink&) = delete;
+		AsyncFdSink&	operator=(const AsyncFdSink&) = delete;
+
+		void	Write(const std::string& in_text) override;
+		void	Flush() override;
+
+		bool	IsOpen() const { return fd_ >= 0; }
+
+		// Return the number of pieces of text written and dropped because a queue was full.
+		std::size_t	GetWritten() const { return written_.load(std::memory_order_relaxed); }
+		std::size_t	GetDropped() const;
+
+	private:
+
+		// A producer's queue with the count of text it dropped.
+		struct ProducerQueue {
+			ProducerQueue(std::size_t in_capacity) : queue_(in_capacity), dropped_(0) {}
+
+			SpscQueue					queue_;
+			std::atomic<std::size_t>	dropped_;
+		};
+
+		// Return the calling thread's queue, creating it the first time.
+		ProducerQueue&	GetQueue();
+
+		// Start the background thread.
+		void	Start();
+
+		// Move the queued text to the output until the sink is destroyed.
+		void	WriteQueued();
+
+		// Write a buffer to the file descriptor, continuing after partial writes.
+		void	WriteFd(const std::string& in_buffer);
+
+		bool	AllEmpty() const;
+
+		// Properties
+
+		int				fd_ = -1;
+		bool			owns_fd_ = false;
+		std::size_t		queue_capacity_ = 1024;
+		std::uint64_t	id_ = 0; // Identifies the sink to the threads' queue caches.
+
+		std::vector<std::unique_ptr<ProducerQueue>>	queues_;
+		mutable std::mutex							queues_mutex_; // Only held to add or list queues.
+		std::atomic<std::size_t>					queue_count_;
+
+		std::atomic<bool>			stop_;
+		std::atomic<bool>			busy_; // The writer has taken text that is not written yet.
+		std::atomic<std::size_t>	written_;
+		std::thread					writer_;
+	};
+}
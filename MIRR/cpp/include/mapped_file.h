@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+//----------------------------------------------------------------------------------
+//	MIRR (Modified Internal Rate of Return)
+namespace mirr {
+
+	//----------------------------------------------------------------------------------
+	// A file mapped read-only into memory so it can be read (including by several
+	// threads at once) without copying it into buffers.  The file is unmapped when the
+	// object is destroyed.
+	class MappedFile {
+	public:
+		MappedFile() {}
+		MappedFile(const std::string& in_path);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile&	operator=(const MappedFile&) = delete;
+
+		// Map a file, unmapping any file already mapped.  Returns false if the file
+		// cannot be opened or mapped.  An empty file is open with no data.
+		bool	Open(const std::string& in_path);
+		void	Close();
+
+		bool			IsOpen() const { return open_; }
+		const char*		data() const { return data_; }
+		std::size_t		size() const { return size_; }
+
+	private:
+		// Properties
+
+		const char*		data_ = nullptr;
+		std::size_t		size_ = 0;
+		bool			open_ = false;
+
+#if defined(_WIN32)
+		void*			file_handle_ = nullptr;
+		void*			mapping_handle_ = nullptr;
+#endif
+	};
+};
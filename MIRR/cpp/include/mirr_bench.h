@@ -0,0 +1,923 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+#include "cash_flow_plan.h"
+#include "cash_flow_file.h"
+#include "csv_reader.h"
+#include "date_math.h"
+#include "modified_irr.h"
+#include "roots.h"
+#include "npv_kernels.h"
+#include "mirr_test.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------------------
+// Benchmarks for the calculations.  Each reports the time per call and compares its
+// result with the original calculation so a faster path that is wrong stands out.
+//----------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------
+// Build a list of cash flows spread over the years before the start date with a
+// final withdrawal so the list has a rate.
+mirr::CashFlowList	MakeBenchCashFlows(int in_count)
+{
+	mirr::CashFlowList	cash_flows;
+	dates::Date_t		start_date = dates::MakeDate("1990-01-01");
+
+	std::srand(1);
+
+	for (int i = 0; i < in_count - 1; i++) {
+		dates::Date_t	cash_flow_date = start_date + i;
+		cash_flows.push_back(mirr::CashFlow(cash_flow_date, 100.0 + (std::rand() % 10000) / 100.0));
+	}
+
+	dates::Date_t	end_date = start_date + in_count;
+	cash_flows.push_back(mirr::CashFlow(end_date, -200.0 * in_count));
+
+	return cash_flows;
+}
+
+//----------------------------------------------------------------------------------
+// Return the average time in nanoseconds of calling a function a number of times.
+// The results are summed so the calls cannot be optimized away.
+template <class FUNCTION_T>
+double	TimeCalls(int in_repeats, FUNCTION_T in_function, long double& out_total)
+{
+	auto	start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < in_repeats; i++) {
+		out_total += in_function(i);
+	}
+
+	auto	finish = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::nano>(finish - start).count() / in_repeats;
+}
+
+//----------------------------------------------------------------------------------
+// Compare the original NPV loop with the columnar and vector kernels.
+bool	BenchNPVKernels()
+{
+	static const int	kCashFlows = 10000;
+	static const int	kRepeats = 200;
+
+	mirr::CashFlowList		cash_flows = MakeBenchCashFlows(kCashFlows);
+	mirr::CashFlowColumns	columns(cash_flows);
+	mirr::CashFlowView		view = columns.GetView();
+	mirr::CashFlowPlan		plan(view);
+	mirr::kernels::instruction_set_e	detected = mirr::kernels::DetectInstructionSet();
+
+	long double	total = 0.0;
+	mirr::Rate_t	rate = 0.0735;
+
+	cout << "Bench NPV kernels: " << kCashFlows << " cash flows, detected "
+		<< mirr::kernels::InstructionSetName(detected) << endl;
+
+	mirr::NPV_t	expected = cash_flows.calculateNPV(rate);
+
+	double	list_ns = TimeCalls(kRepeats, [&](int i) { return cash_flows.calculateNPV(rate + i * 1e-9); }, total);
+	double	view_ns = TimeCalls(kRepeats, [&](int i) { return view.calculateNPV(rate + i * 1e-9); }, total);
+	double	plan_ns = TimeCalls(kRepeats, [&](int i) { return plan.calculateNPV(rate + i * 1e-9); }, total);
+	double	compile_ns = TimeCalls(10, [&](int) { return mirr::CashFlowPlan(view).size(); }, total);
+
+	cout << std::fixed << std::setprecision(1);
+	cout << "  CashFlowList::calculateNPV   " << std::setw(12) << list_ns << " ns" << endl;
+	cout << "  CashFlowView::calculateNPV   " << std::setw(12) << view_ns << " ns  x"
+		<< std::setprecision(2) << (list_ns / view_ns) << std::setprecision(1) << endl;
+	cout << "  CashFlowPlan::calculateNPV   " << std::setw(12) << plan_ns << " ns  x"
+		<< std::setprecision(2) << (list_ns / plan_ns) << std::setprecision(1)
+		<< "  (compiled once in " << compile_ns << " ns)" << endl;
+
+	for (int set = mirr::kernels::instruction_set_e::scalar; set <= detected; set++) {
+		mirr::kernels::SetInstructionSet(static_cast<mirr::kernels::instruction_set_e>(set));
+
+		const char*	set_name = mirr::kernels::InstructionSetName(static_cast<mirr::kernels::instruction_set_e>(set));
+
+		double	npv = view.calculateNPVDouble(static_cast<double>(rate));
+		double	kernel_ns = TimeCalls(kRepeats, [&](int i) { return view.calculateNPVDouble(static_cast<double>(rate + i * 1e-9)); }, total);
+
+		cout << "  View::calculateNPVDouble " << std::setw(8) << set_name
+			<< "  " << std::setw(12) << kernel_ns << " ns  x" << std::setprecision(2) << (list_ns / kernel_ns)
+			<< "  relative error " << std::scientific << std::abs((npv - expected) / expected)
+			<< std::fixed << std::setprecision(1) << endl;
+
+		npv = plan.calculateNPVDouble(static_cast<double>(rate));
+		kernel_ns = TimeCalls(kRepeats, [&](int i) { return plan.calculateNPVDouble(static_cast<double>(rate + i * 1e-9)); }, total);
+
+		cout << "  Plan::calculateNPVDouble " << std::setw(8) << set_name
+			<< "  " << std::setw(12) << kernel_ns << " ns  x" << std::setprecision(2) << (list_ns / kernel_ns)
+			<< "  relative error " << std::scientific << std::abs((npv - expected) / expected)
+			<< std::fixed << std::setprecision(1) << endl;
+	}
+
+	mirr::kernels::SetInstructionSet(detected);
+
+	cout << "  (checksum " << total << ")" << endl;
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------
+// Compare calculating the NPV of a list at K rates evenly spaced in log(1 + rate) one
+// rate at a time with calculating them with the grid kernel.
+void	BenchMultiRateNPV(int in_cash_flow_count, int in_repeats)
+{
+	mirr::CashFlowList	cash_flows = MakeBenchCashFlows(in_cash_flow_count);
+	mirr::CashFlowPlan	plan(cash_flows);
+	mirr::kernels::instruction_set_e	detected = mirr::kernels::DetectInstructionSet();
+
+	long double	total = 0.0;
+
+	cout << "Bench multi-rate NPV: " << in_cash_flow_count << " cash flows, detected "
+		<< mirr::kernels::InstructionSetName(detected) << endl;
+	cout << std::fixed << std::setprecision(1);
+
+	double	single_ns = TimeCalls(in_repeats, [&](int i) { return plan.calculateNPV(0.0735 + i * 1e-9); }, total);
+
+	cout << "  CashFlowPlan::calculateNPV, one rate  " << std::setw(12) << single_ns << " ns" << endl;
+
+	for (int set = mirr::kernels::instruction_set_e::scalar; set <= detected; set++) {
+		mirr::kernels::SetInstructionSet(static_cast<mirr::kernels::instruction_set_e>(set));
+
+		const char*	set_name = mirr::kernels::InstructionSetName(static_cast<mirr::kernels::instruction_set_e>(set));
+
+		for (std::size_t count : { 1, 8, 32 }) {
+			std::vector<double>	rates(count);
+			std::vector<double>	npvs(count);
+			double				first_log_rate = std::log1p(-0.5);
+
+			for (std::size_t k = 0; k < count; k++) {
+				rates[k] = std::expm1(first_log_rate + k * 0.05);
+			}
+
+			double	one_at_a_time_ns = TimeCalls(in_repeats, [&](int i) {
+				double	sum = 0.0;
+				for (std::size_t k = 0; k < count; k++) {
+					sum += plan.calculateNPVDouble(rates[k] + i * 1e-12);
+				}
+				return sum;
+			}, total);
+
+			double	grid_ns = TimeCalls(in_repeats, [&](int i) {
+				plan.calculateNPVGridDouble(first_log_rate + i * 1e-12, 0.05, count, npvs.data());
+				return npvs[0];
+			}, total);
+
+			cout << "  " << std::setw(8) << set_name << "  K=" << std::setw(2) << count
+				<< "  one at a time " << std::setw(12) << one_at_a_time_ns << " ns"
+				<< "  grid " << std::setw(12) << grid_ns << " ns  x" << std::setprecision(2)
+				<< (one_at_a_time_ns / grid_ns) << "  vs one long double rate x" << (single_ns / grid_ns)
+				<< std::setprecision(1) << endl;
+		}
+	}
+
+	mirr::kernels::SetInstructionSet(detected);
+
+	cout << "  (checksum " << total << ")" << endl;
+}
+
+//----------------------------------------------------------------------------------
+// Time a list that fits in the processor's caches and one that does not, where
+// reading the cash flows once rather than once per rate also matters.
+bool	BenchMultiRateNPV()
+{
+	BenchMultiRateNPV(10000, 100);
+	BenchMultiRateNPV(1000000, 3);
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------
+// Compare the number of NPV evaluations and the time each search method needs to
+// find the rates of the test cases.
+bool	BenchSolverMethods()
+{
+	static const int	kRepeats = 200;
+
+	std::vector<MIRRTestCase>	test_cases = MakeMIRRTestCases();
+	mirr::solver_method_e		methods[] = { mirr::solver_method_e::brent, mirr::solver_method_e::newton, mirr::solver_method_e::halley };
+	const char*					method_names[] = { "brent", "newton", "halley" };
+
+	cout << "Bench solver methods: evaluations (iterations) per test case" << endl;
+
+	for (int m = 0; m < 3; m++) {
+		mirr::Calculator	calculator;
+		long double			total = 0.0;
+		long				evaluations = 0;
+
+		calculator.print_log_ = false;
+		calculator.options_.method_ = methods[m];
+
+		cout << "  " << std::setw(8) << method_names[m] << " ";
+
+		for (MIRRTestCase& test_case : test_cases) {
+			mirr::Rate_t	rate = calculator.GetRate(test_case.cash_flows_);
+
+			evaluations += calculator.GetEvaluations();
+			cout << std::setw(4) << calculator.GetEvaluations() << " (" << calculator.GetIterations() << ")";
+			total += rate;
+		}
+
+		double	solve_ns = TimeCalls(kRepeats, [&](int i) {
+			calculator.calc_log.clear();
+			return calculator.GetRate(test_cases[i % test_cases.size()].cash_flows_);
+		}, total);
+
+		cout << "  total " << evaluations << std::fixed << std::setprecision(1)
+			<< "  " << solve_ns << " ns/search" << endl;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------
+// Call a function with a range of values and sum the results.  Templated on the
+// callable so a lambda is called directly and a std::function through its wrapper.
+template <class FUNCTION_T>
+mirr::Rate_t	SumCalls(int in_count, const FUNCTION_T& in_function)
+{
+	mirr::Rate_t	total = 0.0;
+
+	for (int i = 0; i < in_count; i++) {
+		total += in_function(1.0 + i * 1e-6);
+	}
+
+	return total;
+}
+
+//----------------------------------------------------------------------------------
+// Compare the time per evaluation of a cheap function passed to the root finder as a
+// std::function with the same function passed as a lambda.
+bool	BenchCallableOverhead()
+{
+	static const int	kCalls = 1000000;
+	static const int	kSearches = 2000;
+	static const int	kRounds = 7;
+
+	auto	cube_root_of_2 = [](const mirr::Rate_t& in_x) -> mirr::Rate_t { return (in_x * in_x * in_x) - 2.0; };
+	roots::RootFinder<mirr::Rate_t>::function_t	wrapped = cube_root_of_2;
+
+	long double	total = 0.0;
+
+	double	wrapped_ns = TimeCalls(1, [&](int) { return SumCalls(kCalls, wrapped); }, total) / kCalls;
+	double	direct_ns = TimeCalls(1, [&](int) { return SumCalls(kCalls, cube_root_of_2); }, total) / kCalls;
+
+	cout << "Bench callable overhead:" << std::fixed << std::setprecision(2) << endl;
+	cout << "  std::function call  " << std::setw(10) << wrapped_ns << " ns/evaluation" << endl;
+	cout << "  lambda call         " << std::setw(10) << direct_ns << " ns/evaluation" << endl;
+
+	// A search spends most of each evaluation in Brent's own arithmetic, so the two
+	// callables are timed over the same searches in alternating rounds and the fastest
+	// round of each is kept.  Their difference is the overhead of the call itself.  Each
+	// search is also run once before timing; with a single call site the compiler may
+	// inline the whole search into the timing loop, which measures its register
+	// allocation there rather than the call.
+
+	roots::RootFinder<mirr::Rate_t>	root_finder;
+	double							search_wrapped_ns = 0.0;
+	double							search_direct_ns = 0.0;
+
+	total += root_finder.SearchForRoot(0.0, 2.0, wrapped);
+	total += root_finder.SearchForRoot(0.0, 2.0, cube_root_of_2);
+
+	for (int round = 0; round < kRounds; round++) {
+		long	wrapped_evaluations = 0;
+		long	direct_evaluations = 0;
+
+		double	wrapped_round_ns = TimeCalls(kSearches, [&](int i) {
+			mirr::Rate_t	root = root_finder.SearchForRoot(0.0 + i * 1e-6, 2.0, wrapped);
+			wrapped_evaluations += root_finder.GetEvaluations();
+			return root;
+		}, total) * kSearches / wrapped_evaluations;
+
+		double	direct_round_ns = TimeCalls(kSearches, [&](int i) {
+			mirr::Rate_t	root = root_finder.SearchForRoot(0.0 + i * 1e-6, 2.0, cube_root_of_2);
+			direct_evaluations += root_finder.GetEvaluations();
+			return root;
+		}, total) * kSearches / direct_evaluations;
+
+		if ((round == 0) || (wrapped_round_ns < search_wrapped_ns)) {
+			search_wrapped_ns = wrapped_round_ns;
+		}
+
+		if ((round == 0) || (direct_round_ns < search_direct_ns)) {
+			search_direct_ns = direct_round_ns;
+		}
+	}
+
+	cout << "  SearchForRoot(std::function) " << std::setw(10) << search_wrapped_ns << " ns/evaluation" << endl;
+	cout << "  SearchForRoot(lambda)        " << std::setw(10) << search_direct_ns << " ns/evaluation" << endl;
+	cout << "  call overhead in a search    " << std::setw(10) << (search_wrapped_ns - search_direct_ns) << " ns/evaluation" << endl;
+	cout << "  (checksum " << total << ")" << endl;
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------
+// Compare the number of NPV evaluations each seeding strategy needs to find the rates
+// of the test cases with each search method, and how close the seeds are to the rates.
+bool	BenchSeedStrategies()
+{
+	std::vector<MIRRTestCase>	test_cases = MakeMIRRTestCases();
+	mirr::solver_method_e		methods[] = { mirr::solver_method_e::brent, mirr::solver_method_e::newton, mirr::solver_method_e::halley };
+	const char*					method_names[] = { "brent", "newton", "halley" };
+	mirr::seed_strategy_e		seeds[] = { mirr::seed_strategy_e::fixed_bracket, mirr::seed_strategy_e::modified_dietz, mirr::seed_strategy_e::taylor };
+	const char*					seed_names[] = { "fixed_bracket", "modified_dietz", "taylor" };
+
+	cout << "Bench seed strategies: seed (rate) per test case" << endl;
+
+	for (MIRRTestCase& test_case : test_cases) {
+		mirr::CashFlowPlan	plan(test_case.cash_flows_);
+
+		cout << "  dietz " << std::setw(12) << std::setprecision(6) << plan.GetModifiedDietzRate()
+			<< "  taylor " << std::setw(12) << plan.GetTaylorRate()
+			<< "  (" << test_case.expected_ << ")" << endl;
+	}
+
+	cout << "Bench seed strategies: evaluations per test case" << endl;
+
+	for (int m = 0; m < 3; m++) {
+		for (int s = 0; s < 3; s++) {
+			mirr::Calculator	calculator;
+			long				evaluations = 0;
+
+			calculator.print_log_ = false;
+			calculator.options_.method_ = methods[m];
+			calculator.options_.seed_ = seeds[s];
+
+			cout << "  " << std::setw(8) << method_names[m] << std::setw(16) << seed_names[s] << " ";
+
+			for (MIRRTestCase& test_case : test_cases) {
+				calculator.calc_log.clear();
+				calculator.GetRate(test_case.cash_flows_);
+
+				evaluations += calculator.GetEvaluations();
+				cout << std::setw(4) << calculator.GetEvaluations();
+			}
+
+			cout << "  total " << evaluations << endl;
+		}
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------
+// Compare the time to search for a rate when the search's debug messages are logged
+// with the time when they are filtered out by the level of the log (or compiled out
+// with LOGGING_MIN_LEVEL), and when the steps are recorded in a trace instead.
+bool	BenchSolverLogging()
+{
+	static const int	kRepeats = 2000;
+
+	mirr::CashFlowPlan				plan(MakeMIRRTestCases().front().cash_flows_);
+	roots::RootFinder<mirr::Rate_t>	root_finder;
+	logging::level_logged_e			levels[] = { logging::debug, logging::info, logging::info };
+	const char*						level_names[] = { "debug", "info", "trace" };
+
+	auto	npv = [&plan](const mirr::Rate_t& in_rate) -> mirr::Rate_t { return plan.calculateNPV(in_rate); };
+
+	roots::SolverTrace				trace(64);
+
+	cout << "Bench solver logging: time per search" << endl;
+
+	for (int l = 0; l < 3; l++) {
+		long double	total = 0.0;
+
+		root_finder.calc_log.SetLevel(levels[l]);
+		root_finder.trace_ = (l == 2) ? &trace : nullptr;
+
+		double	search_ns = TimeCalls(kRepeats, [&](int i) {
+			root_finder.calc_log.clear();
+			trace.clear();
+			return root_finder.SearchForRoot(-0.5 + i * 1e-6, 1.0, npv);
+		}, total);
+
+		cout << "  level " << std::setw(6) << level_names[l] << std::fixed << std::setprecision(1)
+			<< std::setw(12) << search_ns << " ns/search  " << root_finder.GetEvaluations() << " evaluations" << endl;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------
+// Compare the time to parse dates with MakeDate (a string stream, get_time and the
+// civil date conversion) and with ParseDate.
+bool	BenchDateParsing()
+{
+	static const int	kDates = 100000;
+
+	std::vector<std::string>	texts;
+	dates::Date_t				start_date = dates::MakeDate("1990-01-01");
+
+	for (int i = 0; i < kDates; i++) {
+		texts.push_back(dates::Date2String(start_date + (i % 20000)));
+	}
+
+	long double	total = 0.0;
+	bool		matched = true;
+
+	double	make_ns = TimeCalls(kDates, [&](int i) { return dates::MakeDate(texts[i]); }, total);
+	double	parse_ns = TimeCalls(kDates, [&](int i) {
+		dates::Date_t	date = 0;
+		dates::ParseDate(texts[i], date);
+		return date;
+	}, total);
+
+	for (int i = 0; i < kDates; i++) {
+		dates::Date_t	date = 0;
+
+		if ((dates::ParseDate(texts[i], date) != dates::parse_status_e::parsed) || (date != dates::MakeDate(texts[i]))) {
+			matched = false;
+		}
+	}
+
+	cout << "Bench date parsing: " << kDates << " dates " << std::fixed << std::setprecision(1) << endl;
+	cout << "  MakeDate   " << std::setw(10) << make_ns << " ns/date" << endl;
+	cout << "  ParseDate  " << std::setw(10) << parse_ns << " ns/date  x" << std::setprecision(2) << (make_ns / parse_ns)
+		<< (matched ? " (matched)" : " (MISMATCH)") << endl;
+	cout << "  (checksum " << total << ")" << endl;
+
+	return matched;
+}
+
+//----------------------------------------------------------------------------------
+// Compare building a list from cash flows in reverse date order (with pairs on the
+// same day) with push_back() and with Assign().
+bool	BenchBulkLoad()
+{
+	static const int	kCashFlows = 20000;
+
+	mirr::CashFlowList			in_order = MakeBenchCashFlows(kCashFlows / 2);
+	std::vector<mirr::CashFlow>	unsorted;
+
+	for (mirr::CashFlow& cash_flow : in_order) {
+		unsorted.push_back(mirr::CashFlow(cash_flow.date_, cash_flow.amount_ / 2.0));
+		unsorted.push_back(mirr::CashFlow(cash_flow.date_, cash_flow.amount_ / 2.0));
+	}
+
+	std::reverse(unsorted.begin(), unsorted.end());
+
+	long double	total = 0.0;
+
+	double	push_back_ns = TimeCalls(1, [&](int) {
+		mirr::CashFlowList	cash_flows;
+
+		for (mirr::CashFlow cash_flow : unsorted) {
+			cash_flows.push_back(cash_flow);
+		}
+		return cash_flows.size();
+	}, total);
+
+	std::size_t	assigned_size = 0;
+
+	double	assign_ns = TimeCalls(1, [&](int) {
+		mirr::CashFlowList	cash_flows;
+
+		cash_flows.Assign(unsorted);
+		assigned_size = cash_flows.size();
+		return cash_flows.size();
+	}, total);
+
+	cout << "Bench bulk load: " << unsorted.size() << " cash flows in reverse order" << std::fixed << std::setprecision(1) << endl;
+	cout << "  push_back  " << std::setw(14) << (push_back_ns / 1000.0) << " us  " << unsorted.size() << " cash flows" << endl;
+	cout << "  Assign     " << std::setw(14) << (assign_ns / 1000.0) << " us  " << assigned_size << " cash flows  x"
+		<< std::setprecision(2) << (push_back_ns / assign_ns) << endl;
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------
+// Measure the rate at which a CSV file of cash flows is read with one thread and with
+// a thread per core.
+bool	BenchCsvIngest()
+{
+	static const char*			kPath = "mirr_bench_cash_flows.csv";
+	static const std::size_t	kAccounts = 50000;
+
+	{
+		std::string		text = MakeCashFlowsCsv(kAccounts);
+		std::ofstream	file(kPath, std::ios::binary);
+
+		file.write(text.data(), text.size());
+	}
+
+	unsigned	thread_counts[] = { 1, 0 };
+
+	cout << "Bench CSV ingest:" << std::fixed << std::setprecision(1) << endl;
+
+	for (unsigned thread_count : thread_counts) {
+		mirr::Portfolio		portfolio;
+		mirr::CsvReadStats	stats;
+
+		auto	start = std::chrono::steady_clock::now();
+
+		bool	read = mirr::ReadCashFlowsCsv(kPath, thread_count, portfolio, stats);
+
+		auto	finish = std::chrono::steady_clock::now();
+		double	seconds = std::chrono::duration<double>(finish - start).count();
+
+		cout << "  " << stats.threads_ << " threads  " << (read ? "" : "(not read) ") << stats.rows_ << " rows, "
+			<< portfolio.size() << " accounts in " << (seconds * 1000.0) << " ms  "
+			<< (stats.bytes_ / seconds / 1e6) << " MB/s  " << (stats.rows_ / seconds / 1e6) << " M rows/s" << endl;
+	}
+
+	std::remove(kPath);
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------
+// Compare the time to open the same cash flows from CSV and from the binary file with
+// and without checking the sections' checksums, then solve every account through the
+// mapped views.
+bool	BenchCashFlowFile()
+{
+	static const char*			kCsvPath = "mirr_bench_cash_flows.csv";
+	static const char*			kBinaryPath = "mirr_bench_cash_flows.bin";
+	static const std::size_t	kAccounts = 50000;
+
+	{
+		std::string		text = MakeCashFlowsCsv(kAccounts);
+		std::ofstream	file(kCsvPath, std::ios::binary);
+
+		file.write(text.data(), text.size());
+	}
+
+	{
+		mirr::Portfolio		portfolio;
+		mirr::CsvReadStats	stats;
+
+		mirr::ReadCashFlowsCsv(kCsvPath, 0, portfolio, stats);
+		mirr::WriteCashFlowsBinary(kBinaryPath, portfolio);
+	}
+
+	cout << "Bench cash flow file:" << std::fixed << std::setprecision(3) << endl;
+
+	for (int source = 0; source < 3; source++) {
+		mirr::Portfolio		portfolio;
+		mirr::CsvReadStats	stats;
+		mirr::file_status_e	status = mirr::file_status_e::file_ok;
+
+		auto	start = std::chrono::steady_clock::now();
+
+		if (source == 0) {
+			mirr::ReadCashFlowsCsv(kCsvPath, 0, portfolio, stats);
+		}
+		else {
+			status = mirr::ReadCashFlowsBinary(kBinaryPath, portfolio, (source == 2));
+		}
+
+		auto	opened = std::chrono::steady_clock::now();
+
+		mirr::Calculator	calculator;
+		mirr::Rate_t		sum = 0.0;
+
+		calculator.print_log_ = false;
+
+		for (std::size_t a = 0; a < portfolio.size(); a++) {
+			calculator.calc_log.clear();
+
+			mirr::Rate_t	rate = calculator.GetRate(portfolio.GetView(a));
+
+			if (!std::isnan(rate)) {
+				sum += rate;
+			}
+		}
+
+		auto	finish = std::chrono::steady_clock::now();
+
+		static const char*	kSources[] = { "CSV            ", "binary         ", "binary verified" };
+
+		cout << "  " << kSources[source] << "  " << portfolio.GetCashFlowCount() << " cash flows opened in "
+			<< (std::chrono::duration<double>(opened - start).count() * 1000.0) << " ms, solved in "
+			<< (std::chrono::duration<double>(finish - opened).count() * 1000.0) << " ms  "
+			<< mirr::FileStatusName(status) << "  (sum " << sum << ")" << endl;
+	}
+
+	std::remove(kCsvPath);
+	std::remove(kBinaryPath);
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------
+// Report how far a numeric policy's NPV and rate for a plan are from the long double
+// calculation: the relative error of the NPV at a rate, the error of the rate, and the
+// residual, i.e. the long double NPV at the policy's rate relative to the sum of the
+// absolute amounts.  Optionally times the search.
+template <class PRECISION_T>
+void	ReportPrecision(const mirr::CashFlowPlan& in_plan, mirr::Rate_t in_expected_rate, int in_repeats,
+						double& io_max_rate_error, double& io_max_residual)
+{
+	using value_t = typename PRECISION_T::value_t;
+
+	static const mirr::Rate_t	kRate = 0.0735;
+
+	mirr::BasicCalculator<PRECISION_T>	calculator;
+	long double							total = 0.0;
+	mirr::NPV_t							scale = 0.0;
+
+	calculator.print_log_ = false;
+
+	for (const mirr::CashFlowAmt_t& amount : in_plan.GetAmounts()) {
+		scale += std::abs(amount);
+	}
+
+	mirr::NPV_t	expected_npv = in_plan.calculateNPV(kRate);
+	mirr::NPV_t	npv = in_plan.calculateNPV<PRECISION_T>(static_cast<value_t>(kRate));
+	value_t		rate = calculator.GetRate(in_plan);
+	double		rate_error = static_cast<double>(std::abs(rate - in_expected_rate));
+	double		residual = static_cast<double>(std::abs(in_plan.calculateNPV(rate)) / scale);
+
+	io_max_rate_error = std::max(io_max_rate_error, rate_error);
+	io_max_residual = std::max(io_max_residual, residual);
+
+	if (in_repeats > 0) {
+		double	solve_ns = TimeCalls(in_repeats, [&](int) {
+			calculator.calc_log.clear();
+			return calculator.GetRate(in_plan);
+		}, total);
+
+		cout << "  " << std::setw(20) << PRECISION_T::Name() << std::scientific << std::setprecision(2)
+			<< "  NPV " << std::setw(9) << static_cast<double>(std::abs((npv - expected_npv) / expected_npv))
+			<< "  rate " << std::setw(9) << rate_error
+			<< "  residual " << std::setw(9) << residual
+			<< std::fixed << std::setprecision(1) << "  " << std::setw(3) << calculator.GetEvaluations() << " evaluations "
+			<< std::setw(10) << (solve_ns / 1000.0) << " us/search" << endl;
+	}
+}
+
+//----------------------------------------------------------------------------------
+// Report the accuracy of each numeric policy against the long double calculation, for
+// the test cases and for long lists of cash flows where the errors of the sums grow,
+// so a faster policy can be chosen knowing what it costs in accuracy.
+bool	BenchPrecision()
+{
+	std::vector<MIRRTestCase>	test_cases = MakeMIRRTestCases();
+	double						rate_errors[4] = { 0.0, 0.0, 0.0, 0.0 };
+	double						residuals[4] = { 0.0, 0.0, 0.0, 0.0 };
+	const char*					names[4] = { mirr::FloatPrecision::Name(), mirr::DoublePrecision::Name(),
+												mirr::CompensatedDoublePrecision::Name(), mirr::LongDoublePrecision::Name() };
+
+	cout << "Bench precision: errors against long double (NPV relative, rate absolute, residual relative to the amounts)" << endl;
+
+	for (MIRRTestCase& test_case : test_cases) {
+		mirr::CashFlowPlan	plan(test_case.cash_flows_);
+		mirr::Calculator	calculator;
+
+		calculator.print_log_ = false;
+
+		mirr::Rate_t	expected_rate = calculator.GetRate(plan);
+
+		ReportPrecision<mirr::FloatPrecision>(plan, expected_rate, 0, rate_errors[0], residuals[0]);
+		ReportPrecision<mirr::DoublePrecision>(plan, expected_rate, 0, rate_errors[1], residuals[1]);
+		ReportPrecision<mirr::CompensatedDoublePrecision>(plan, expected_rate, 0, rate_errors[2], residuals[2]);
+		ReportPrecision<mirr::LongDoublePrecision>(plan, expected_rate, 0, rate_errors[3], residuals[3]);
+	}
+
+	cout << "  test cases, largest errors:" << endl;
+
+	for (int p = 0; p < 4; p++) {
+		cout << "  " << std::setw(20) << names[p] << std::scientific << std::setprecision(2)
+			<< "  rate " << std::setw(9) << rate_errors[p] << "  residual " << std::setw(9) << residuals[p] << endl;
+	}
+
+	for (int count : { 1000, 100000 }) {
+		mirr::CashFlowPlan	plan(MakeBenchCashFlows(count));
+		mirr::Calculator	calculator;
+		int					repeats = (count > 10000) ? 5 : 200;
+
+		calculator.print_log_ = false;
+
+		mirr::Rate_t	expected_rate = calculator.GetRate(plan);
+
+		cout << "  " << count << " cash flows:" << endl;
+
+		ReportPrecision<mirr::FloatPrecision>(plan, expected_rate, repeats, rate_errors[0], residuals[0]);
+		ReportPrecision<mirr::DoublePrecision>(plan, expected_rate, repeats, rate_errors[1], residuals[1]);
+		ReportPrecision<mirr::CompensatedDoublePrecision>(plan, expected_rate, repeats, rate_errors[2], residuals[2]);
+		ReportPrecision<mirr::LongDoublePrecision>(plan, expected_rate, repeats, rate_errors[3], residuals[3]);
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------
+// Compare searching in long double throughout with searching in double with the
+// vector kernel and polishing the rate in long double.
+bool	BenchMixedPrecision()
+{
+	cout << "Bench mixed precision: full long double search against double search + long double polish" << endl;
+
+	for (int count : { 10, 1000, 100000 }) {
+		mirr::CashFlowPlan	plan(MakeBenchCashFlows(count));
+		int					repeats = (count > 10000) ? 5 : ((count > 100) ? 200 : 20000);
+		long double			total = 0.0;
+
+		for (int p = 0; p < 2; p++) {
+			mirr::Calculator	calculator;
+
+			calculator.print_log_ = false;
+			calculator.options_.precision_ = (p == 0) ? mirr::solve_precision_e::full_precision : mirr::solve_precision_e::mixed_precision;
+
+			mirr::Rate_t	rate = calculator.GetRate(plan);
+			long			evaluations = calculator.GetEvaluations();
+
+			double	solve_ns = TimeCalls(repeats, [&](int) {
+				calculator.calc_log.clear();
+				return calculator.GetRate(plan);
+			}, total);
+
+			cout << "  " << std::setw(6) << count << " cash flows  " << ((p == 0) ? "full " : "mixed")
+				<< "  rate " << std::fixed << std::setprecision(15) << rate
+				<< "  residual " << std::scientific << std::setprecision(2) << static_cast<double>(plan.calculateNPV(rate))
+				<< std::fixed << std::setprecision(1) << "  " << std::setw(3) << evaluations << " evaluations "
+				<< std::setw(10) << (solve_ns / 1000.0) << " us/search" << endl;
+		}
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------
+// Compare the NPV kernel of each compounding convention with the list's pow() loop:
+// since inception and annual rates use exp() of exponents calculated in advance and a
+// daily rate uses tables of powers (many cash flows) or repeated squaring (few cash
+// flows over a long range).
+bool	BenchCompounding()
+{
+	static const char*	kNames[] = { "inception", "annual   ", "daily    " };
+
+	mirr::CashFlowList	sparse;
+	long double			total = 0.0;
+
+	for (int i = 0; i < 24; i++) {
+		sparse.push_back(mirr::CashFlow(dates::MakeDate("1990-01-01") + (i * 400), 1000.0 + i));
+	}
+	sparse.push_back(mirr::CashFlow(dates::MakeDate("2017-01-01"), -60000.0));
+
+	cout << "Bench compounding conventions:" << endl;
+
+	for (int list = 0; list < 2; list++) {
+		mirr::CashFlowList	cash_flows = (list == 0) ? MakeBenchCashFlows(10000) : sparse;
+		int					repeats = (list == 0) ? 200 : 200000;
+
+		cout << "  " << cash_flows.size() << " cash flows over " << cash_flows.GetDaysInRange() << " days" << endl;
+
+		for (mirr::compounding_e compounding : { mirr::compounding_e::since_inception, mirr::compounding_e::annual, mirr::compounding_e::daily }) {
+			mirr::CashFlowPlan	plan(cash_flows, compounding);
+			mirr::Rate_t		rate = (compounding == mirr::compounding_e::daily) ? 0.0002 :
+										((compounding == mirr::compounding_e::annual) ? 0.0735 : 0.5);
+
+			mirr::NPV_t	expected = cash_flows.calculateNPV(rate, compounding);
+			mirr::NPV_t	npv = plan.calculateNPV(rate);
+			double		npv_double = plan.calculateNPVDouble(static_cast<double>(rate));
+
+			double	list_ns = TimeCalls(repeats / 10, [&](int i) { return cash_flows.calculateNPV(rate + i * 1e-12, compounding); }, total);
+			double	plan_ns = TimeCalls(repeats, [&](int i) { return plan.calculateNPV(rate + i * 1e-12); }, total);
+			double	double_ns = TimeCalls(repeats, [&](int i) { return plan.calculateNPVDouble(static_cast<double>(rate + i * 1e-12)); }, total);
+
+			cout << "  " << kNames[compounding] << std::fixed << std::setprecision(1)
+				<< "  list pow() " << std::setw(10) << list_ns << " ns"
+				<< "  plan " << std::setw(10) << plan_ns << " ns  x" << std::setprecision(2) << (list_ns / plan_ns)
+				<< std::setprecision(1) << "  double kernel " << std::setw(8) << double_ns << " ns  x" << std::setprecision(2) << (list_ns / double_ns)
+				<< "  relative error " << std::scientific << static_cast<double>(std::abs((npv - expected) / expected))
+				<< " / " << std::abs((npv_double - expected) / expected) << std::fixed << endl;
+		}
+	}
+
+	cout << "  (checksum " << total << ")" << endl;
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------
+// Compare walking the discounts with finding each with exp() for weekly and month-end
+// contributions over 20 years and for cash flows at random gaps, which have too many
+// distinct gaps to be walked.
+bool	BenchDiscountWalk()
+{
+	static const char*	kNames[] = { "weekly   ", "monthly  ", "irregular" };
+
+	mirr::CashFlowList	weekly;
+	mirr::CashFlowList	monthly;
+	mirr::CashFlowList	irregular;
+	dates::Date_t		start_date = dates::MakeDate("1997-01-31");
+	long double			total = 0.0;
+
+	for (int i = 0; i < 1040; i++) {
+		weekly.push_back(mirr::CashFlow(start_date + i * 7, 100.0 + (i % 13) * 10.0));
+	}
+	weekly.push_back(mirr::CashFlow(start_date + 1040 * 7, -300000.0));
+
+	for (int i = 0; i < 240; i++) {
+		monthly.push_back(mirr::CashFlow(dates::AddMonths(start_date, i), 500.0 + (i % 5) * 50.0));
+	}
+	monthly.push_back(mirr::CashFlow(dates::AddMonths(start_date, 240), -250000.0));
+
+	std::srand(1);
+
+	for (int i = 0, day = 0; i < 1000; i++, day += 1 + (std::rand() % 200)) {
+		irregular.push_back(mirr::CashFlow(start_date + day, 100.0 + (std::rand() % 10000) / 100.0));
+	}
+	irregular.push_back(mirr::CashFlow(start_date + 110000, -300000.0));
+
+	cout << "Bench discount walk:" << endl;
+
+	for (int list = 0; list < 3; list++) {
+		mirr::CashFlowList	cash_flows = (list == 0) ? weekly : ((list == 1) ? monthly : irregular);
+		mirr::CashFlowPlan	walked(cash_flows);
+		mirr::CashFlowPlan	exact(cash_flows);
+		mirr::Rate_t		rate = 0.35;
+
+		exact.SetDiscountWalk(false);
+
+		mirr::NPV_t	expected = cash_flows.calculateNPV(rate);
+		mirr::NPV_t	walked_npv = walked.calculateNPV(rate);
+		mirr::NPV_t	exact_npv = exact.calculateNPV(rate);
+
+		double	exact_ns = TimeCalls(20000, [&](int i) { return exact.calculateNPV(rate + i * 1e-12); }, total);
+		double	walked_ns = TimeCalls(20000, [&](int i) { return walked.calculateNPV(rate + i * 1e-12); }, total);
+		double	derivatives_exact_ns = TimeCalls(20000, [&](int i) { return exact.calculateNPVDerivatives(rate + i * 1e-12).first_; }, total);
+		double	derivatives_walked_ns = TimeCalls(20000, [&](int i) { return walked.calculateNPVDerivatives(rate + i * 1e-12).first_; }, total);
+
+		cout << "  " << kNames[list] << std::setw(6) << cash_flows.size() << " cash flows " << std::setw(3) << walked.GetDistinctGaps() << " gaps"
+			<< (walked.IsDiscountWalked() ? " walked" : "       ") << std::fixed << std::setprecision(1)
+			<< "  NPV exp() " << std::setw(8) << exact_ns << " ns  walk " << std::setw(8) << walked_ns << " ns  x" << std::setprecision(2) << (exact_ns / walked_ns)
+			<< std::setprecision(1) << "  derivatives exp() " << std::setw(8) << derivatives_exact_ns << " ns  walk " << std::setw(8) << derivatives_walked_ns
+			<< " ns  x" << std::setprecision(2) << (derivatives_exact_ns / derivatives_walked_ns)
+			<< "  relative error " << std::scientific << static_cast<double>(std::abs((walked_npv - expected) / expected))
+			<< " / " << static_cast<double>(std::abs((exact_npv - expected) / expected)) << std::fixed << endl;
+	}
+
+	cout << "  (checksum " << total << ")" << endl;
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------
+// Compare solving cash flows on a grid of months from the periodic estimate with the
+// generic search (Brent's method from the fixed bracket), and the periodic NPV by
+// Horner's scheme with the plan's NPV, for month-end contributions over 20 years and
+// quarterly ones over 30 years.
+bool	BenchPeriodicCashFlows()
+{
+	static const char*	kNames[] = { "month end", "quarterly" };
+
+	mirr::CashFlowList	month_end;
+	mirr::CashFlowList	quarterly;
+	long double			total = 0.0;
+
+	for (int i = 0; i < 240; i++) {
+		month_end.push_back(mirr::CashFlow(dates::AddMonths(dates::MakeDate("1997-01-31"), i), 500.0 + (i % 5) * 50.0));
+	}
+	month_end.push_back(mirr::CashFlow(dates::AddMonths(dates::MakeDate("1997-01-31"), 240), -250000.0));
+
+	for (int i = 0; i < 120; i++) {
+		quarterly.push_back(mirr::CashFlow(dates::AddMonths(dates::MakeDate("1987-03-30"), i * 3), 1500.0 + (i % 4) * 100.0));
+	}
+	quarterly.push_back(mirr::CashFlow(dates::AddMonths(dates::MakeDate("1987-03-30"), 360), -600000.0));
+
+	cout << "Bench periodic cash flows:" << endl;
+
+	for (int list = 0; list < 2; list++) {
+		mirr::CashFlowList&	cash_flows = (list == 0) ? month_end : quarterly;
+		mirr::CashFlowPlan	plan(cash_flows);
+		mirr::Calculator	calculator;
+
+		calculator.print_log_ = false;
+
+		double	plan_ns = TimeCalls(20000, [&](int i) { return plan.calculateNPV(0.5 + i * 1e-12); }, total);
+		double	horner_ns = TimeCalls(20000, [&](int i) { return plan.calculatePeriodicNPV(0.004 + i * 1e-12); }, total);
+
+		mirr::Rate_t	periodic_rate = calculator.GetRate(plan);
+		long			periodic_evaluations = calculator.GetEvaluations();
+		double			periodic_ns = TimeCalls(2000, [&](int) { return calculator.GetRate(plan); }, total);
+
+		calculator.options_.periodic_ = false;
+
+		mirr::Rate_t	generic_rate = calculator.GetRate(plan);
+		long			generic_evaluations = calculator.GetEvaluations();
+		double			generic_ns = TimeCalls(2000, [&](int) { return calculator.GetRate(plan); }, total);
+
+		cout << "  " << kNames[list] << std::setw(5) << cash_flows.size() << " cash flows " << std::setw(4) << plan.GetPeriodicAmounts().size() << " periods"
+			<< std::fixed << std::setprecision(1) << "  NPV plan " << std::setw(8) << plan_ns << " ns  Horner " << std::setw(8) << horner_ns << " ns"
+			<< "  rate generic " << std::setw(9) << generic_ns << " ns (" << generic_evaluations << " evaluations)"
+			<< "  periodic " << std::setw(9) << periodic_ns << " ns (" << periodic_evaluations << " evaluations)  x" << std::setprecision(2) << (generic_ns / periodic_ns)
+			<< "  difference " << std::scientific << static_cast<double>(std::abs(periodic_rate - generic_rate)) << std::fixed << endl;
+	}
+
+	cout << "  (checksum " << total << ")" << endl;
+
+	return true;
+}
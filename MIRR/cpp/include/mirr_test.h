@@ -6,9 +6,22 @@
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <fstream>
+#include <string>
 
+#include "batch_calculator.h"
+#include "cash_flow_file.h"
+#include "cash_flow_plan.h"
+#include "command_line.h"
+#include "csv_reader.h"
 #include "date_math.h"
+#include "incremental_calculator.h"
 #include "modified_irr.h"
+#include "npv_kernels.h"
+#include "rate_roots.h"
+#include "result_file.h"
 #include "roots.h"
 
 using namespace std;
@@ -18,12 +31,12 @@ using namespace std;
 bool	TestCashFlowList() 
 {
 	mirr::CashFlowList		cash_flows;
-	std::time_t				starting_date = std::time(0);
+	dates::Date_t			starting_date = dates::DateFromTime(std::time(0));
 
 	cout << "Max cash flow" << RAND_MAX << endl;
 
 	for (int i = 0; i < 10; i++) {
-		std::time_t		cash_flow_date(dates::AddMonths(starting_date, i));
+		dates::Date_t	cash_flow_date(dates::AddMonths(starting_date, i));
 		cash_flows.push_back(mirr::CashFlow(cash_flow_date, (std::rand())));
 	}
 
@@ -63,287 +76,1691 @@ bool	TestNPV()
 }
 
 //----------------------------------------------------------------------------------
-// Test searching for the IRR that will make the NPV of the series of cash flows = 0.
-bool	TestMIRR()
+// Test that the columns built from a list of cash flows produce the same NPV as the list.
+bool	TestCashFlowColumns()
 {
-	mirr::CashFlowList	cash_flows;
-	mirr::Calculator	calculator;
-	mirr::Rate_t		result;
-	
-	// Set up the list of cash flows.
-	
-	//Test Case 0:
+	mirr::CashFlowList		cash_flows;
 
+	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2009-10-26"), 20439.95));
 	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2007-05-31"), 9978.82));
 	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2007-06-14"), 15000.0));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2009-10-26"), 20439.95));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2009-11-09"), -5000.0));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2010-02-11"), 3000.0));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-10-24"), 49190.0));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2015-02-13"), -122444.29));
+	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-10-24"), -112961.67));
 
-	cout << "Test TestMIRR:" << endl;
-	for (mirr::CashFlow& cash_flow : cash_flows) {
-		cout << cash_flow.ToString() << endl;
-	}
+	mirr::CashFlowColumns	columns(cash_flows);
+	mirr::CashFlowView		view = columns.GetView();
 
-	// Solve for the modified internal rate of return that makes those cash flows have an NPV = 0.
+	bool	matched = true;
 
-	result = calculator.GetRate(cash_flows);
+	for (mirr::Rate_t rate : { -0.5L, 0.0L, 0.000394780648885L, 0.25L, 3.0L }) {
+		mirr::NPV_t	list_npv = cash_flows.calculateNPV(rate);
+		mirr::NPV_t	view_npv = view.calculateNPV(rate);
 
-	cout << "IRR=" << std::fixed << std::setw(15) << std::setprecision(30) << result << endl;
-	cout << "Expected IRR= 0.6935541782410140" << endl;
+		cout << "NPV(" << rate << ") list = " << list_npv << " columns = " << view_npv << endl;
+		matched = matched && (list_npv == view_npv);
+	}
 
-	cout << endl << endl;
+	cout << "Test CashFlowColumns: " << (matched ? "matched" : "MISMATCH") << endl;
 
-	//Test Case 1: IRR = 0.57068992946099172768520
+	return matched;
+}
 
-	calculator.calc_log.clear();
-	cash_flows.clear();
+//----------------------------------------------------------------------------------
+// Test that a compiled plan sorts the cash flows, counts their signs and produces
+// the same NPV as the list.
+bool	TestCashFlowPlan()
+{
+	mirr::CashFlowList		cash_flows;
 
 	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-12-31"), 27));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-01-02"), 1092));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-02-25"), 1354.8));
 	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-03-25"), -429.28));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-04-07"), -85.05));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-05-26"), -1415));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-06-02"), -1188));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-06-16"), -489.5));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-06-25"), -62.25));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-07-28"), 500.39));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-08-25"), 1532.79));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-09-02"), 75.7));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-09-22"), 35.5));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-10-20"), 3035.8));
+	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-02-25"), 1354.8));
 	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-10-30"), -4627));
 	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-10-31"), 109.8));
 
-	for (mirr::CashFlow& cash_flow : cash_flows) {
-		cout << cash_flow.ToString() << endl;
+	mirr::CashFlowPlan	plan(cash_flows);
+	bool				matched = ((plan.GetDaysInRange() == 304) && (plan.GetPositiveCount() == 3) &&
+									(plan.GetNegativeCount() == 2) && (plan.GetSignChanges() == 2));
+
+	for (mirr::Rate_t rate : { -0.5L, 0.0L, 0.25L, 3.0L }) {
+		mirr::NPV_t	list_npv = cash_flows.calculateNPV(rate);
+		mirr::NPV_t	plan_npv = plan.calculateNPV(rate);
+
+		cout << "NPV(" << rate << ") list = " << list_npv << " plan = " << plan_npv << endl;
+		matched = matched && (std::abs(list_npv - plan_npv) < 1e-9);
 	}
 
-	result = calculator.GetRate(cash_flows);
-	cout << "IRR=" << std::fixed << std::setw(15) << std::setprecision(30) << result << endl;
-	cout << "Expected IRR= 0.57068992946099172768520" << endl;
+	// Cash flows all on one day have no range to compound over, so their exponents are
+	// zero (not 0 / 0) and there is no rate to search for.
 
-	//Test Case 2: IRR = 54.52564034284328783070
+	mirr::CashFlowList	same_day;
 
-	calculator.calc_log.clear();
-	cash_flows.clear();
-
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-02-07"), 323.28));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-02-12"), 6193.87));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-02-13"), 12958.49));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-03-25"), -5880.88));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-04-10"), 7433.3));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-04-25"), -14451.17));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-04-26"), 3541.24));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-05-08"), -6829.46));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-05-29"), 560.8));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-06-07"), 611.1));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-06-21"), -4485.53));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-07-09"), -9991.02));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-07-23"), -7387.22));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-10-22"), 219.55));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-11-13"), 8673.57));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-11-22"), -15306.6));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-12-16"), 8461.69));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-12-17"), 1563.95));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-01-14"), 3556.8));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-01-22"), -32427.98));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-01-28"), 3130.5));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-03-03"), 1200));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-03-24"), -646.53));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-03-26"), 33894));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-04-24"), -8793.99));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-05-01"), -12599.94));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-05-06"), 6193.61));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-05-12"), 5055.24));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-08-28"), 114.69));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-10-02"), -32467.25));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-10-24"), 809.82));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-10-31"), 0));
+	same_day.push_back(mirr::CashFlow(dates::MakeDate("2015-01-01"), -100));
+	same_day.push_back(mirr::CashFlow(dates::MakeDate("2015-01-01"), 150));
 
-	for (mirr::CashFlow& cash_flow : cash_flows) {
-		cout << cash_flow.ToString() << endl;
+	mirr::CashFlowPlan	same_day_plan(same_day);
+	mirr::Calculator	calculator;
+
+	calculator.print_log_ = false;
+	calculator.GetRate(same_day_plan);
+
+	if ((same_day_plan.GetExponents()[0] != 0.0) || (same_day_plan.GetExponents()[1] != 0.0) || same_day_plan.HasRoot() ||
+		(same_day_plan.calculateNPV(0.1) != 50.0) || (calculator.GetStatus() != mirr::solve_status_e::not_bracketed)) {
+		cout << "Same day NPV " << same_day_plan.calculateNPV(0.1) << " status " << calculator.GetStatus() << endl;
+		matched = false;
 	}
 
-	result = calculator.GetRate(cash_flows);
-	cout << "IRR=" << std::fixed << std::setw(15) << std::setprecision(30) << result << endl;
-	cout << "Expected IRR= 54.52564034284328783070" << endl;
-	
-	//Test Case 3: 
-
-	calculator.calc_log.clear();
-	cash_flows.clear();
-
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-02-04"), 444));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-02-10"), 177300.25));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-02-16"), 1593162.55));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-03-10"), 21600));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-03-11"), 14400));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-03-29"), 112595));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-03-31"), 455950));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-04-01"), -51276.3));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-04-15"), 1504.77));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-05-02"), -45514.7));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-05-27"), 30100));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-06-20"), -119818));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-06-30"), 32225));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-07-14"), 20448));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-07-20"), 50178.81));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-08-12"), 54222.2));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-09-14"), 70860.76));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-09-21"), 100366.7));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-09-23"), -104663.2));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-09-27"), 38143));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-09-30"), -33170));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-10-07"), 19430));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-10-18"), 50958.68));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-10-26"), -65940));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-11-04"), 61703.4));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-11-09"), 31480));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-11-17"), 32515.4));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-11-22"), 511.2));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-12-31"), 0));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-01-30"), 15092.98));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-02-02"), 265586.2));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-02-08"), -218030));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-02-09"), 156750));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-02-27"), 32210.4));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-03-07"), 82921.13));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-03-12"), 224200));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-03-15"), -225232));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-03-30"), 0));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-04-19"), -35420.43));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-04-30"), 115850));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-05-03"), -120275.2));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-05-11"), 34009.6));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-05-22"), -44722.22));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-05-30"), -71468));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-06-07"), 106334.51));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-06-12"), -110030));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-06-29"), 0));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-07-24"), -5769.55));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-07-31"), -87962.5));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-08-20"), 93008.78));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-08-28"), 32681.1));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-09-10"), -95229.5));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-09-28"), 47350));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-10-02"), -50723.82));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-10-05"), -3072999.35));
+	cout << "Test CashFlowPlan: " << (matched ? "matched" : "MISMATCH") << endl;
 
-	for (mirr::CashFlow& cash_flow : cash_flows) {
-		cout << cash_flow.ToString() << endl;
+	return matched;
+}
+
+//----------------------------------------------------------------------------------
+// Test each compounding convention: a plan's kernels must match the list's pow() loop,
+// both for a few cash flows (powers by repeated squaring) and for many (power tables),
+// and the annual rate must match Excel's XIRR example (0.373362535 as Excel shows it).  A daily rate compounded over a
+// year must be the same annual rate.
+bool	TestCompounding()
+{
+	mirr::CashFlowList	xirr;
+	mirr::CashFlowList	many;
+	bool				matched = true;
+
+	xirr.push_back(mirr::CashFlow(dates::MakeDate("2008-01-01"), -10000));
+	xirr.push_back(mirr::CashFlow(dates::MakeDate("2008-03-01"), 2750));
+	xirr.push_back(mirr::CashFlow(dates::MakeDate("2008-10-30"), 4250));
+	xirr.push_back(mirr::CashFlow(dates::MakeDate("2009-02-15"), 3250));
+	xirr.push_back(mirr::CashFlow(dates::MakeDate("2009-04-01"), 2750));
+
+	for (int i = 0; i < 400; i++) {
+		many.push_back(mirr::CashFlow(dates::MakeDate("2010-01-01") + (i * 3), 100.0 + (i % 7) * 25.0));
 	}
+	many.push_back(mirr::CashFlow(dates::MakeDate("2013-06-30"), -60000));
 
-	result = calculator.GetRate(cash_flows);
-	cout << "IRR=" << std::fixed << std::setw(15) << std::setprecision(30) << result << endl;
-	cout << "Expected IRR= 0.15577775610447013648378" << endl;
-	
-	//Test Case 4:
+	for (mirr::CashFlowList* cash_flows : { &xirr, &many }) {
+		for (mirr::compounding_e compounding : { mirr::compounding_e::since_inception, mirr::compounding_e::annual, mirr::compounding_e::daily }) {
+			mirr::CashFlowPlan	plan(*cash_flows, compounding);
 
-	calculator.calc_log.clear();
-	cash_flows.clear();
-
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-01-24"), 320.8));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-01-29"), 352.6));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-02-01"), -92.15));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-02-28"), 740));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-03-26"), 655));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-04-25"), 2707.75));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-05-13"), -1159.59));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-05-27"), -3921.1));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-06-27"), 2290.05));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-07-16"), -279.81));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-07-29"), -1117.92));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-08-15"), -457.25));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-08-28"), -1809));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-09-25"), -934));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-10-30"), 590));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-11-28"), -842));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-01-02"), 1092));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-02-25"), 1354.8));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-03-25"), -429.28));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-04-07"), -85.05));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-05-26"), -1415));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-06-02"), -1188));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-06-16"), -489.5));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-06-25"), -62.25));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-07-28"), 500.39));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-08-25"), 1532.79));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-09-02"), 75.7));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-09-22"), 35.5));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-10-20"), 3035.8));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-10-30"), -4627));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-10-31"), 109.8));
+			for (mirr::Rate_t rate : { -0.0005L, 0.0L, 0.0003L, 0.08L, 0.5L }) {
+				mirr::NPV_t	list_npv = cash_flows->calculateNPV(rate, compounding);
+				mirr::NPV_t	plan_npv = plan.calculateNPV(rate);
+				mirr::NPV_t	scale = 0.0;
 
-	for (mirr::CashFlow& cash_flow : cash_flows) {
-		cout << cash_flow.ToString() << endl;
+				for (mirr::CashFlow& cash_flow : *cash_flows) {
+					scale += std::abs(cash_flow.amount_);
+				}
+
+				if (std::abs(list_npv - plan_npv) > 1e-15 * scale) {
+					cout << "  compounding " << compounding << " NPV(" << rate << ") list = " << list_npv << " plan = " << plan_npv << endl;
+					matched = false;
+				}
+			}
+		}
 	}
 
-	result = calculator.GetRate(cash_flows);
-	cout << "IRR=" << std::fixed << std::setw(15) << std::setprecision(30) << result << endl;
-	cout << "Expected IRR= 17.823529759677437485977" << endl;
+	mirr::Calculator	calculator;
 
-	//Test Case 5:
+	calculator.print_log_ = false;
+	calculator.options_.compounding_ = mirr::compounding_e::annual;
 
-	calculator.calc_log.clear();
-	cash_flows.clear();
+	mirr::Rate_t	annual_rate = calculator.GetRate(xirr);
 
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2007-05-31"), 9978.82));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2007-06-14"), 15000));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2009-10-26"), 20439.95));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2009-11-09"), -5000));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2010-02-11"), 3000));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-10-24"), 49190));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-02-28"), -112961.67));
+	calculator.options_.compounding_ = mirr::compounding_e::daily;
 
-	for (mirr::CashFlow& cash_flow : cash_flows) {
-		cout << cash_flow.ToString() << endl;
+	mirr::Rate_t	daily_rate = calculator.GetRate(xirr);
+
+	cout << "XIRR = " << std::setprecision(12) << annual_rate << " daily = " << daily_rate << endl;
+
+	if ((std::abs(annual_rate - 0.3733625335188) > 1e-9) || (std::abs(std::pow(1.0L + daily_rate, 365.0L) - (1.0L + annual_rate)) > 1e-6)) {
+		matched = false;
 	}
 
-	result = calculator.GetRate(cash_flows);
-	cout << "IRR=" << std::fixed << std::setw(15) << std::setprecision(30) << result << endl;
-	cout << "Expected IRR= 0.5391053430857646636078" << endl;
+	cout << "Test Compounding: " << (matched ? "matched" : "MISMATCH") << endl;
 
-	//Test Case 6: 
+	return matched;
+}
 
-	calculator.calc_log.clear();
-	cash_flows.clear();
+//----------------------------------------------------------------------------------
+// Test walking the discounts of cash flows whose gaps repeat: weekly and month-end
+// contributions must be walked with 1 and 4 distinct gaps, and their NPVs and
+// derivatives must match those with each discount found by exp() to within about
+// as many units in the last place as are walked between anchors.  Cash flows with
+// too many distinct gaps must not be walked.
+bool	TestDiscountWalk()
+{
+	mirr::CashFlowList	weekly;
+	mirr::CashFlowList	monthly;
+	mirr::CashFlowList	irregular;
+	dates::Date_t		start_date = dates::MakeDate("2004-01-31");
+	bool				matched = true;
 
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2015-01-01"), 100));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2016-01-01"), -75));
+	for (int i = 0; i < 520; i++) {
+		weekly.push_back(mirr::CashFlow(start_date + i * 7, 100.0 + (i % 13) * 10.0));
+	}
+	weekly.push_back(mirr::CashFlow(start_date + 520 * 7, -90000));
 
-	for (mirr::CashFlow& cash_flow : cash_flows) {
-		cout << cash_flow.ToString() << endl;
+	for (int i = 0; i < 240; i++) {
+		monthly.push_back(mirr::CashFlow(dates::AddMonths(start_date, i), 500.0 + (i % 5) * 50.0));
+	}
+	monthly.push_back(mirr::CashFlow(dates::AddMonths(start_date, 240), -250000));
+
+	for (int i = 0; i < 200; i++) {
+		irregular.push_back(mirr::CashFlow(start_date + (i * i) / 3, 100.0));
+	}
+	irregular.push_back(mirr::CashFlow(start_date + 20000, -40000));
+
+	for (mirr::compounding_e compounding : { mirr::compounding_e::since_inception, mirr::compounding_e::annual }) {
+		mirr::CashFlowPlan	walked_weekly(weekly, compounding);
+		mirr::CashFlowPlan	walked_monthly(monthly, compounding);
+		mirr::CashFlowPlan	not_walked(irregular, compounding);
+
+		matched = matched && walked_weekly.IsDiscountWalked() && (walked_weekly.GetDistinctGaps() == 1);
+		matched = matched && walked_monthly.IsDiscountWalked() && (walked_monthly.GetDistinctGaps() == 4);
+		matched = matched && !not_walked.IsDiscountWalked();
+
+		for (mirr::CashFlowPlan* walked : { &walked_weekly, &walked_monthly }) {
+			mirr::CashFlowPlan	exact(*walked);
+			mirr::NPV_t			scale = 0.0;
+
+			exact.SetDiscountWalk(false);
+
+			for (mirr::CashFlowAmt_t amount : walked->GetAmounts()) {
+				scale += std::abs(amount);
+			}
+
+			for (mirr::Rate_t rate : { -0.5L, -0.01L, 0.0L, 0.07L, 0.9L }) {
+				mirr::NPV_t				walked_npv = walked->calculateNPV(rate);
+				mirr::NPV_t				exact_npv = exact.calculateNPV(rate);
+				double					walked_double = walked->calculateNPV<mirr::DoublePrecision>(static_cast<double>(rate));
+				double					exact_double = exact.calculateNPV<mirr::DoublePrecision>(static_cast<double>(rate));
+				mirr::NPVDerivatives	walked_derivatives = walked->calculateNPVDerivatives(rate);
+				mirr::NPVDerivatives	exact_derivatives = exact.calculateNPVDerivatives(rate);
+				mirr::NPV_t				growth = std::max(static_cast<mirr::NPV_t>(1.0), std::pow(1.0L + rate, -walked->GetPeriodsInRange()));
+				mirr::NPV_t				tolerance = 1e-16L * scale * growth;
+
+				if ((std::abs(walked_npv - exact_npv) > tolerance) ||
+					(std::abs(walked_double - exact_double) > 1e-13 * static_cast<double>(scale * growth)) ||
+					(std::abs(walked_derivatives.npv_ - exact_derivatives.npv_) > tolerance) ||
+					(std::abs(walked_derivatives.first_ - exact_derivatives.first_) > tolerance * walked->GetPeriodsInRange()))
+				{
+					cout << "  compounding " << compounding << " NPV(" << rate << ") walked = " << walked_npv << " exp = " << exact_npv << endl;
+					matched = false;
+				}
+			}
+		}
+	}
+
+	cout << "Test DiscountWalk: " << (matched ? "matched" : "MISMATCH") << endl;
+
+	return matched;
+}
+
+//----------------------------------------------------------------------------------
+// Test the periodic path: cash flows on the last day of each month, or every quarter
+// from a day some months do not have, must be found on their grid of months while
+// cash flows a day off it or weekly must not.  The periodic NPV by Horner's scheme
+// must match the powers calculated directly, the polynomial solver must find a known
+// rate, and the rate the calculator finds from the periodic estimate must match the
+// one it finds with its generic search.  Plans built from a portfolio's views must be
+// periodic exactly when the lists are.
+bool	TestPeriodicCashFlows()
+{
+	mirr::CashFlowList			month_end;
+	mirr::CashFlowList			quarterly;
+	mirr::CashFlowList			off_grid;
+	mirr::CashFlowList			weekly;
+	std::vector<std::size_t>	periods;
+	bool						matched = true;
+
+	for (int i = 0; i < 120; i++) {
+		month_end.push_back(mirr::CashFlow(dates::AddMonths(dates::MakeDate("2004-01-31"), i), 200.0 + (i % 7) * 15.0));
+		quarterly.push_back(mirr::CashFlow(dates::AddMonths(dates::MakeDate("2010-01-30"), i * 3), 1000.0 + (i % 4) * 100.0));
+		weekly.push_back(mirr::CashFlow(dates::MakeDate("2010-01-01") + i * 7, 50.0));
+	}
+	month_end.push_back(mirr::CashFlow(dates::MakeDate("2014-01-31"), -40000));
+	quarterly.push_back(mirr::CashFlow(dates::AddMonths(dates::MakeDate("2010-01-30"), 360), -250000));
+	weekly.push_back(mirr::CashFlow(dates::MakeDate("2010-01-01") + 120 * 7, -7000));
+
+	off_grid = month_end;
+	off_grid[13].date_ = dates::MakeDate("2005-02-27");
+
+	matched = matched && (month_end.FindMonthlyGrid(periods) == 1) && (periods[1] == 1) && (periods.back() == 120);
+	matched = matched && (dates::Date2String(month_end[1].date_) == "2004-02-29") && (dates::Date2String(month_end[2].date_) == "2004-03-31");
+	matched = matched && (quarterly.FindMonthlyGrid(periods) == 3) && (periods.back() == 120);
+	matched = matched && (off_grid.FindMonthlyGrid(periods) == 0) && (weekly.FindMonthlyGrid(periods) == 0);
+
+	cout << "Grid months: month end " << month_end.FindMonthlyGrid(periods) << " quarterly " << quarterly.FindMonthlyGrid(periods)
+		<< " off grid " << off_grid.FindMonthlyGrid(periods) << " weekly " << weekly.FindMonthlyGrid(periods) << endl;
+
+	// Horner's scheme against the powers.
+
+	mirr::CashFlowPlan	month_end_plan(month_end);
+
+	for (mirr::Rate_t rate : { -0.02L, 0.0L, 0.004L, 0.1L }) {
+		mirr::NPV_t	expected = 0.0;
+		mirr::NPV_t	scale = 0.0;
+
+		for (std::size_t k = 0; k < month_end_plan.GetPeriodicAmounts().size(); k++) {
+			expected += month_end_plan.GetPeriodicAmounts()[k] / std::pow(1.0L + rate, static_cast<mirr::Rate_t>(k));
+			scale += std::abs(month_end_plan.GetPeriodicAmounts()[k]);
+		}
+
+		mirr::NPV_t	npv = month_end_plan.calculatePeriodicNPV(rate);
+
+		if (std::abs(npv - expected) > 1e-15 * scale * std::max(1.0L, std::pow(1.0L + rate, -120.0L))) {
+			cout << "  periodic NPV(" << rate << ") = " << npv << " != " << expected << endl;
+			matched = false;
+		}
+	}
+
+	// -1000 = 500x + 600x^2 at x = 1 / (1 + rate).
+
+	mirr::CashFlowList	known;
+
+	known.push_back(mirr::CashFlow(dates::MakeDate("2012-05-31"), -1000));
+	known.push_back(mirr::CashFlow(dates::MakeDate("2012-06-30"), 500));
+	known.push_back(mirr::CashFlow(dates::MakeDate("2012-07-31"), 600));
+
+	mirr::Rate_t	known_rate = mirr::CashFlowPlan(known).GetPeriodicRate();
+	mirr::Rate_t	expected_rate = (1200.0L / (std::sqrt(500.0L * 500.0L + 4.0L * 600.0L * 1000.0L) - 500.0L)) - 1.0L;
+
+	cout << "Periodic rate = " << std::setprecision(15) << known_rate << " expected " << expected_rate << endl;
+
+	matched = matched && (std::abs(known_rate - expected_rate) < 1e-15);
+
+	// The calculator's rate with and without the periodic path.
+
+	mirr::CashFlowList	two_signs = month_end;
+
+	two_signs.push_back(mirr::CashFlow(dates::MakeDate("2014-02-28"), 30000));
+
+	matched = matched && std::isnan(mirr::CashFlowPlan(two_signs).GetPeriodicRate());
+
+	for (mirr::CashFlowList* cash_flows : { &month_end, &quarterly, &two_signs }) {
+		for (mirr::compounding_e compounding : { mirr::compounding_e::since_inception, mirr::compounding_e::annual }) {
+			mirr::Calculator	calculator;
+
+			calculator.print_log_ = false;
+			calculator.options_.compounding_ = compounding;
+
+			mirr::Rate_t	periodic_rate = calculator.GetRate(*cash_flows);
+			long			periodic_evaluations = calculator.GetEvaluations();
+
+			calculator.options_.periodic_ = false;
+
+			mirr::Rate_t	generic_rate = calculator.GetRate(*cash_flows);
+			long			generic_evaluations = calculator.GetEvaluations();
+
+			cout << "  compounding " << compounding << " periodic " << std::setprecision(15) << periodic_rate << " (" << periodic_evaluations
+				<< " evaluations) generic " << generic_rate << " (" << generic_evaluations << " evaluations)" << endl;
+
+			matched = matched && (calculator.GetStatus() == mirr::solve_status_e::solved);
+			matched = matched && (std::abs(periodic_rate - generic_rate) < 1e-12 * std::max(1.0L, std::abs(generic_rate)));
+		}
+	}
+
+	// A portfolio's views have the accounts' start dates, so plans built from them find
+	// the same grids and periodic amounts as the lists and the calculator the same rates.
+
+	std::vector<mirr::CashFlowList*>	accounts = { &month_end, &quarterly, &weekly };
+	mirr::PortfolioStorage				storage;
+	mirr::Portfolio						portfolio;
+
+	storage.offsets_.push_back(0);
+	storage.id_offsets_.push_back(0);
+
+	for (mirr::CashFlowList* cash_flows : accounts) {
+		dates::Date_t	start_date = cash_flows->front().date_;
+
+		for (const mirr::CashFlow& cash_flow : *cash_flows) {
+			start_date = std::min(start_date, cash_flow.date_);
+		}
+
+		for (const mirr::CashFlow& cash_flow : *cash_flows) {
+			storage.days_.push_back(static_cast<mirr::Day_t>(cash_flow.date_ - start_date));
+			storage.amounts_.push_back(static_cast<double>(cash_flow.amount_));
+		}
+
+		storage.offsets_.push_back(storage.days_.size());
+		storage.id_offsets_.push_back(0);
+		storage.start_dates_.push_back(start_date);
+	}
+
+	portfolio.Assign(std::move(storage));
+
+	for (std::size_t a = 0; a < portfolio.size(); a++) {
+		mirr::CashFlowPlan	list_plan(*accounts[a]);
+		mirr::CashFlowPlan	view_plan(portfolio.GetView(a));
+		mirr::Calculator	calculator;
+
+		calculator.print_log_ = false;
+
+		mirr::Rate_t	list_rate = calculator.GetRate(list_plan);
+		mirr::Rate_t	view_rate = calculator.GetRate(view_plan);
+
+		cout << "  account " << a << " grid months " << view_plan.GetGridMonths() << " (" << list_plan.GetGridMonths()
+			<< ") rate " << std::setprecision(15) << view_rate << " (" << list_rate << ")" << endl;
+
+		matched = matched && (view_plan.GetGridMonths() == list_plan.GetGridMonths());
+		matched = matched && (view_plan.GetPeriodicAmounts().size() == list_plan.GetPeriodicAmounts().size());
+		matched = matched && (std::abs(view_rate - list_rate) < 1e-12 * std::max(1.0L, std::abs(list_rate)));
+	}
+
+	cout << "Test PeriodicCashFlows: " << (matched ? "matched" : "MISMATCH") << endl;
+
+	return matched;
+}
+
+//----------------------------------------------------------------------------------
+// Test calculating the NPV at several rates, and at a grid of rates evenly spaced in
+// log(1 + rate), against one rate at a time with each instruction set, for numbers of
+// rates that leave partial blocks.
+bool	TestMultiRateNPV()
+{
+	mirr::CashFlowList		cash_flows;
+	dates::Date_t			start_date = dates::MakeDate("2014-01-01");
+
+	for (int i = 0; i < 37; i++) {
+		cash_flows.push_back(mirr::CashFlow(start_date + i * 11, ((i % 3) == 0) ? -1000.0 - i : 450.0 + i));
+	}
+
+	mirr::CashFlowPlan	plan(cash_flows);
+	mirr::kernels::instruction_set_e	detected = mirr::kernels::DetectInstructionSet();
+	bool				matched = true;
+	std::vector<double>	rates;
+
+	for (int k = 0; k < 41; k++) {
+		rates.push_back((k == 0) ? -1.0 : -0.9 + k * 0.1);
+	}
+
+	for (int set = mirr::kernels::instruction_set_e::scalar; set <= detected; set++) {
+		mirr::kernels::SetInstructionSet(static_cast<mirr::kernels::instruction_set_e>(set));
+
+		for (std::size_t count : { 1, 3, 8, 9, 17, 33, 41 }) {
+			std::vector<double>	npvs(count);
+
+			plan.calculateNPVDouble(rates.data(), count, npvs.data());
+
+			for (std::size_t k = 0; k < count; k++) {
+				mirr::NPV_t	expected = plan.calculateNPV(rates[k]);
+
+				if (std::abs(npvs[k] - expected) > 1e-11 * std::max(static_cast<mirr::NPV_t>(1.0), std::abs(expected))) {
+					cout << "NPV(" << rates[k] << ") " << mirr::kernels::InstructionSetName(static_cast<mirr::kernels::instruction_set_e>(set))
+						<< " of " << count << " rates = " << npvs[k] << " != " << expected << endl;
+					matched = false;
+				}
+			}
+
+			plan.calculateNPVGridDouble(-2.0, 0.09, count, npvs.data());
+
+			for (std::size_t k = 0; k < count; k++) {
+				mirr::NPV_t	expected = plan.calculateNPV(std::expm1(-2.0 + k * 0.09));
+
+				if (std::abs(npvs[k] - expected) > 1e-11 * std::max(static_cast<mirr::NPV_t>(1.0), std::abs(expected))) {
+					cout << "Grid NPV(" << std::expm1(-2.0 + k * 0.09) << ") " << mirr::kernels::InstructionSetName(static_cast<mirr::kernels::instruction_set_e>(set))
+						<< " of " << count << " rates = " << npvs[k] << " != " << expected << endl;
+					matched = false;
+				}
+			}
+		}
 	}
 
-	result = calculator.GetRate(cash_flows);
-	cout << "IRR=" << std::fixed << std::setw(15) << std::setprecision(30) << result << endl;
-	cout << "Expected IRR= -0.25" << endl;
+	mirr::kernels::SetInstructionSet(detected);
+
+	cout << "Test MultiRateNPV: " << (matched ? "matched" : "MISMATCH") << endl;
+
+	return matched;
+}
+
+//----------------------------------------------------------------------------------
+// A series of cash flows with the rate expected for it.
+struct MIRRTestCase {
+	mirr::CashFlowList	cash_flows_;
+	std::string			expected_;
+};
+
+//----------------------------------------------------------------------------------
+// Return the series of cash flows used to test searching for the IRR.
+std::vector<MIRRTestCase>	MakeMIRRTestCases()
+{
+	std::vector<MIRRTestCase>	test_cases(8);
+	mirr::CashFlowList*			cash_flows = nullptr;
+
+	// Set up the list of cash flows.
+
+	//Test Case 0:
+
+	cash_flows = &test_cases[0].cash_flows_;
+	test_cases[0].expected_ = "0.6935541782410140";
+
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2007-05-31"), 9978.82));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2007-06-14"), 15000.0));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2009-10-26"), 20439.95));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2009-11-09"), -5000.0));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2010-02-11"), 3000.0));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-10-24"), 49190.0));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2015-02-13"), -122444.29));
+
+	//Test Case 1: IRR = 0.57068992946099172768520
+
+	cash_flows = &test_cases[1].cash_flows_;
+	test_cases[1].expected_ = "0.57068992946099172768520";
+
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-12-31"), 27));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-01-02"), 1092));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-02-25"), 1354.8));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-03-25"), -429.28));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-04-07"), -85.05));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-05-26"), -1415));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-06-02"), -1188));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-06-16"), -489.5));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-06-25"), -62.25));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-07-28"), 500.39));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-08-25"), 1532.79));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-09-02"), 75.7));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-09-22"), 35.5));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-10-20"), 3035.8));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-10-30"), -4627));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-10-31"), 109.8));
+
+	//Test Case 2: IRR = 54.52564034284328783070
+
+	cash_flows = &test_cases[2].cash_flows_;
+	test_cases[2].expected_ = "54.52564034284328783070";
+
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-02-07"), 323.28));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-02-12"), 6193.87));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-02-13"), 12958.49));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-03-25"), -5880.88));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-04-10"), 7433.3));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-04-25"), -14451.17));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-04-26"), 3541.24));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-05-08"), -6829.46));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-05-29"), 560.8));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-06-07"), 611.1));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-06-21"), -4485.53));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-07-09"), -9991.02));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-07-23"), -7387.22));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-10-22"), 219.55));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-11-13"), 8673.57));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-11-22"), -15306.6));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-12-16"), 8461.69));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-12-17"), 1563.95));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-01-14"), 3556.8));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-01-22"), -32427.98));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-01-28"), 3130.5));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-03-03"), 1200));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-03-24"), -646.53));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-03-26"), 33894));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-04-24"), -8793.99));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-05-01"), -12599.94));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-05-06"), 6193.61));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-05-12"), 5055.24));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-08-28"), 114.69));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-10-02"), -32467.25));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-10-24"), 809.82));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-10-31"), 0));
+
+	//Test Case 3:
+
+	cash_flows = &test_cases[3].cash_flows_;
+	test_cases[3].expected_ = "0.15577775610447013648378";
+
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-02-04"), 444));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-02-10"), 177300.25));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-02-16"), 1593162.55));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-03-10"), 21600));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-03-11"), 14400));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-03-29"), 112595));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-03-31"), 455950));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-04-01"), -51276.3));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-04-15"), 1504.77));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-05-02"), -45514.7));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-05-27"), 30100));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-06-20"), -119818));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-06-30"), 32225));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-07-14"), 20448));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-07-20"), 50178.81));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-08-12"), 54222.2));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-09-14"), 70860.76));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-09-21"), 100366.7));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-09-23"), -104663.2));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-09-27"), 38143));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-09-30"), -33170));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-10-07"), 19430));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-10-18"), 50958.68));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-10-26"), -65940));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-11-04"), 61703.4));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-11-09"), 31480));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-11-17"), 32515.4));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-11-22"), 511.2));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2011-12-31"), 0));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-01-30"), 15092.98));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-02-02"), 265586.2));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-02-08"), -218030));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-02-09"), 156750));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-02-27"), 32210.4));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-03-07"), 82921.13));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-03-12"), 224200));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-03-15"), -225232));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-03-30"), 0));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-04-19"), -35420.43));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-04-30"), 115850));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-05-03"), -120275.2));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-05-11"), 34009.6));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-05-22"), -44722.22));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-05-30"), -71468));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-06-07"), 106334.51));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-06-12"), -110030));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-06-29"), 0));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-07-24"), -5769.55));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-07-31"), -87962.5));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-08-20"), 93008.78));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-08-28"), 32681.1));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-09-10"), -95229.5));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-09-28"), 47350));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-10-02"), -50723.82));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2012-10-05"), -3072999.35));
+
+	//Test Case 4:
+
+	cash_flows = &test_cases[4].cash_flows_;
+	test_cases[4].expected_ = "17.823529759677437485977";
+
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-01-24"), 320.8));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-01-29"), 352.6));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-02-01"), -92.15));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-02-28"), 740));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-03-26"), 655));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-04-25"), 2707.75));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-05-13"), -1159.59));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-05-27"), -3921.1));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-06-27"), 2290.05));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-07-16"), -279.81));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-07-29"), -1117.92));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-08-15"), -457.25));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-08-28"), -1809));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-09-25"), -934));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-10-30"), 590));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-11-28"), -842));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-01-02"), 1092));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-02-25"), 1354.8));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-03-25"), -429.28));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-04-07"), -85.05));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-05-26"), -1415));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-06-02"), -1188));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-06-16"), -489.5));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-06-25"), -62.25));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-07-28"), 500.39));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-08-25"), 1532.79));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-09-02"), 75.7));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-09-22"), 35.5));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-10-20"), 3035.8));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-10-30"), -4627));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-10-31"), 109.8));
+
+	//Test Case 5:
+
+	cash_flows = &test_cases[5].cash_flows_;
+	test_cases[5].expected_ = "0.5391053430857646636078";
+
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2007-05-31"), 9978.82));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2007-06-14"), 15000));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2009-10-26"), 20439.95));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2009-11-09"), -5000));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2010-02-11"), 3000));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-10-24"), 49190));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-02-28"), -112961.67));
+
+	//Test Case 6:
+
+	cash_flows = &test_cases[6].cash_flows_;
+	test_cases[6].expected_ = "-0.25";
+
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2015-01-01"), 100));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2016-01-01"), -75));
 
 	//Test Case 7 (RBCNullCase):
 
-	calculator.calc_log.clear();
-	cash_flows.clear();
+	cash_flows = &test_cases[7].cash_flows_;
+	test_cases[7].expected_ = "0.53910534308576466360784";
 
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2007-05-31"), 9978.82));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2007-06-14"), 15000));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2009-10-26"), 20439.95));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2009-11-09"), -5000));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2010-02-11"), 3000));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-10-24"), 49190));
-	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2014-02-28"), -112961.67));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2007-05-31"), 9978.82));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2007-06-14"), 15000));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2009-10-26"), 20439.95));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2009-11-09"), -5000));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2010-02-11"), 3000));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2013-10-24"), 49190));
+	cash_flows->push_back(mirr::CashFlow(dates::MakeDate("2014-02-28"), -112961.67));
 
-	for (mirr::CashFlow& cash_flow : cash_flows) {
-		cout << cash_flow.ToString() << endl;
+	return test_cases;
+}
+
+//----------------------------------------------------------------------------------
+// Test searching for the IRR that will make the NPV of the series of cash flows = 0.
+bool	TestMIRR()
+{
+	mirr::Calculator	calculator;
+	mirr::Rate_t		result;
+
+	cout << "Test TestMIRR:" << endl;
+
+	for (MIRRTestCase& test_case : MakeMIRRTestCases()) {
+		calculator.calc_log.clear();
+
+		for (mirr::CashFlow& cash_flow : test_case.cash_flows_) {
+			cout << cash_flow.ToString() << endl;
+		}
+
+		// Solve for the modified internal rate of return that makes those cash flows have an NPV = 0.
+
+		result = calculator.GetRate(test_case.cash_flows_);
+
+		cout << "IRR=" << std::fixed << std::setw(15) << std::setprecision(30) << result << endl;
+		cout << "Expected IRR= " << test_case.expected_ << endl;
+		cout << endl;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------
+// Test the NPV and the rate calculated with each numeric policy against long double.
+// The rates must agree to within the tolerance of the search in double precision and
+// to the resolution of the type in float.
+template <class PRECISION_T>
+bool	TestPrecisionPolicy(mirr::CashFlowList& io_cash_flows, mirr::Rate_t in_expected_rate, double in_tolerance)
+{
+	mirr::BasicCalculator<PRECISION_T>	calculator;
+	mirr::Rate_t						npv_rate = 0.0735;
+
+	calculator.print_log_ = false;
+
+	mirr::NPV_t	expected_npv = io_cash_flows.calculateNPV(npv_rate);
+	mirr::NPV_t	npv = io_cash_flows.calculateNPV<PRECISION_T>(static_cast<typename PRECISION_T::value_t>(npv_rate));
+	mirr::Rate_t	rate = calculator.GetRate(io_cash_flows);
+
+	if ((std::abs(npv - expected_npv) > in_tolerance * std::abs(expected_npv)) ||
+		(std::abs(rate - in_expected_rate) > in_tolerance * std::max(static_cast<mirr::Rate_t>(1.0), std::abs(in_expected_rate)))) {
+		cout << "  " << PRECISION_T::Name() << ": NPV " << npv << " (" << expected_npv << ") rate " << rate
+			<< " (" << in_expected_rate << ")" << endl;
+		return false;
 	}
 
-	result = calculator.GetRate(cash_flows);
-	cout << "IRR=" << std::fixed << std::setw(15) << std::setprecision(30) << result << endl;
-	cout << "Expected IRR= 0.53910534308576466360784" << endl;
-	
 	return true;
 }
 
+bool	TestPrecision()
+{
+	bool	matched = true;
+
+	for (MIRRTestCase& test_case : MakeMIRRTestCases()) {
+		mirr::Calculator	calculator;
+
+		calculator.print_log_ = false;
+
+		mirr::Rate_t	expected_rate = calculator.GetRate(test_case.cash_flows_);
+
+		matched &= TestPrecisionPolicy<mirr::LongDoublePrecision>(test_case.cash_flows_, expected_rate, 0.0);
+		matched &= TestPrecisionPolicy<mirr::DoublePrecision>(test_case.cash_flows_, expected_rate, 1e-9);
+		matched &= TestPrecisionPolicy<mirr::CompensatedDoublePrecision>(test_case.cash_flows_, expected_rate, 1e-9);
+		matched &= TestPrecisionPolicy<mirr::FloatPrecision>(test_case.cash_flows_, expected_rate, 1e-4);
+	}
+
+	cout << "Test Precision: " << (matched ? "matched" : "MISMATCH") << endl;
+
+	return matched;
+}
+
+//----------------------------------------------------------------------------------
+// Test that a mixed precision search (double search, long double polish) finds the
+// same rates as the long double search and reports a residual no larger than the NPV
+// at the long double rate.
+bool	TestMixedPrecision()
+{
+	bool	matched = true;
+
+	for (MIRRTestCase& test_case : MakeMIRRTestCases()) {
+		mirr::Calculator	full;
+		mirr::Calculator	mixed;
+		mirr::CashFlowPlan	plan(test_case.cash_flows_);
+
+		full.print_log_ = false;
+		mixed.print_log_ = false;
+		mixed.options_.precision_ = mirr::solve_precision_e::mixed_precision;
+
+		mirr::Rate_t	full_rate = full.GetRate(plan);
+		mirr::Rate_t	mixed_rate = mixed.GetRate(plan);
+		mirr::NPV_t		full_residual = std::abs(plan.calculateNPV(full_rate));
+
+		cout << "  rate " << std::setprecision(15) << mixed_rate << " (" << full_rate << ")  residual "
+			<< std::scientific << std::setprecision(2) << mixed.GetResidual() << " (" << full_residual << ")  "
+			<< mixed.GetEvaluations() << " evaluations" << std::fixed << endl;
+
+		if ((mixed.GetStatus() != full.GetStatus()) || std::isnan(mixed.GetResidual()) != (full.GetStatus() != mirr::solve_status_e::solved) ||
+			(std::abs(mixed_rate - full_rate) > 1e-9 * std::max(static_cast<mirr::Rate_t>(1.0), std::abs(full_rate))) ||
+			(std::abs(mixed.GetResidual()) > std::max(full_residual, static_cast<mirr::NPV_t>(1e-9)))) {
+			matched = false;
+		}
+	}
+
+	// Cash flows all on one day have no rate and must be reported as not bracketed
+	// rather than let the search throw.  Amounts near the largest double overflow the
+	// double NPV, so the search must not report a rate that is not finite as solved.
+
+	mirr::CashFlowList	same_day;
+	mirr::CashFlowList	overflow;
+
+	same_day.push_back(mirr::CashFlow(dates::MakeDate("2015-01-01"), -100));
+	same_day.push_back(mirr::CashFlow(dates::MakeDate("2015-01-01"), 150));
+
+	overflow.push_back(mirr::CashFlow(dates::MakeDate("2010-01-01"), 1.7e308));
+	overflow.push_back(mirr::CashFlow(dates::MakeDate("2010-01-02"), -1.7e308));
+	overflow.push_back(mirr::CashFlow(dates::MakeDate("2010-01-03"), -1.7e308));
+
+	for (const mirr::CashFlowList* cash_flows : { &same_day, &overflow }) {
+		mirr::Calculator	mixed;
+		mirr::CashFlowPlan	plan(*cash_flows);
+
+		mixed.print_log_ = false;
+		mixed.options_.precision_ = mirr::solve_precision_e::mixed_precision;
+
+		try {
+			mirr::Rate_t	rate = mixed.GetRate(plan);
+
+			cout << "  rate " << std::setprecision(15) << rate << " status " << mixed.GetStatus() << endl;
+
+			if ((cash_flows == &same_day) ? (mixed.GetStatus() != mirr::solve_status_e::not_bracketed) :
+					((mixed.GetStatus() == mirr::solve_status_e::solved) && !std::isfinite(rate))) {
+				matched = false;
+			}
+		}
+		catch (std::exception& in_exception) {
+			cout << "  threw " << in_exception.what() << endl;
+			matched = false;
+		}
+	}
+
+	cout << "Test MixedPrecision: " << (matched ? "matched" : "MISMATCH") << endl;
+
+	return matched;
+}
+
+//----------------------------------------------------------------------------------
+// Test that widening the bracket of cash flows whose NPV is negative at both ends of the
+// fixed range never reaches a rate of -100%, where the NPV is taken to be zero.  Each
+// method and precision must either find one of the two rates (21% and 44%) or report
+// that the rate was not bracketed.
+bool	TestBracketLowestRate()
+{
+	mirr::CashFlowList	cash_flows;
+	bool				matched = true;
+
+	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2010-01-01"), -1000));
+	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-01-01"), 2300));
+	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-01-01"), -1320));
+
+	mirr::CashFlowPlan	plan(cash_flows);
+
+	const mirr::solver_method_e		methods[] = { mirr::solver_method_e::brent, mirr::solver_method_e::newton, mirr::solver_method_e::halley };
+	const mirr::solve_precision_e	precisions[] = { mirr::solve_precision_e::full_precision, mirr::solve_precision_e::mixed_precision };
+
+	for (mirr::solver_method_e method : methods) {
+		for (mirr::solve_precision_e precision : precisions) {
+			mirr::Calculator	calculator;
+
+			calculator.print_log_ = false;
+			calculator.options_.method_ = method;
+			calculator.options_.precision_ = precision;
+
+			mirr::Rate_t	rate = calculator.GetRate(plan);
+			bool			found = (calculator.GetStatus() == mirr::solve_status_e::solved) &&
+									((std::abs(rate - 0.21) < 1e-9) || (std::abs(rate - 0.44) < 1e-9));
+
+			if (!found && (calculator.GetStatus() != mirr::solve_status_e::not_bracketed)) {
+				cout << "  method " << method << " precision " << precision << ": rate " << rate
+					<< " status " << calculator.GetStatus() << endl;
+				matched = false;
+			}
+		}
+	}
+
+	cout << "Test BracketLowestRate: " << (matched ? "matched" : "MISMATCH") << endl;
+
+	return matched;
+}
+
+//----------------------------------------------------------------------------------
+// Test searching for the rates of many series of cash flows at once and compare them
+// to searching for each one separately.
+bool	TestBatchCalculator()
+{
+	std::vector<mirr::CashFlowList>	portfolio(1000);
+	mirr::Calculator				calculator;
+	bool							matched = true;
+
+	// Set up variations of the same account so each has a different rate.
+
+	for (size_t i = 0; i < portfolio.size(); i++) {
+		mirr::CashFlowList&	cash_flows = portfolio[i];
+
+		cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2007-05-31"), 9978.82));
+		cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2007-06-14"), 15000.0));
+		cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2009-10-26"), 20439.95));
+		cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2009-11-09"), -5000.0));
+		cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2010-02-11"), 3000.0));
+		cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2013-10-24"), 49190.0));
+		cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2015-02-13"), -122444.29 - (10.0 * i)));
+	}
+
+	auto	start = std::chrono::steady_clock::now();
+
+	mirr::BatchCalculator				batch_calculator;
+	std::vector<mirr::BatchResult>		results = batch_calculator.GetRates(portfolio);
+
+	auto	finish = std::chrono::steady_clock::now();
+
+	calculator.print_log_ = false;
+
+	for (size_t i = 0; i < portfolio.size(); i++) {
+		calculator.calc_log.clear();
+		mirr::Rate_t	expected = calculator.GetRate(portfolio[i]);
+
+		if ((results[i].status_ != mirr::solve_status_e::solved) || (results[i].rate_ != expected)) {
+			cout << "Batch mismatch [" << i << "] " << results[i].rate_ << " != " << expected << endl;
+			matched = false;
+		}
+	}
+
+	// A chunk size of 0 is solved as 1 but the setting is left as it was.
+
+	batch_calculator.chunk_size_ = 0;
+	results = batch_calculator.GetRates(portfolio.data(), 10);
+	matched = matched && (batch_calculator.chunk_size_ == 0) && (results.size() == 10) && (results[9].rate_ == calculator.GetRate(portfolio[9]));
+
+	// With a trace capacity the trace of each search that is not solved is written to the
+	// log sink.  The fixed range does not bracket cash flows whose two rates are 21% and 44%.
+
+	std::vector<mirr::CashFlowList>	traced(2, portfolio[0]);
+	std::ostringstream				log_text;
+	logging::StreamSink				log_sink(log_text);
+
+	traced[1].clear();
+	traced[1].push_back(mirr::CashFlow(dates::MakeDate("2010-01-01"), -1000));
+	traced[1].push_back(mirr::CashFlow(dates::MakeDate("2011-01-01"), 2300));
+	traced[1].push_back(mirr::CashFlow(dates::MakeDate("2012-01-01"), -1320));
+
+	batch_calculator.log_sink_ = &log_sink;
+	batch_calculator.trace_capacity_ = 16;
+	results = batch_calculator.GetRates(traced);
+
+	if ((results[1].status_ != mirr::solve_status_e::not_bracketed) || (log_text.str().find("Series 1 not_bracketed") == std::string::npos) ||
+		(log_text.str().find("Series 0 ") != std::string::npos)) {
+		cout << "Batch traces: " << log_text.str() << endl;
+		matched = false;
+	}
+
+	cout << "Test BatchCalculator: " << portfolio.size() << " lists on " << batch_calculator.GetThreadCount()
+		<< " threads in " << std::chrono::duration_cast<std::chrono::microseconds>(finish - start).count()
+		<< " us " << (matched ? "(matched)" : "(MISMATCH)") << endl;
+
+	return matched;
+}
+
+//----------------------------------------------------------------------------------
+// Test appending cash flows to an account one day at a time and searching again from
+// the previous rate.  Compare each rate with a search from scratch and the NPV
+// evaluations each needed.
+bool	TestIncrementalCalculator()
+{
+	mirr::IncrementalCalculator	incremental;
+	mirr::CashFlowList			cash_flows;
+	mirr::Calculator			calculator;
+	bool						matched = true;
+	long						warm_evaluations = 0;
+	long						cold_evaluations = 0;
+	int							appends = 0;
+
+	dates::Date_t	start_date = dates::MakeDate("2015-02-13");
+
+	calculator.print_log_ = false;
+
+	// Start from the history of the first test case and then add a cash flow each day.
+
+	std::vector<MIRRTestCase>	test_cases = MakeMIRRTestCases();
+
+	for (mirr::CashFlow& cash_flow : test_cases.front().cash_flows_) {
+		incremental.push_back(cash_flow);
+		cash_flows.push_back(cash_flow);
+	}
+
+	for (int day = 1; day <= 365; day++) {
+		dates::Date_t	cash_flow_date = start_date + day;
+		mirr::CashFlowAmt_t	amount = ((day % 7) == 0) ? -(500.0 + day) : (100.0 + (day % 5) * 10.0);
+
+		incremental.push_back(mirr::CashFlow(cash_flow_date, amount));
+		cash_flows.push_back(mirr::CashFlow(cash_flow_date, amount));
+
+		bool			warm = incremental.HasRate();
+		mirr::Rate_t	rate = incremental.GetRate();
+
+		calculator.calc_log.clear();
+		mirr::Rate_t	expected = calculator.GetRate(cash_flows);
+
+		if (incremental.GetCalculator().GetStatus() != calculator.GetStatus()) {
+			cout << "Incremental status mismatch on day " << day << endl;
+			matched = false;
+		}
+		else if ((calculator.GetStatus() == mirr::solve_status_e::solved) && (std::abs(rate - expected) > 1e-9)) {
+			cout << "Incremental mismatch on day " << day << " " << rate << " != " << expected << endl;
+			matched = false;
+		}
+
+		if (warm) {
+			warm_evaluations += incremental.GetCalculator().GetEvaluations();
+			cold_evaluations += calculator.GetEvaluations();
+			appends++;
+		}
+	}
+
+	cout << "Test IncrementalCalculator: " << appends << " appends, evaluations per search "
+		<< std::fixed << std::setprecision(2) << (static_cast<double>(warm_evaluations) / appends)
+		<< " warm vs " << (static_cast<double>(cold_evaluations) / appends) << " from scratch "
+		<< (matched ? "(matched)" : "(MISMATCH)") << endl;
+
+	return matched;
+}
+
+//----------------------------------------------------------------------------------
+// Test that the trace keeps the latest records once it is full and that a search
+// records its steps ending at the rate.
+bool	TestSolverTrace()
+{
+	roots::SolverTrace	trace(4);
+	mirr::Calculator	calculator;
+	bool				matched = true;
+
+	for (long i = 0; i < 6; i++) {
+		trace.Record(i, 0, i * 1.0, 0.0, 0.0, 0.0);
+	}
+
+	if ((trace.size() != 4) || (trace.GetDropped() != 2) || (trace.at(0).iteration_ != 2) || (trace.at(3).iteration_ != 5)) {
+		cout << "Trace ring mismatch: " << trace.size() << " records, " << trace.GetDropped() << " dropped" << endl;
+		matched = false;
+	}
+
+	std::vector<MIRRTestCase>	test_cases = MakeMIRRTestCases();
+
+	calculator.print_log_ = false;
+	calculator.trace_.Reserve(64);
+	calculator.GetRate(test_cases.front().cash_flows_);
+
+	if ((calculator.trace_.size() == 0) ||
+		(std::abs(calculator.trace_.at(calculator.trace_.size() - 1).result_) > 1e-6)) {
+		matched = false;
+	}
+
+	cout << calculator.trace_;
+	cout << "Test SolverTrace: " << calculator.trace_.size() << " records " << (matched ? "(matched)" : "(MISMATCH)") << endl;
+
+	return matched;
+}
+
+//----------------------------------------------------------------------------------
+// Test writing the logs of a batch of searches from several threads through the
+// asynchronous sink to a file and check that every line is written or counted as
+// dropped.
+bool	TestAsyncLogSink()
+{
+	static const char*	kPath = "mirr_async_log_test.txt";
+
+	std::vector<mirr::CashFlowList>	portfolio(1000, MakeMIRRTestCases().front().cash_flows_);
+	std::size_t						written = 0;
+	std::size_t						dropped = 0;
+
+	std::remove(kPath);
+
+	{
+		logging::AsyncFdSink	sink(std::string(kPath), 256);
+		mirr::BatchCalculator	batch_calculator(4);
+
+		batch_calculator.log_sink_ = &sink;
+		batch_calculator.GetRates(portfolio);
+
+		sink.Flush();
+		written = sink.GetWritten();
+		dropped = sink.GetDropped();
+	}
+
+	std::ifstream	log_file(kPath);
+	std::string		line;
+	std::size_t		lines = 0;
+
+	while (std::getline(log_file, line)) {
+		if (line.compare(0, 5, "IRR =") == 0) {
+			lines++;
+		}
+	}
+
+	log_file.close();
+	std::remove(kPath);
+
+	bool	matched = ((written + dropped) == portfolio.size()) && (lines == written);
+
+	cout << "Test AsyncLogSink: " << written << " written, " << dropped << " dropped, "
+		<< lines << " lines " << (matched ? "(matched)" : "(MISMATCH)") << endl;
+
+	return matched;
+}
+
+//----------------------------------------------------------------------------------
+// Test converting between civil dates and days since 1970-01-01 over several 400 year
+// eras and adding months at the ends of months.
+bool	TestDates()
+{
+	bool	matched = true;
+
+	dates::CivilDate	previous = dates::CivilFromDays(-400000 - 1);
+
+	for (dates::Date_t day = -400000; day <= 400000; day++) {
+		dates::CivilDate	date = dates::CivilFromDays(day);
+
+		// Each day is either the next day of the month or the first of the next month.
+
+		bool	next_day = (date.year_ == previous.year_) && (date.month_ == previous.month_) && (date.day_ == previous.day_ + 1);
+		bool	next_month = (date.day_ == 1) && (static_cast<int>(previous.day_) == dates::GetDaysInMonth(previous.year_, previous.month_ - 1)) &&
+							(((date.year_ == previous.year_) && (date.month_ == previous.month_ + 1)) ||
+							 ((date.year_ == previous.year_ + 1) && (date.month_ == 1) && (previous.month_ == 12)));
+
+		if ((!next_day && !next_month) || (dates::DaysFromCivil(date.year_, date.month_, date.day_) != day)) {
+			cout << "Date mismatch on day " << day << " " << dates::Date2String(day) << endl;
+			matched = false;
+			break;
+		}
+
+		previous = date;
+	}
+
+	struct AddMonthsCase {
+		const char*	date_;
+		int			months_;
+		const char*	expected_;
+	};
+
+	AddMonthsCase	add_months_cases[] = {
+		{ "2016-01-31", 1, "2016-02-29" },
+		{ "2016-02-29", 12, "2017-02-28" },
+		{ "2016-03-31", -1, "2016-02-29" },
+		{ "2015-01-30", 1, "2015-02-28" },
+		{ "2015-02-28", 1, "2015-03-31" },
+		{ "2015-11-15", 3, "2016-02-15" },
+		{ "2015-01-15", -13, "2013-12-15" }
+	};
+
+	for (AddMonthsCase& add_months_case : add_months_cases) {
+		std::string	result = dates::Date2String(dates::AddMonths(dates::MakeDate(add_months_case.date_), add_months_case.months_));
+
+		if (result != add_months_case.expected_) {
+			cout << "AddMonths(" << add_months_case.date_ << ", " << add_months_case.months_ << ") = " << result
+				<< " expected " << add_months_case.expected_ << endl;
+			matched = false;
+		}
+	}
+
+	cout << "Test Dates: " << (matched ? "(matched)" : "(MISMATCH)") << endl;
+
+	return matched;
+}
+
+//----------------------------------------------------------------------------------
+// Test parsing dates and the errors reported for badly formed ones.
+bool	TestParseDate()
+{
+	struct ParseDateCase {
+		const char*				text_;
+		dates::parse_status_e	expected_;
+	};
+
+	ParseDateCase	parse_date_cases[] = {
+		{ "2015-02-13", dates::parse_status_e::parsed },
+		{ "2016-02-29", dates::parse_status_e::parsed },
+		{ "1969-12-31", dates::parse_status_e::parsed },
+		{ "2015-2-13", dates::parse_status_e::bad_length },
+		{ "2015-02-13 ", dates::parse_status_e::bad_length },
+		{ "2015/02/13", dates::parse_status_e::bad_character },
+		{ "2015-0a-13", dates::parse_status_e::bad_character },
+		{ "2015-13-01", dates::parse_status_e::bad_month },
+		{ "2015-00-01", dates::parse_status_e::bad_month },
+		{ "2015-02-29", dates::parse_status_e::bad_day },
+		{ "2015-04-31", dates::parse_status_e::bad_day },
+		{ "2015-04-00", dates::parse_status_e::bad_day }
+	};
+
+	bool	matched = true;
+
+	for (ParseDateCase& parse_date_case : parse_date_cases) {
+		dates::Date_t			date = 0;
+		dates::parse_status_e	status = dates::ParseDate(parse_date_case.text_, date);
+
+		if ((status != parse_date_case.expected_) ||
+			((status == dates::parse_status_e::parsed) && (date != dates::MakeDate(parse_date_case.text_)))) {
+			cout << "ParseDate(" << parse_date_case.text_ << ") " << dates::ParseStatusName(status) << endl;
+			matched = false;
+		}
+	}
+
+	cout << "Test ParseDate: " << (matched ? "(matched)" : "(MISMATCH)") << endl;
+
+	return matched;
+}
+
+//----------------------------------------------------------------------------------
+// Test building a list from cash flows in any order with some on the same day and
+// compare its rate with the list built in order.  Also check that a cash flow added
+// before the start becomes the start.
+bool	TestCashFlowListAssign()
+{
+	std::vector<MIRRTestCase>	test_cases = MakeMIRRTestCases();
+	mirr::Calculator			calculator;
+	bool						matched = true;
+
+	calculator.print_log_ = false;
+
+	for (MIRRTestCase& test_case : test_cases) {
+		std::vector<mirr::CashFlow>	unsorted;
+
+		// Split each cash flow into two on the same day and reverse the order.
+
+		for (mirr::CashFlow& cash_flow : test_case.cash_flows_) {
+			unsorted.push_back(mirr::CashFlow(cash_flow.date_, cash_flow.amount_ * 0.25));
+			unsorted.push_back(mirr::CashFlow(cash_flow.date_, cash_flow.amount_ * 0.75));
+		}
+
+		std::reverse(unsorted.begin(), unsorted.end());
+
+		mirr::CashFlowList	cash_flows;
+
+		cash_flows.Assign(unsorted);
+
+		calculator.calc_log.clear();
+		mirr::Rate_t	expected = calculator.GetRate(test_case.cash_flows_);
+		calculator.calc_log.clear();
+		mirr::Rate_t	rate = calculator.GetRate(cash_flows);
+
+		if (!cash_flows.IsSorted() || (cash_flows.front().days_from_start_ != 0) ||
+			(cash_flows.GetDaysInRange() != test_case.cash_flows_.GetDaysInRange()) ||
+			(std::abs(rate - expected) > 1e-12 * std::max(static_cast<mirr::Rate_t>(1.0), std::abs(expected)))) {
+			cout << "Assign mismatch " << rate << " != " << expected << endl;
+			matched = false;
+		}
+	}
+
+	mirr::CashFlowList	cash_flows;
+
+	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2015-02-13"), -100.0));
+	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2015-01-13"), 100.0));
+
+	if ((cash_flows[0].days_from_start_ != 31) || (cash_flows[1].days_from_start_ != 0) || cash_flows.IsSorted()) {
+		cout << "push_back of an earlier cash flow: days " << cash_flows[0].days_from_start_ << ", "
+			<< cash_flows[1].days_from_start_ << endl;
+		matched = false;
+	}
+
+	cout << "Test CashFlowList Assign: " << (matched ? "(matched)" : "(MISMATCH)") << endl;
+
+	return matched;
+}
+
+//----------------------------------------------------------------------------------
+// Write the test cases as the cash flows of many accounts with their rows mixed
+// together, as account_id,date,amount lines.
+std::string	MakeCashFlowsCsv(std::size_t in_account_count, std::size_t in_bad_row_every = 0)
+{
+	std::vector<MIRRTestCase>	test_cases = MakeMIRRTestCases();
+	std::stringstream			text;
+	std::size_t					rows = 0;
+
+	text << "account_id,date,amount\r\n";
+	text << std::setprecision(17);
+
+	for (std::size_t j = 0; ; j++) {
+		bool	written = false;
+
+		for (std::size_t a = 0; a < in_account_count; a++) {
+			mirr::CashFlowList&	cash_flows = test_cases[a % test_cases.size()].cash_flows_;
+
+			if (j < cash_flows.size()) {
+				text << "A" << a << "," << dates::Date2String(cash_flows[j].date_) << ","
+					<< static_cast<double>(cash_flows[j].amount_) << "\r\n";
+				written = true;
+				rows++;
+
+				if ((in_bad_row_every > 0) && ((rows % in_bad_row_every) == 0)) {
+					text << "A" << a << ",2015-02-30,1.0\r\n";
+				}
+			}
+		}
+
+		if (!written) {
+			break;
+		}
+	}
+
+	return text.str();
+}
+
+//----------------------------------------------------------------------------------
+// Test reading the cash flows of many accounts from CSV text with several threads and
+// compare each account's rate with the rate of the test case it was written from.
+bool	TestCsvReader()
+{
+	static const std::size_t	kAccounts = 20000;
+
+	std::vector<MIRRTestCase>	test_cases = MakeMIRRTestCases();
+	std::string					text = MakeCashFlowsCsv(kAccounts, 1000);
+	mirr::Portfolio				portfolio;
+	mirr::CsvReadStats			stats;
+	mirr::Calculator			calculator;
+	bool						matched = true;
+	std::vector<mirr::Rate_t>	expected;
+
+	calculator.print_log_ = false;
+
+	for (MIRRTestCase& test_case : test_cases) {
+		calculator.calc_log.clear();
+		expected.push_back(calculator.GetRate(test_case.cash_flows_));
+	}
+
+	mirr::ParseCashFlowsCsv(text.data(), text.size(), 4, portfolio, stats);
+
+	if (portfolio.size() != kAccounts) {
+		matched = false;
+	}
+
+	for (std::size_t a = 0; (a < portfolio.size()) && matched; a++) {
+		std::size_t		test_case = std::stoul(portfolio.GetAccountId(a).substr(1)) % test_cases.size();
+		mirr::Rate_t	rate;
+
+		calculator.calc_log.clear();
+		rate = calculator.GetRate(portfolio.GetView(a));
+
+		if ((portfolio.GetStartDate(a) != test_cases[test_case].cash_flows_.front().date_) ||
+			(std::abs(rate - expected[test_case]) > 1e-9 * std::max(static_cast<mirr::Rate_t>(1.0), std::abs(expected[test_case])))) {
+			cout << "CSV account " << portfolio.GetAccountId(a) << " rate " << rate << " != " << expected[test_case] << endl;
+			matched = false;
+		}
+	}
+
+	// Moving the portfolio takes its columns and leaves the one moved from empty.
+
+	mirr::Portfolio	moved(std::move(portfolio));
+	std::size_t		emptied_size = portfolio.size();
+
+	portfolio = std::move(moved);
+	emptied_size += moved.size();
+
+	if ((portfolio.size() != kAccounts) || (emptied_size != 0)) {
+		cout << "Moved portfolio has " << portfolio.size() << " accounts, " << emptied_size << " left behind" << endl;
+		matched = false;
+	}
+
+	std::string	first_bad_row = "A999,2015-02-30";
+
+	if ((stats.bad_rows_ != stats.rows_ / 1000) || (text.compare(stats.first_bad_offset_, first_bad_row.size(), first_bad_row) != 0)) {
+		cout << "CSV bad rows " << stats.bad_rows_ << " first at " << stats.first_bad_offset_ << endl;
+		matched = false;
+	}
+
+	cout << "Test CsvReader: " << portfolio.size() << " accounts, " << stats.rows_ << " rows, " << stats.bad_rows_
+		<< " bad rows on " << stats.threads_ << " threads " << (matched ? "(matched)" : "(MISMATCH)") << endl;
+
+	return matched;
+}
+
+//----------------------------------------------------------------------------------
+// Write a portfolio read from CSV to a binary file, map it back and check every view
+// and rate matches.  Then damage the file and check it is rejected.
+bool	TestCashFlowFile()
+{
+	static const char*			kPath = "mirr_test_cash_flows.bin";
+	static const std::size_t	kAccounts = 1000;
+
+	std::string			text = MakeCashFlowsCsv(kAccounts);
+	mirr::Portfolio		written;
+	mirr::Portfolio		read;
+	mirr::CsvReadStats	stats;
+	mirr::Calculator	calculator;
+	bool				matched = true;
+
+	calculator.print_log_ = false;
+
+	mirr::ParseCashFlowsCsv(text.data(), text.size(), 1, written, stats);
+
+	mirr::file_status_e	write_status = mirr::WriteCashFlowsBinary(kPath, written);
+	mirr::file_status_e	read_status = mirr::ReadCashFlowsBinary(kPath, read, true);
+
+	if ((write_status != mirr::file_status_e::file_ok) || (read_status != mirr::file_status_e::file_ok) ||
+		(read.size() != written.size()) || (read.GetCashFlowCount() != written.GetCashFlowCount())) {
+		cout << "Binary file " << mirr::FileStatusName(write_status) << ", " << mirr::FileStatusName(read_status) << endl;
+		matched = false;
+	}
+
+	for (std::size_t a = 0; (a < read.size()) && matched; a++) {
+		mirr::CashFlowView	lhs = written.GetView(a);
+		mirr::CashFlowView	rhs = read.GetView(a);
+
+		if ((read.GetAccountId(a) != written.GetAccountId(a)) || (read.GetStartDate(a) != written.GetStartDate(a)) ||
+			(lhs.size() != rhs.size()) || !std::equal(lhs.days_, lhs.days_ + lhs.size(), rhs.days_) ||
+			!std::equal(lhs.amounts_double_, lhs.amounts_double_ + lhs.size(), rhs.amounts_double_)) {
+			cout << "Binary account " << read.GetAccountId(a) << " does not match" << endl;
+			matched = false;
+			break;
+		}
+
+		calculator.calc_log.clear();
+		mirr::Rate_t	expected = calculator.GetRate(lhs);
+		calculator.calc_log.clear();
+		mirr::Rate_t	rate = calculator.GetRate(rhs);
+
+		if (!((rate == expected) || (std::isnan(rate) && std::isnan(expected)))) {
+			cout << "Binary account " << read.GetAccountId(a) << " rate " << rate << " != " << expected << endl;
+			matched = false;
+		}
+	}
+
+	read.clear();
+
+	// Change one amount; the header still passes but the amounts' checksum does not.
+
+	std::size_t	damaged_bytes = 0;
+
+	{
+		std::fstream	file(kPath, std::ios::in | std::ios::out | std::ios::binary);
+		mirr::CashFlowFileHeader	header;
+
+		file.read(reinterpret_cast<char*>(&header), sizeof(header));
+		file.seekp(header.positions_[mirr::CashFlowFileHeader::amounts]);
+		file.write("\x7f", 1);
+		damaged_bytes = file ? 1 : 0;
+	}
+
+	mirr::file_status_e	unverified_status = mirr::ReadCashFlowsBinary(kPath, read, false);
+	read.clear();
+	mirr::file_status_e	damaged_status = mirr::ReadCashFlowsBinary(kPath, read, true);
+	read.clear();
+
+	if ((damaged_bytes != 1) || (unverified_status != mirr::file_status_e::file_ok) ||
+		(damaged_status != mirr::file_status_e::file_bad_checksum)) {
+		cout << "Binary damaged file " << mirr::FileStatusName(unverified_status) << ", " << mirr::FileStatusName(damaged_status) << endl;
+		matched = false;
+	}
+
+	// A header whose account count makes the sizes of the offsets and start dates wrap
+	// around (to 8 and 0 bytes) is rejected even though its checksum is right.
+
+	{
+		std::fstream	file(kPath, std::ios::in | std::ios::out | std::ios::binary);
+		mirr::CashFlowFileHeader	header;
+
+		file.read(reinterpret_cast<char*>(&header), sizeof(header));
+		header.account_count_ = static_cast<std::uint64_t>(1) << 62;
+		header.header_checksum_ = mirr::CalculateChecksum(&header, offsetof(mirr::CashFlowFileHeader, header_checksum_));
+		file.seekp(0);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	}
+
+	mirr::file_status_e	wrapped_status = mirr::ReadCashFlowsBinary(kPath, read, false);
+	read.clear();
+
+	if (wrapped_status != mirr::file_status_e::file_bad_layout) {
+		cout << "Binary wrapped account count " << mirr::FileStatusName(wrapped_status) << endl;
+		matched = false;
+	}
+
+	// A file too short for its sections is rejected before anything is read.
+
+	{
+		std::ofstream	file(kPath, std::ios::binary | std::ios::trunc);
+		file.write(text.data(), 256);
+	}
+
+	mirr::file_status_e	text_status = mirr::ReadCashFlowsBinary(kPath, read, false);
+
+	if (text_status != mirr::file_status_e::file_bad_header) {
+		cout << "Binary text file " << mirr::FileStatusName(text_status) << endl;
+		matched = false;
+	}
+
+	std::remove(kPath);
+
+	cout << "Test CashFlowFile: " << written.size() << " accounts, " << written.GetCashFlowCount() << " cash flows "
+		<< (matched ? "(matched)" : "(MISMATCH)") << endl;
+
+	return matched;
+}
+
+//----------------------------------------------------------------------------------
+// Run the command line on a CSV file, writing the results as CSV and as binary, and
+// check both match searching for each account's rate directly.  Also check options
+// that are not valid are rejected.
+bool	TestCommandLine()
+{
+	static const char*			kInputPath = "mirr_test_input.csv";
+	static const char*			kBinaryPath = "mirr_test_input.bin";
+	static const char*			kCsvResultsPath = "mirr_test_results.csv";
+	static const char*			kBinaryResultsPath = "mirr_test_results.bin";
+	static const std::size_t	kAccounts = 500;
+
+	std::string	text = MakeCashFlowsCsv(kAccounts);
+	bool		matched = true;
+
+	{
+		std::ofstream	file(kInputPath, std::ios::binary);
+		file.write(text.data(), text.size());
+	}
+
+	const char*	csv_arguments[] = { "mirr", kInputPath, "--threads", "2", "--write-binary", kBinaryPath, "-o", kCsvResultsPath };
+	const char*	binary_arguments[] = { "mirr", "--method=newton", "--seed", "taylor", "--verify", kBinaryPath, "--output", kBinaryResultsPath };
+
+	mirr::CommandLineOptions	options;
+	std::string					error;
+	int							csv_exit = -1;
+	int							binary_exit = -1;
+
+	if (mirr::ParseCommandLine(8, csv_arguments, options, error)) {
+		csv_exit = mirr::RunCommandLine(options);
+	}
+
+	if (mirr::ParseCommandLine(8, binary_arguments, options, error) &&
+		(options.options_.method_ == mirr::solver_method_e::newton) && (options.options_.seed_ == mirr::seed_strategy_e::taylor)) {
+		binary_exit = mirr::RunCommandLine(options);
+	}
+
+	if ((csv_exit != 0) || (binary_exit != 0)) {
+		cout << "Command line exit " << csv_exit << ", " << binary_exit << " " << error << endl;
+		matched = false;
+	}
+
+	// Compare the results to searching for each account directly.
+
+	mirr::Portfolio					portfolio;
+	mirr::CsvReadStats				stats;
+	mirr::Calculator				calculator;
+	std::vector<mirr::BatchResult>	binary_results;
+	std::ifstream					csv_results(kCsvResultsPath);
+	std::string						line;
+
+	calculator.print_log_ = false;
+	mirr::ParseCashFlowsCsv(text.data(), text.size(), 1, portfolio, stats);
+
+	mirr::file_status_e	status = mirr::ReadResultsBinary(kBinaryResultsPath, binary_results);
+
+	if ((status != mirr::file_status_e::file_ok) || (binary_results.size() != portfolio.size()) ||
+		!std::getline(csv_results, line) || (line != "account_id,rate,status,iterations,evaluations")) {
+		cout << "Command line results " << mirr::FileStatusName(status) << " " << binary_results.size() << endl;
+		matched = false;
+	}
+
+	for (std::size_t a = 0; (a < portfolio.size()) && matched; a++) {
+		calculator.calc_log.clear();
+		calculator.options_ = mirr::SolverOptions();
+
+		mirr::Rate_t			brent_rate = calculator.GetRate(portfolio.GetView(a));
+		mirr::solve_status_e	brent_status = calculator.GetStatus();
+
+		calculator.calc_log.clear();
+		calculator.options_.method_ = mirr::solver_method_e::newton;
+		calculator.options_.seed_ = mirr::seed_strategy_e::taylor;
+
+		mirr::Rate_t	newton_rate = calculator.GetRate(portfolio.GetView(a));
+
+		std::getline(csv_results, line);
+
+		std::istringstream	fields(line);
+		std::string			id;
+		std::string			rate;
+		std::string			status_name;
+
+		std::getline(fields, id, ',');
+		std::getline(fields, rate, ',');
+		std::getline(fields, status_name, ',');
+
+		if ((id != portfolio.GetAccountId(a)) || (status_name != mirr::SolveStatusName(brent_status)) ||
+			!((std::stod(rate) == static_cast<double>(brent_rate)) || (std::isnan(brent_rate) && (rate.find("nan") != std::string::npos)))) {
+			cout << "Command line CSV result " << line << " != " << static_cast<double>(brent_rate) << endl;
+			matched = false;
+		}
+
+		if ((binary_results[a].status_ != calculator.GetStatus()) || (binary_results[a].evaluations_ != calculator.GetEvaluations()) ||
+			!((binary_results[a].rate_ == static_cast<double>(newton_rate)) || (std::isnan(newton_rate) && std::isnan(binary_results[a].rate_)))) {
+			cout << "Command line binary result " << a << " " << binary_results[a].rate_ << " != " << newton_rate << endl;
+			matched = false;
+		}
+	}
+
+	csv_results.close();
+
+	// Options that are not valid.
+
+	const char*	bad_arguments[][3] = {
+		{ "mirr", kInputPath, "--threads=x" },
+		{ "mirr", kInputPath, "--method" },
+		{ "mirr", kInputPath, "--precision=half" },
+		{ "mirr", kInputPath, "--compounding=monthly" },
+		{ "mirr", kInputPath, "--stats=1" },
+		{ "mirr", kInputPath, "--trace=8" },
+		{ "mirr", "--frobnicate", kInputPath },
+		{ "mirr", "--output-format", "xml" }
+	};
+
+	for (const auto& arguments : bad_arguments) {
+		if (mirr::ParseCommandLine(3, arguments, options, error)) {
+			cout << "Command line accepted " << arguments[1] << " " << arguments[2] << endl;
+			matched = false;
+		}
+	}
+
+	std::remove(kInputPath);
+	std::remove(kBinaryPath);
+	std::remove(kCsvResultsPath);
+	std::remove(kBinaryResultsPath);
+
+	cout << "Test CommandLine: " << portfolio.size() << " accounts " << (matched ? "(matched)" : "(MISMATCH)") << endl;
+
+	return matched;
+}
+
+//----------------------------------------------------------------------------------
+// Find every rate of cash flows with two known rates and of the test cases, checking
+// each rate found makes the NPV zero and the calculator's rate is one of them and is
+// the one selected.
+bool	TestFindRates()
+{
+	mirr::CashFlowList	cash_flows;
+	bool				matched = true;
+
+	// -1000 + 2300 v - 1320 v^2 = 0 has roots v = 1/1.1 and 1/1.2 where v is the discount
+	// over half the range, so the rates over the range are 1.1^2 - 1 and 1.2^2 - 1.  The
+	// NPV is negative at both ends of the calculator's fixed range so it reports the rate
+	// as not bracketed and neither is selected; if it did find a rate it must be one of
+	// them and be the only one selected.
+
+	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2010-01-01"), -1000));
+	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2011-01-01"), 2300));
+	cash_flows.push_back(mirr::CashFlow(dates::MakeDate("2012-01-01"), -1320));
+
+	mirr::Calculator	calculator;
+
+	calculator.print_log_ = false;
+
+	mirr::Rate_t			rate = calculator.GetRate(cash_flows);
+	bool					solved = (calculator.GetStatus() == mirr::solve_status_e::solved);
+	mirr::RootScanOptions	options;
+
+	if (solved) {
+		options.selected_rate_ = rate;
+	}
+
+	mirr::RateRoots	two = mirr::FindRates(mirr::CashFlowPlan(cash_flows), options);
+	std::size_t		selected = 0;
+
+	for (const mirr::RateRoot& root : two.roots_) {
+		selected += ((root.flags_ & mirr::root_flag_e::root_selected) != 0) ? 1 : 0;
+	}
+
+	if (solved ? ((selected != 1) || ((std::abs(rate - 0.21) > 1e-9) && (std::abs(rate - 0.44) > 1e-9))) : (selected != 0)) {
+		cout << "Two rates: calculator returned " << rate << " with status " << calculator.GetStatus() << endl;
+		matched = false;
+	}
+
+	if ((two.sign_changes_ != 2) || !two.IsComplete() ||
+		(std::abs(two.roots_[0].rate_ - 0.21) > 1e-12) || (std::abs(two.roots_[1].rate_ - 0.44) > 1e-12)) {
+		cout << "Two rates: " << two.roots_.size() << " of " << two.sign_changes_ << " found, " << selected << " selected" << endl;
+		matched = false;
+	}
+
+	std::vector<MIRRTestCase>	test_cases = MakeMIRRTestCases();
+
+	for (MIRRTestCase& test_case : test_cases) {
+		calculator.calc_log.clear();
+
+		mirr::CashFlowPlan		plan(test_case.cash_flows_);
+		mirr::Rate_t			rate = calculator.GetRate(plan);
+		bool					solved = (calculator.GetStatus() == mirr::solve_status_e::solved);
+		mirr::RootScanOptions	options;
+
+		if (solved) {
+			options.selected_rate_ = rate;
+		}
+
+		mirr::RateRoots	rates = mirr::FindRates(plan, options);
+		mirr::NPV_t		scale = 0.0;
+
+		for (mirr::CashFlow& cash_flow : test_case.cash_flows_) {
+			scale += std::abs(cash_flow.amount_);
+		}
+
+		cout << "  " << rates.roots_.size() << " of at most " << rates.sign_changes_ << " rates in "
+			<< rates.passes_ << " passes:";
+
+		for (const mirr::RateRoot& root : rates.roots_) {
+			cout << " " << std::setprecision(10) << root.rate_ << (((root.flags_ & mirr::root_flag_e::root_selected) != 0) ? "*" : "");
+
+			if ((root.status_ != mirr::solve_status_e::solved) || (std::abs(root.npv_) > 1e-9 * scale)) {
+				cout << " (NPV " << root.npv_ << ")";
+				matched = false;
+			}
+		}
+		cout << endl;
+
+		if (solved && (rate > -0.99999) && (rate < 10000.0) &&
+			std::none_of(rates.roots_.begin(), rates.roots_.end(),
+				[](const mirr::RateRoot& in_root) { return ((in_root.flags_ & mirr::root_flag_e::root_selected) != 0); })) {
+			cout << "  rate " << rate << " was not found" << endl;
+			matched = false;
+		}
+	}
+
+	cout << "Test FindRates: " << (matched ? "(matched)" : "(MISMATCH)") << endl;
+
+	return matched;
+}
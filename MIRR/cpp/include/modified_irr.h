@@ -2,11 +2,17 @@
 
 #include <ctime>
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <sstream>
 #include <vector>
 
+#include "date_math.h"
 #include "log.h"
+#include "log_sink.h"
+#include "precision.h"
+#include "solver_trace.h"
 
 //----------------------------------------------------------------------------------
 //	MIRR (Modified Internal Rate of Return)
@@ -15,7 +21,26 @@ namespace mirr {
 	using CashFlowAmt_t = long double;
 	using NPV_t = long double;
 	using Rate_t = long double;
+	using Day_t = std::int32_t;
 
+	//----------------------------------------------------------------------------------
+	// Identify the outcome of searching for the rate of a series of cash flows.
+	enum solve_status_e
+	{
+		solved = 0,
+		not_bracketed = 1,
+		failed = 2
+	};
+
+	//----------------------------------------------------------------------------------
+	// Identify how a rate is compounded over the days from the first cash flow, i.e. the
+	// exponent each cash flow is discounted by.
+	enum compounding_e
+	{
+		since_inception = 0,	// days / days in the range: the rate is over the whole range.
+		annual = 1,				// days / 365: the rate is an annual rate (like XIRR in Excel).
+		daily = 2				// days: the rate is a daily rate.
+	};
 
 	//----------------------------------------------------------------------------------
 	// The properties of a cash flow that occured on a particular date.
@@ -23,7 +48,7 @@ namespace mirr {
 
 	public:
 
-		CashFlow(const std::time_t& in_date, const CashFlowAmt_t& in_amount)
+		CashFlow(const dates::Date_t& in_date, const CashFlowAmt_t& in_amount)
 			: date_(in_date)
 			, amount_(in_amount)
 			, days_from_start_(0)
@@ -51,7 +76,7 @@ namespace mirr {
 
 		// Properties
 
-		std::time_t		date_;
+		dates::Date_t	date_;
 		CashFlowAmt_t	amount_ = 0;
 		long			days_from_start_ = 0;
 	};
@@ -75,33 +100,227 @@ namespace mirr {
 		// recalculating, calculate the days from start for each cash flow.
 		void	push_back(CashFlow& in_new);
 
+		// Replace the cash flows with ones in any order.  See Finalize().
+		void	Assign(const std::vector<CashFlow>& in_cash_flows);
+
+		// Sort the cash flows by date once, merge the cash flows on the same day into one
+		// (the NPV is additive) and calculate the days from the start in a single pass.
+		// This avoids push_back() recalculating every cash flow each time an earlier one
+		// is added.
+		void	Finalize();
+
+		// Return whether or not the cash flows are known to be in date order, so the first
+		// and last are the start and end.  Changing the cash flows other than through
+		// push_back() and Finalize() must keep them in order.
+		bool	IsSorted() const { return sorted_; }
+
 		// Return the number of days between the start and end dates of the list.
 		long	GetDaysInRange();
 
+		// Find the coarsest grid of whole months from the first cash flow that every cash
+		// flow falls on, using the month-end rule of dates::AddMonths() (e.g. cash flows
+		// from January 31 fall on the last day of each month).  Returns the months between
+		// the points of the grid with each cash flow's point in out_periods, or 0 if the
+		// cash flows are not all on a grid of months (e.g. they are weekly).
+		int		FindMonthlyGrid(std::vector<std::size_t>& out_periods) const;
+
 		// Given a discount rate, calculate the value of the series of
 		// cash flows discounted by that rate.
 		NPV_t	calculateNPV(const Rate_t& in_daily_discount_rate);
 
+		// Calculate the value with the rate compounded by a different convention.
+		NPV_t	calculateNPV(const Rate_t& in_daily_discount_rate, compounding_e in_compounding);
+
+		// Calculate the same value with a numeric policy from precision.h, e.g.
+		// calculateNPV<DoublePrecision>(rate).  LongDoublePrecision is the calculation
+		// above.
+		template <class PRECISION_T>
+		typename PRECISION_T::value_t	calculateNPV(const typename PRECISION_T::value_t& in_daily_discount_rate,
+														compounding_e in_compounding = compounding_e::since_inception);
+
 	private:
 		// Properties
 
-		std::time_t		start_date_;
-		std::time_t		end_date_;
+		dates::Date_t	start_date_ = 0;
+		dates::Date_t	end_date_ = 0;
+		bool			sorted_ = true;
 
 	};
 
 	//----------------------------------------------------------------------------------
-	// Find the rate of return that makes the series of cash flows have an NPV = 0.
-	class Calculator {
+	// A read-only view of cash flows stored as columns: the days from the start and the
+	// amounts are each contiguous so calculating the NPV only reads the values it needs.
+	// The view does not own the columns so it must not outlive them.
+	struct CashFlowView {
+
+		const Day_t*			days_ = nullptr;
+		const CashFlowAmt_t*	amounts_ = nullptr; // May be null if only double amounts are stored (e.g. read from a file).
+		const double*			amounts_double_ = nullptr; // The amounts rounded to double for the vector kernels.
+		std::size_t				size_ = 0;
+		Day_t					last_day_ = 0; // Days from start of the latest cash flow.
+		const dates::Date_t*	start_date_ = nullptr; // The date of day 0 if it is known (e.g. a portfolio account's start date).
+
+		std::size_t	size() const { return size_; }
+
+		// Find the grid of months the cash flows fall on as CashFlowList::FindMonthlyGrid()
+		// does.  Returns 0 if the view has no start date.
+		int		FindMonthlyGrid(std::vector<std::size_t>& out_periods) const;
+
+		// Given a discount rate, calculate the value of the series of
+		// cash flows discounted by that rate.
+		NPV_t	calculateNPV(const Rate_t& in_daily_discount_rate) const;
+
+		// Calculate the same value in double precision using the fastest vector
+		// kernel the processor supports.
+		double	calculateNPVDouble(double in_daily_discount_rate) const;
+	};
 
+	//----------------------------------------------------------------------------------
+	// The cash flows of a list stored as a column of days from the start and a column
+	// of amounts.  Build it once from a list and then calculate with its view.
+	class CashFlowColumns {
 	public:
-		Calculator() {}
+		CashFlowColumns() {}
+		CashFlowColumns(const CashFlowList& in_cash_flows);
+
+		// Replace the columns with the cash flows in the list.
+		void	Assign(const CashFlowList& in_cash_flows);
+
+		// Add a cash flow to the end of the columns.
+		void	push_back(Day_t in_days_from_start, const CashFlowAmt_t& in_amount);
+
+		void		clear();
+		std::size_t	size() const { return days_.size(); }
+
+		// Return a view of the columns for calculations.
+		CashFlowView	GetView() const;
+
+		const std::vector<Day_t>&			GetDays() const { return days_; }
+		const std::vector<CashFlowAmt_t>&	GetAmounts() const { return amounts_; }
+
+	private:
+		// Properties
+
+		std::vector<Day_t>			days_;
+		std::vector<CashFlowAmt_t>	amounts_;
+		std::vector<double>			amounts_double_;
+		Day_t						last_day_ = 0;
+	};
+
+	class CashFlowPlan;
+
+	//----------------------------------------------------------------------------------
+	// Identify the algorithm used to search for a rate.
+	enum solver_method_e
+	{
+		brent = 0,		// Derivative free (inverse quadratic, secant and bisection).
+		newton = 1,		// Newton steps using the NPV and its first derivative.
+		halley = 2		// Halley steps using the first and second derivatives.
+	};
+
+	//----------------------------------------------------------------------------------
+	// Identify how the first estimates of a rate are chosen.
+	enum seed_strategy_e
+	{
+		fixed_bracket = 0,		// Start from -99.999% to 100% whatever the cash flows.
+		modified_dietz = 1,		// Start around the Modified Dietz return.
+		taylor = 2				// Start around the root of the first-order Taylor expansion of the NPV.
+	};
+
+	//----------------------------------------------------------------------------------
+	// Identify the precision the search for a rate is calculated in.
+	enum solve_precision_e
+	{
+		full_precision = 0,		// Search with the calculator's numeric policy throughout.
+		mixed_precision = 1		// Search with Brent's method using the double vector kernel, then polish the
+								// rate with up to two Newton steps in the calculator's precision.
+	};
+
+	//----------------------------------------------------------------------------------
+	// The settings used when searching for a rate.
+	struct SolverOptions {
+		solver_method_e		method_ = solver_method_e::brent;
+		seed_strategy_e		seed_ = seed_strategy_e::fixed_bracket;
+		solve_precision_e	precision_ = solve_precision_e::full_precision;
+		compounding_e		compounding_ = compounding_e::since_inception; // Used to compile lists and views.
+		Rate_t				seed_width_ = 0.01; // Half width of the first bracket around a seed in log(1 + rate) over the whole range.
+		bool				periodic_ = true; // Estimate the rate of cash flows on a grid of months with the polynomial solver.
+	};
+
+	//----------------------------------------------------------------------------------
+	// Find the rate of return that makes the series of cash flows have an NPV = 0.  The
+	// NPV and the search are calculated with the numeric policy PRECISION_T (see
+	// precision.h); Calculator uses long double throughout.
+	template <class PRECISION_T>
+	class BasicCalculator {
+
+	public:
+		using value_t = typename PRECISION_T::value_t;
+
+		BasicCalculator() {}
 
 		logging::Log	calc_log;
 
+		bool	print_log_ = true; // Write the log to the console after each search.
+
+		logging::LogSink*	log_sink_ = nullptr; // If set, the log is written here instead of the console.
+
+		SolverOptions	options_;
+
+		// Records the steps of each search once it is given a capacity, e.g.
+		// trace_.Reserve(64), so the steps of a failed search can be formatted afterwards.
+		roots::SolverTrace	trace_;
+
 		// Search for the solution/root to make the series of calcualtions equal zero.
-		Rate_t GetRate(CashFlowList& in_cash_flows);
+		// Cash flows on a grid of months (see CashFlowPlan::IsPeriodic()) are solved from
+		// the root of their periodic NPV, a polynomial, unless options_.periodic_ is
+		// cleared or the search is mixed precision.
+		value_t GetRate(CashFlowList& in_cash_flows);
+		value_t GetRate(const CashFlowView& in_cash_flows);
+		value_t GetRate(const CashFlowPlan& in_plan);
+
+		// Search again for the rate of cash flows that have changed only a little (e.g. a
+		// cash flow was appended) starting from their previous rate.  A few Newton steps
+		// from the previous rate usually find the new one; if they do not, a bracket
+		// around the previous rate is searched instead.
+		value_t GetRate(const CashFlowPlan& in_plan, const value_t& in_previous_rate);
+
+		// Return the outcome of the most recent search.
+		solve_status_e	GetStatus() const { return status_; }
+
+		// Return the number of iterations and NPV evaluations used by the most recent
+		// search including any attempts to find a range that brackets the rate.
+		long	GetIterations() const { return iterations_; }
+		long	GetEvaluations() const { return evaluations_; }
+
+		// Return the NPV at the rate found by the most recent mixed precision search,
+		// calculated in the calculator's precision from the original cash flows.  NaN if
+		// the search was not a mixed precision one or did not find a rate.
+		value_t	GetResidual() const { return residual_; }
 
+	private:
+
+		// Take Newton steps from an estimate that should be close to the rate, falling
+		// back to searching a bracket around it.  The description is logged with the rate.
+		value_t SearchFromRate(const CashFlowPlan& in_plan, const value_t& in_estimate, const char* in_description);
+
+		// Widen the estimates (in terms of log(1 + rate)) until they bracket the rate and
+		// then search the bracket with the selected method.
+		value_t SearchFromEstimates(const CashFlowPlan& in_plan, value_t in_log_low_estimate, value_t in_log_high_estimate);
+
+		// Widen the estimates and search the bracket with the double vector kernel, then
+		// polish the rate in the calculator's precision.
+		value_t SearchMixedPrecision(const CashFlowPlan& in_plan, value_t in_log_low_estimate, value_t in_log_high_estimate);
+
+		// Write the log to the sink or the console if it is printed.
+		void	PrintLog();
+
+		solve_status_e	status_ = solve_status_e::failed;
+		long			iterations_ = 0;
+		long			evaluations_ = 0;
+		value_t			residual_ = 0.0;
 	};
+
+	using Calculator = BasicCalculator<LongDoublePrecision>;
 };
 
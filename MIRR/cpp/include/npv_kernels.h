@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//----------------------------------------------------------------------------------
+// Provide kernels that calculate the NPV of columns of cash flows in double precision
+// using the widest vector instructions the processor supports.  The kernel used is
+// chosen once at run time from the processor's CPUID flags.
+//----------------------------------------------------------------------------------
+
+namespace mirr {
+namespace kernels {
+
+	//----------------------------------------------------------------------------------
+	// Identify the instructions a kernel is written for.
+	enum instruction_set_e
+	{
+		scalar = 0,
+		avx2 = 1,
+		avx512 = 2
+	};
+
+	//----------------------------------------------------------------------------------
+	// Calculate the sum of in_amounts[i] * exp(-in_scale * in_days[i]).  With in_scale
+	// = log(1 + rate) / last_day this is the since inception NPV of the cash flows.
+	using npv_kernel_t = double(*)(const std::int32_t* in_days, const double* in_amounts,
+									std::size_t in_count, double in_scale);
+
+	double	NPVScalar(const std::int32_t* in_days, const double* in_amounts, std::size_t in_count, double in_scale);
+	double	NPVAvx2(const std::int32_t* in_days, const double* in_amounts, std::size_t in_count, double in_scale);
+	double	NPVAvx512(const std::int32_t* in_days, const double* in_amounts, std::size_t in_count, double in_scale);
+
+	//----------------------------------------------------------------------------------
+	// Calculate the sum of in_amounts[i] * exp(-in_scale * in_exponents[i]) for
+	// exponents that were calculated in advance (e.g. by a CashFlowPlan).
+	using npv_exponent_kernel_t = double(*)(const double* in_exponents, const double* in_amounts,
+											std::size_t in_count, double in_scale);
+
+	double	NPVExponentsScalar(const double* in_exponents, const double* in_amounts, std::size_t in_count, double in_scale);
+	double	NPVExponentsAvx2(const double* in_exponents, const double* in_amounts, std::size_t in_count, double in_scale);
+	double	NPVExponentsAvx512(const double* in_exponents, const double* in_amounts, std::size_t in_count, double in_scale);
+
+	//----------------------------------------------------------------------------------
+	// Calculate out_npvs[k] = sum of in_amounts[i] * exp(-(in_first_scale + k *
+	// in_scale_step) * in_exponents[i]) for a grid of evenly spaced scales, i.e. rates
+	// evenly spaced in log(1 + rate).  A cash flow's discount at one scale is its discount
+	// at the scale before times exp(-in_scale_step * in_exponents[i]), so each cash flow
+	// needs two exp() for each block of eight scales rather than one for every scale.
+	using npv_grid_kernel_t = void(*)(const double* in_exponents, const double* in_amounts, std::size_t in_count,
+										double in_first_scale, double in_scale_step, std::size_t in_scale_count,
+										double* out_npvs);
+
+	void	NPVGridScalar(const double* in_exponents, const double* in_amounts, std::size_t in_count,
+							double in_first_scale, double in_scale_step, std::size_t in_scale_count, double* out_npvs);
+	void	NPVGridAvx2(const double* in_exponents, const double* in_amounts, std::size_t in_count,
+							double in_first_scale, double in_scale_step, std::size_t in_scale_count, double* out_npvs);
+	void	NPVGridAvx512(const double* in_exponents, const double* in_amounts, std::size_t in_count,
+							double in_first_scale, double in_scale_step, std::size_t in_scale_count, double* out_npvs);
+
+	//----------------------------------------------------------------------------------
+	// Return the widest instruction set that both the processor and this build support.
+	instruction_set_e	DetectInstructionSet();
+
+	//----------------------------------------------------------------------------------
+	// Return the instruction set of the kernel currently in use.
+	instruction_set_e	GetInstructionSet();
+
+	//----------------------------------------------------------------------------------
+	// Use the kernel for a particular instruction set (e.g. to compare them).  A set
+	// the processor does not support falls back to the detected one.
+	void	SetInstructionSet(instruction_set_e in_instruction_set);
+
+	//----------------------------------------------------------------------------------
+	// Return the kernel for the instruction set in use.
+	npv_kernel_t	GetNPVKernel();
+	npv_exponent_kernel_t	GetNPVExponentKernel();
+	npv_grid_kernel_t		GetNPVGridKernel();
+
+	//----------------------------------------------------------------------------------
+	// Return the name of an instruction set for reporting.
+	const char*	InstructionSetName(instruction_set_e in_instruction_set);
+
+}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "date_math.h"
+#include "modified_irr.h"
+
+//----------------------------------------------------------------------------------
+//	MIRR (Modified Internal Rate of Return)
+namespace mirr {
+
+	//----------------------------------------------------------------------------------
+	// The columns of a portfolio's cash flows.  The cash flows of account i are at
+	// offsets_[i] up to offsets_[i + 1] in the days and amounts columns, and its id is
+	// the characters from id_offsets_[i] up to id_offsets_[i + 1].  The days are counted
+	// from the account's start date (its earliest cash flow).
+	struct PortfolioColumns {
+		const std::uint64_t*	offsets_ = nullptr;		// account_count_ + 1 entries.
+		const Day_t*			days_ = nullptr;
+		const double*			amounts_ = nullptr;
+		const dates::Date_t*	start_dates_ = nullptr;	// account_count_ entries.
+		const std::uint64_t*	id_offsets_ = nullptr;	// account_count_ + 1 entries.
+		const char*				ids_ = nullptr;
+		std::size_t				account_count_ = 0;
+	};
+
+	//----------------------------------------------------------------------------------
+	// Columns of a portfolio built in memory (e.g. when reading a CSV file).
+	struct PortfolioStorage {
+		std::vector<std::uint64_t>	offsets_;
+		std::vector<Day_t>			days_;
+		std::vector<double>			amounts_;
+		std::vector<dates::Date_t>	start_dates_;
+		std::vector<std::uint64_t>	id_offsets_;
+		std::vector<char>			ids_;
+	};
+
+	//----------------------------------------------------------------------------------
+	// The cash flows of many accounts stored as columns grouped by account.  The columns
+	// are either held by the portfolio or held elsewhere (e.g. a mapped file) so each
+	// account's cash flows can be handed to the calculator as a view without copying.
+	class Portfolio {
+	public:
+		Portfolio() {}
+
+		Portfolio(const Portfolio&) = delete;
+		Portfolio&	operator=(const Portfolio&) = delete;
+		Portfolio(Portfolio&& io_other);
+		Portfolio&	operator=(Portfolio&& io_other);
+
+		// Take the columns built in memory.
+		void	Assign(PortfolioStorage&& in_storage);
+
+		// Use columns held elsewhere.  The owner (e.g. the mapped file) is kept alive for
+		// as long as the portfolio uses its columns.
+		void	Attach(const PortfolioColumns& in_columns, std::shared_ptr<const void> in_owner);
+
+		void	clear();
+
+		// Return the number of accounts and the total number of cash flows.
+		std::size_t	size() const { return columns_.account_count_; }
+		std::size_t	GetCashFlowCount() const;
+
+		// Return a view of one account's cash flows for the calculator.  The view is only
+		// valid while the portfolio is.
+		CashFlowView	GetView(std::size_t in_account) const;
+
+		std::string		GetAccountId(std::size_t in_account) const;
+		dates::Date_t	GetStartDate(std::size_t in_account) const { return columns_.start_dates_[in_account]; }
+
+		const PortfolioColumns&	GetColumns() const { return columns_; }
+
+	private:
+		// Properties
+
+		PortfolioColumns			columns_;
+		PortfolioStorage			storage_;
+		std::shared_ptr<const void>	owner_;
+	};
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+//----------------------------------------------------------------------------------
+// Provide the numeric policies the NPV and the search for a rate can be calculated
+// with.  Each policy names the type of the values and how a series of them is summed,
+// and is chosen at compile time where it is used, e.g.
+//   mirr::BasicCalculator<mirr::DoublePrecision>	calculator;
+//----------------------------------------------------------------------------------
+
+namespace mirr {
+
+	//----------------------------------------------------------------------------------
+	// Add values into a running sum with the precision of the type.
+	template <class VALUE_T>
+	class PlainSum {
+	public:
+		void	Add(VALUE_T in_value) { sum_ += in_value; }
+
+		VALUE_T	Get() const { return sum_; }
+
+	private:
+		VALUE_T	sum_ = 0;
+	};
+
+	//----------------------------------------------------------------------------------
+	// Add values into a running sum while carrying the low order bits lost by each
+	// addition (Neumaier's variant of Kahan summation), so the error of the sum does not
+	// grow with the number of values.  Adding a large value to a small sum is handled
+	// as well as adding a small value to a large sum, which matters when the amounts
+	// have mixed signs and cancel.
+	template <class VALUE_T>
+	class CompensatedSum {
+	public:
+		void	Add(VALUE_T in_value)
+		{
+			VALUE_T	sum = sum_ + in_value;
+
+			if (((sum_ < 0) ? -sum_ : sum_) >= ((in_value < 0) ? -in_value : in_value))
+			{
+				compensation_ += (sum_ - sum) + in_value;
+			}
+			else
+			{
+				compensation_ += (in_value - sum) + sum_;
+			}
+
+			sum_ = sum;
+		}
+
+		VALUE_T	Get() const { return sum_ + compensation_; }
+
+	private:
+		VALUE_T	sum_ = 0;
+		VALUE_T	compensation_ = 0;
+	};
+
+	//----------------------------------------------------------------------------------
+	// The policies.  value_t is the type every value of the calculation is held in and
+	// sum_t accumulates the discounted cash flows.
+
+	struct FloatPrecision {
+		using value_t = float;
+		using sum_t = PlainSum<float>;
+
+		static const char*	Name() { return "float"; }
+	};
+
+	struct DoublePrecision {
+		using value_t = double;
+		using sum_t = PlainSum<double>;
+
+		static const char*	Name() { return "double"; }
+	};
+
+	struct LongDoublePrecision {
+		using value_t = long double;
+		using sum_t = PlainSum<long double>;
+
+		static const char*	Name() { return "long double"; }
+	};
+
+	struct CompensatedDoublePrecision {
+		using value_t = double;
+		using sum_t = CompensatedSum<double>;
+
+		static const char*	Name() { return "compensated double"; }
+	};
+
+};
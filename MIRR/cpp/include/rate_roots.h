@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "cash_flow_plan.h"
+#include "modified_irr.h"
+
+//----------------------------------------------------------------------------------
+//	MIRR (Modified Internal Rate of Return)
+namespace mirr {
+
+	//----------------------------------------------------------------------------------
+	// Describe a rate found by FindRates().
+	enum root_flag_e
+	{
+		root_sign_change = 1,	// The NPV changes sign across the rate.
+		root_polished = 2,		// Newton steps in full precision converged from the double precision estimate.
+		root_selected = 4		// The rate given as RootScanOptions::selected_rate_.
+	};
+
+	//----------------------------------------------------------------------------------
+	// One rate that makes the NPV zero.
+	struct RateRoot {
+		Rate_t			rate_ = 0.0;
+		NPV_t			npv_ = 0.0;			// The NPV at the rate in full precision.
+		solve_status_e	status_ = solve_status_e::failed;
+		long			evaluations_ = 0;	// NPV evaluations used to refine this rate after the scan.
+		unsigned		flags_ = 0;			// root_flag_e values.
+	};
+
+	//----------------------------------------------------------------------------------
+	// The range of rates scanned for roots and how finely.  The rates are over the whole
+	// range of the cash flows; for a plan compounded annually or daily the equivalent
+	// annual or daily rates are scanned.  The root nearest the selected rate, e.g. the
+	// rate the caller's Calculator::GetRate() found, is marked root_selected.
+	struct RootScanOptions {
+		Rate_t		low_rate_ = -0.99999;
+		Rate_t		high_rate_ = 10000.0;
+		std::size_t	grid_points_ = 512;		// Spaced evenly in log(1 + rate).
+		long		max_iterations_ = 100;	// Refining steps for each bracketed rate.
+		Rate_t		selected_rate_ = std::numeric_limits<Rate_t>::quiet_NaN();	// NaN to select none.
+	};
+
+	//----------------------------------------------------------------------------------
+	// Every rate found for a series of cash flows.
+	struct RateRoots {
+		std::size_t				sign_changes_ = 0;	// Most rates possible (Descartes' rule of signs).
+		std::size_t				passes_ = 0;		// Passes over the cash flows to scan and refine.
+		std::vector<RateRoot>	roots_;				// In increasing order of rate.
+
+		// Return whether or not the cash flows can only have one rate (e.g. all of the
+		// payments in come before all of the payments out).
+		bool	IsUnique() const { return (sign_changes_ == 1); }
+
+		// Return whether or not as many rates were found as there can be.  Otherwise the
+		// rest are outside the scanned range or are pairs of rates too close together for
+		// the grid (including a rate where the NPV touches zero without changing sign),
+		// since the number of rates differs from the sign changes by an even number.
+		bool	IsComplete() const { return (roots_.size() == sign_changes_); }
+	};
+
+	//----------------------------------------------------------------------------------
+	// Find every rate that makes the NPV of the cash flows zero.  The number of sign
+	// changes of the amounts in date order bounds the number of rates.  The NPV is
+	// calculated at a grid of rates evenly spaced in log(1 + rate), which needs only a
+	// few exp() for each cash flow, and each interval where it changes sign is refined.
+	// All of the intervals are refined together: each step calculates the NPV at the
+	// next estimate of every rate.  The estimates are then polished with Newton steps in full precision.
+	RateRoots	FindRates(const CashFlowPlan& in_plan, const RootScanOptions& in_options = RootScanOptions());
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "batch_calculator.h"
+#include "cash_flow_file.h"
+#include "portfolio.h"
+
+//----------------------------------------------------------------------------------
+//	MIRR (Modified Internal Rate of Return)
+namespace mirr {
+
+	//----------------------------------------------------------------------------------
+	// The header at the start of a binary results file.  The records follow at
+	// record_position_, one per account in the order of the portfolio they were found
+	// for, in the byte order of the machine that wrote them (checked by byte_order_).
+	struct ResultFileHeader {
+		char			magic_[8];				// "MIRRRES\0"
+		std::uint32_t	version_;
+		std::uint32_t	byte_order_;			// 0x01020304 as written.
+		std::uint64_t	count_;
+		std::uint64_t	record_position_;		// Offset of the first record from the start of the file.
+		std::uint64_t	record_size_;
+		std::uint64_t	checksum_;				// Checksum of the records.
+		std::uint64_t	header_checksum_;		// Checksum of the header before this field.
+	};
+
+	//----------------------------------------------------------------------------------
+	// One account's result in a binary results file.
+	struct ResultRecord {
+		double			rate_;
+		std::int32_t	status_;				// A solve_status_e.
+		std::int32_t	iterations_;
+		std::int32_t	evaluations_;
+		std::int32_t	reserved_;
+		std::int64_t	nanoseconds_;
+	};
+
+	//----------------------------------------------------------------------------------
+	// Write the results of a portfolio's accounts as CSV with a header line:
+	//   account_id,rate,status,iterations,evaluations
+	// The rates have enough digits to read back the same double.
+	void	WriteResultsCsv(std::ostream& io_stream, const Portfolio& in_portfolio, const std::vector<BatchResult>& in_results);
+
+	//----------------------------------------------------------------------------------
+	// Write the results as a binary file, or read them back.  Reading checks the
+	// header and the records' checksum.
+	file_status_e	WriteResultsBinary(const std::string& in_path, const std::vector<BatchResult>& in_results);
+	file_status_e	ReadResultsBinary(const std::string& in_path, std::vector<BatchResult>& out_results);
+};
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <functional>
+#include <limits>
 #include <iostream>
 #include "log.h"
+#include "solver_trace.h"
 
 using namespace logging;
 using namespace std;
@@ -52,6 +57,291 @@ namespace roots {
 		relative_to_solution_e	relative_position_ = relative_to_solution_e::unknown;
 	};
 
+	//----------------------------------------------------------------------------------
+	// The value of a function at a point with its first and second derivatives there.
+	template <class RESULT_T>
+	struct Derivatives {
+		RESULT_T	value_ = 0.0;
+		RESULT_T	first_ = 0.0;
+		RESULT_T	second_ = 0.0;
+	};
+
+	//----------------------------------------------------------------------------------
+	// Two estimates and the function's results at them.  When found_ is set the results
+	// have opposite signs (or one is zero) so the estimates bracket a root.
+	template <class RESULT_T>
+	struct Bracket {
+		RESULT_T	low_ = 0.0;
+		RESULT_T	high_ = 0.0;
+		RESULT_T	low_result_ = 0.0;
+		RESULT_T	high_result_ = 0.0;
+		long		evaluations_ = 0; // Number of times the function was evaluated to find it.
+		bool		found_ = false;
+	};
+
+	//----------------------------------------------------------------------------------
+	// Search outwards from two estimates for a range that brackets a root of a function.
+	// While the results have the same sign, the end whose result is closer to zero is
+	// moved away from the other end by in_growth times the current width, so the range
+	// grows geometrically and a distant root is reached in a few evaluations.  The low end
+	// is never moved below in_lowest; once it is there only the high end is moved.  Rather
+	// than raising an exception, the bracket reports whether it was found and how many
+	// evaluations it took.
+	template <class RESULT_T, class FUNCTION_T>
+	Bracket<RESULT_T>	FindBracket(RESULT_T in_low, RESULT_T in_high, FUNCTION_T&& in_function,
+									long in_max_expansions = 50, RESULT_T in_growth = 1.6,
+									RESULT_T in_lowest = -std::numeric_limits<RESULT_T>::infinity())
+	{
+		Bracket<RESULT_T>	bracket;
+
+		bracket.low_ = std::min(in_low, in_high);
+		bracket.high_ = std::max(in_low, in_high);
+		bracket.low_result_ = (in_function)(bracket.low_);
+		bracket.high_result_ = (in_function)(bracket.high_);
+		bracket.evaluations_ = 2;
+
+		for (long expansion = 0; expansion <= in_max_expansions; expansion++)
+		{
+			if ((bracket.low_result_ * bracket.high_result_) <= 0)
+			{
+				bracket.found_ = true;
+				break;
+			}
+
+			if (expansion == in_max_expansions)
+			{
+				break;
+			}
+
+			RESULT_T	width = bracket.high_ - bracket.low_;
+
+			if ((std::abs(bracket.low_result_) < std::abs(bracket.high_result_)) && (bracket.low_ > in_lowest))
+			{
+				bracket.high_ = bracket.low_;
+				bracket.high_result_ = bracket.low_result_;
+				bracket.low_ = std::max(bracket.low_ - (in_growth * width), in_lowest);
+				bracket.low_result_ = (in_function)(bracket.low_);
+			}
+			else
+			{
+				bracket.low_ = bracket.high_;
+				bracket.low_result_ = bracket.high_result_;
+				bracket.high_ += in_growth * width;
+				bracket.high_result_ = (in_function)(bracket.high_);
+			}
+
+			bracket.evaluations_++;
+		}
+
+		return bracket;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Evaluate the polynomial in_coefficients[0] + in_coefficients[1] * x + ... +
+	// in_coefficients[in_count - 1] * x^(in_count - 1) and its derivatives at x by
+	// Horner's scheme with no powers.  The coefficients are taken two at a time,
+	// multiplying by x^2, so half of the multiply-adds do not wait for the one before
+	// them.  The derivatives are found as x * p'(x) = sum(k * a[k] * x^k) and
+	// x^2 * p''(x) = sum(k * (k - 1) * a[k] * x^k) in the same pass.  The second
+	// derivative is only calculated if it is requested.
+	template <class RESULT_T>
+	Derivatives<RESULT_T>	EvaluatePolynomial(const RESULT_T* in_coefficients, std::size_t in_count, RESULT_T in_x,
+												bool in_second = true)
+	{
+		Derivatives<RESULT_T>	result;
+		RESULT_T				x_squared = in_x * in_x;
+		std::size_t				k = in_count;
+
+		if ((k % 2) == 1)
+		{
+			RESULT_T	power = static_cast<RESULT_T>(--k);
+
+			result.value_ = in_coefficients[k];
+			result.first_ = power * in_coefficients[k];
+			result.second_ = (in_second ? (power * (power - 1) * in_coefficients[k]) : 0);
+		}
+
+		while (k >= 2)
+		{
+			k -= 2;
+
+			RESULT_T	power = static_cast<RESULT_T>(k);
+			RESULT_T	high = in_coefficients[k + 1];
+			RESULT_T	low = in_coefficients[k];
+
+			result.value_ = (result.value_ * x_squared) + ((high * in_x) + low);
+			result.first_ = (result.first_ * x_squared) + (((power + 1) * high * in_x) + (power * low));
+
+			if (in_second)
+			{
+				result.second_ = (result.second_ * x_squared) + ((((power + 1) * power) * high * in_x) + ((power * (power - 1)) * low));
+			}
+		}
+
+		if (in_x != 0)
+		{
+			result.first_ /= in_x;
+			result.second_ /= x_squared;
+		}
+		else
+		{
+			result.first_ = ((in_count > 1) ? in_coefficients[1] : 0);
+			result.second_ = ((in_second && (in_count > 2)) ? (2 * in_coefficients[2]) : 0);
+		}
+
+		return result;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Evaluate only the value of the polynomial, taking the coefficients two at a time.
+	template <class RESULT_T>
+	RESULT_T	EvaluatePolynomialValue(const RESULT_T* in_coefficients, std::size_t in_count, RESULT_T in_x)
+	{
+		RESULT_T	result = 0.0;
+		RESULT_T	x_squared = in_x * in_x;
+		std::size_t	k = in_count;
+
+		if ((k % 2) == 1)
+		{
+			result = in_coefficients[--k];
+		}
+
+		while (k >= 2)
+		{
+			k -= 2;
+			result = (result * x_squared) + ((in_coefficients[k + 1] * in_x) + in_coefficients[k]);
+		}
+
+		return result;
+	}
+
+	//----------------------------------------------------------------------------------
+	// The positive root of a polynomial and the number of times the polynomial was
+	// evaluated to find it.  found_ is only set if the root was found.
+	template <class RESULT_T>
+	struct PolynomialRoot {
+		RESULT_T	root_ = 0.0;
+		long		evaluations_ = 0;
+		bool		found_ = false;
+	};
+
+	//----------------------------------------------------------------------------------
+	// Find the positive root of a polynomial whose coefficients change sign exactly once,
+	// which by Descartes' rule of signs is its only positive root.  Near zero the
+	// polynomial has the sign of its lowest non-zero coefficient and beyond the root the
+	// opposite sign, so the root is bracketed by doubling or halving from 1 until the
+	// sign changes.  It is then found with Newton steps from the end nearest 1, using the
+	// derivative Horner's scheme calculates with the value, and bisection whenever a step
+	// would leave the bracket.  The search stops once the steps are within a few units in
+	// the last place of the root.  Rather than raising an exception, the result reports
+	// whether the root was found, e.g. it is not if the coefficients do not change sign
+	// exactly once.
+	template <class RESULT_T>
+	PolynomialRoot<RESULT_T>	FindPositivePolynomialRoot(const RESULT_T* in_coefficients, std::size_t in_count,
+															long in_max_iterations = 100)
+	{
+		static const	int	kMaxExpansions = 64;
+
+		PolynomialRoot<RESULT_T>	result;
+		RESULT_T					tolerance = 4 * std::numeric_limits<RESULT_T>::epsilon();
+		std::size_t					sign_changes = 0;
+		int							low_sign = 0;
+		int							last_sign = 0;
+
+		auto	sign_of = [](RESULT_T in_value) { return (in_value > 0) - (in_value < 0); };
+
+		for (std::size_t k = 0; k < in_count; k++)
+		{
+			int	sign = sign_of(in_coefficients[k]);
+
+			if (sign != 0)
+			{
+				sign_changes += ((last_sign != 0) && (sign != last_sign)) ? 1 : 0;
+				low_sign = (low_sign != 0) ? low_sign : sign;
+				last_sign = sign;
+			}
+		}
+
+		if (sign_changes != 1)
+		{
+			return result;
+		}
+
+		// Bracket the root between the estimate nearest 1 and the farthest one so that the
+		// polynomial has low_sign at low and the opposite sign at high.
+
+		RESULT_T				estimate = 1.0;
+		RESULT_T				farthest = 1.0;
+		Derivatives<RESULT_T>	current = EvaluatePolynomial(in_coefficients, in_count, estimate, false);
+		Derivatives<RESULT_T>	farthest_current = current;
+		bool					root_above = (sign_of(current.value_) == low_sign);
+
+		result.evaluations_++;
+
+		for (int expansion = 0; (farthest_current.value_ != 0) && ((sign_of(farthest_current.value_) == low_sign) == root_above); expansion++)
+		{
+			if (!std::isfinite(farthest_current.value_) || (expansion == kMaxExpansions))
+			{
+				return result;
+			}
+
+			estimate = farthest;
+			current = farthest_current;
+			farthest = (root_above ? (farthest * 2) : (farthest / 2));
+			farthest_current = EvaluatePolynomial(in_coefficients, in_count, farthest, false);
+			result.evaluations_++;
+		}
+
+		RESULT_T	low = (root_above ? estimate : farthest);
+		RESULT_T	high = (root_above ? farthest : estimate);
+
+		if (farthest_current.value_ == 0)
+		{
+			estimate = farthest;
+			current = farthest_current;
+		}
+
+		for (long iteration = 0; (current.value_ != 0) && (iteration < in_max_iterations); iteration++)
+		{
+			if (sign_of(current.value_) == low_sign)
+			{
+				low = estimate;
+			}
+			else
+			{
+				high = estimate;
+			}
+
+			RESULT_T	step = current.value_ / current.first_;
+
+			if (std::abs(step) <= (tolerance * estimate))
+			{
+				estimate -= step;
+				break;
+			}
+
+			estimate -= step;
+
+			if (!((estimate > low) && (estimate < high)))
+			{
+				estimate = (low + high) / 2;
+			}
+
+			if ((high - low) <= (tolerance * high))
+			{
+				break;
+			}
+
+			current = EvaluatePolynomial(in_coefficients, in_count, estimate, false);
+			result.evaluations_++;
+		}
+
+		result.root_ = estimate;
+		result.found_ = std::isfinite(estimate);
+
+		return result;
+	}
+
 	//----------------------------------------------------------------------------------
 	// Given a function of the form 0 = f(x), searching for a value of x that will 
 	// make the result 0.
@@ -61,19 +351,41 @@ namespace roots {
 	public:
 
 		using function_t = std::function < RESULT_T(const RESULT_T&) > ;
+		using derivatives_function_t = std::function < Derivatives<RESULT_T>(const RESULT_T&) >;
 
 		enum methods_available
 		{
 			unknown = 0,
 			quadratic_interpolation = 1,
 			secant = 2,
-			bisection = 3
+			bisection = 3,
+			newton = 4,
+			halley = 5
 		};
 
+		//----------------------------------------------------------------------------------
+		// Return the number of iterations and function evaluations used by the most
+		// recent search.
+		long	GetIterations() const { return iterations_; }
+		long	GetEvaluations() const { return evaluations_; }
+
+		//----------------------------------------------------------------------------------
+		// Return how close two estimates must be for a search to stop: 1e-9, or a few
+		// units in the last place of RESULT_T if that is coarser (e.g. float), so a search
+		// in a narrow type stops once its estimates cannot get any closer.
+		static RESULT_T	GetEstimateTolerance() {
+			return std::max(static_cast<RESULT_T>(0.000000001), static_cast<RESULT_T>(16) * std::numeric_limits<RESULT_T>::epsilon());
+		}
+
 		//----------------------------------------------------------------------------------
 		// Define a log that the calculations can use to record their steps.
 		logging::Log	calc_log = Log(logging::Control(info));
 
+		//----------------------------------------------------------------------------------
+		// If set, each step of a search is also recorded in this trace (which is not
+		// owned by the root finder).
+		SolverTrace*	trace_ = nullptr;
+
 		// ----------------------------------------------------------------------------------
 		// This method uses a close variation on the Brent's/Brent-Dekker algorithm for finding
 		// a root for some function given the function and two estimates for the solution.  The
@@ -88,7 +400,153 @@ namespace roots {
 		// Note that some of the conditions for choosing one estimation method over the others
 		// are slightly different from the traditional algorithm to account for its specific
 		// application in this case.
+		//
+		// The function can be any callable taking and returning a RESULT_T.  Passing a lambda
+		// or function object directly (rather than a std::function) lets the compiler inline
+		// the function into the search loop.
 		RESULT_T	SearchForRoot(RESULT_T in_best_estimate, RESULT_T in_counter_estimate, function_t in_function) {
+			return SearchForRoot<function_t&>(in_best_estimate, in_counter_estimate, in_function);
+		}
+
+		template <class FUNCTION_T>
+		RESULT_T	SearchForRoot(RESULT_T in_best_estimate, RESULT_T in_counter_estimate, FUNCTION_T&& in_function) {
+
+			RESULT_T	best_result = (in_function)(in_best_estimate);		//f(b);
+			RESULT_T	counter_result = (in_function)(in_counter_estimate); //f(a)
+
+			return SearchForRootFrom(in_best_estimate, best_result, in_counter_estimate, counter_result, in_function, 2);
+		}
+
+		//----------------------------------------------------------------------------------
+		// Search within a bracket that was already found (e.g. by FindBracket) without
+		// evaluating the function at its ends again.
+		template <class FUNCTION_T>
+		RESULT_T	SearchForRoot(const Bracket<RESULT_T>& in_bracket, FUNCTION_T&& in_function) {
+			return SearchForRootFrom(in_bracket.high_, in_bracket.high_result_, in_bracket.low_, in_bracket.low_result_, in_function, 0);
+		}
+
+		// ----------------------------------------------------------------------------------
+		// Search for a root using Newton's method, or Halley's method when in_use_halley is
+		// set, with a function that returns its derivatives along with its value.  Like
+		// SearchForRoot, the estimates must bracket the root or a RangeException is raised.
+		//
+		// The bracket is kept throughout: each step is taken from the estimate with the
+		// result closest to zero, and a step that would leave the bracket or is not shrinking
+		// quickly enough is replaced by bisection.  Near the root Newton converges
+		// quadratically and Halley cubically, so this typically needs far fewer evaluations
+		// than SearchForRoot when the derivatives are cheap to calculate with the value.
+		RESULT_T	SearchForRootNewton(RESULT_T in_best_estimate, RESULT_T in_counter_estimate,
+										derivatives_function_t in_function, bool in_use_halley) {
+			return SearchForRootNewton<derivatives_function_t&>(in_best_estimate, in_counter_estimate, in_function, in_use_halley);
+		}
+
+		template <class FUNCTION_T>
+		RESULT_T	SearchForRootNewton(RESULT_T in_best_estimate, RESULT_T in_counter_estimate,
+										FUNCTION_T&& in_function, bool in_use_halley) {
+
+			Derivatives<RESULT_T>	best = (in_function)(in_best_estimate);
+			Derivatives<RESULT_T>	counter = (in_function)(in_counter_estimate);
+
+			return SearchForRootNewtonFrom(in_best_estimate, best, in_counter_estimate, counter, in_function, in_use_halley, 2);
+		}
+
+		//----------------------------------------------------------------------------------
+		// Search within a bracket that was already found.  Only the derivatives at the end
+		// closest to the root are needed to take the first step.
+		template <class FUNCTION_T>
+		RESULT_T	SearchForRootNewton(const Bracket<RESULT_T>& in_bracket, FUNCTION_T&& in_function, bool in_use_halley) {
+
+			bool					low_is_best = (std::abs(in_bracket.low_result_) < std::abs(in_bracket.high_result_));
+			RESULT_T				best_estimate = (low_is_best ? in_bracket.low_ : in_bracket.high_);
+			RESULT_T				counter_estimate = (low_is_best ? in_bracket.high_ : in_bracket.low_);
+			Derivatives<RESULT_T>	best = (in_function)(best_estimate);
+			Derivatives<RESULT_T>	counter;
+
+			counter.value_ = (low_is_best ? in_bracket.high_result_ : in_bracket.low_result_);
+
+			return SearchForRootNewtonFrom(best_estimate, best, counter_estimate, counter, in_function, in_use_halley, 1);
+		}
+
+		//----------------------------------------------------------------------------------
+		// Take Newton (or Halley) steps from an estimate that is expected to be very close
+		// to the root, such as the previous solution of a slightly different function, without
+		// first finding a bracket.  Returns true with out_root set once the result or the step
+		// is within the tolerance.  Returns false if the derivative is zero, a step is not a
+		// number, or the steps have not converged after in_max_iterations, so the caller can
+		// fall back to a bracketed search.
+		template <class FUNCTION_T>
+		bool	PolishRoot(RESULT_T in_estimate, FUNCTION_T&& in_function, bool in_use_halley,
+							long in_max_iterations, RESULT_T& out_root) {
+
+			RESULT_T	estimate_tolerance = GetEstimateTolerance();
+			RESULT_T	result_tolerance = 0.000000001;
+
+			RESULT_T	estimate = in_estimate;
+
+			evaluations_ = 0;
+			iterations_ = 0;
+
+			for (long count = 0; count <= in_max_iterations; count++)
+			{
+				Derivatives<RESULT_T>	current = (in_function)(estimate);
+				evaluations_++;
+
+				Trace(count, (in_use_halley ? methods_available::halley : methods_available::newton),
+						estimate, current.value_, current.first_, current.second_);
+
+				if (std::abs(current.value_) < result_tolerance)
+				{
+					out_root = estimate;
+					return true;
+				}
+
+				if ((count == in_max_iterations) || (current.first_ == 0.0))
+				{
+					break;
+				}
+
+				RESULT_T	step = current.value_ / current.first_;
+
+				if (in_use_halley)
+				{
+					RESULT_T	denominator = (2.0 * current.first_ * current.first_) - (current.value_ * current.second_);
+
+					if (denominator != 0.0)
+					{
+						step = (2.0 * current.value_ * current.first_) / denominator;
+					}
+				}
+
+				if (!std::isfinite(step))
+				{
+					break;
+				}
+
+				estimate -= step;
+				iterations_ = count + 1;
+
+				LOG_IF_LOGGED(calc_log, debug) << iterations_ << "     "
+					<< std::fixed << std::setw(15) << std::setprecision(6) << estimate << "   "
+					<< std::fixed << std::setw(15) << std::setprecision(6) << current.value_ << "   polish method";
+
+				if (std::abs(step) < estimate_tolerance)
+				{
+					out_root = estimate;
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		private:
+
+		//----------------------------------------------------------------------------------
+		// Search using Brent's method given the results at the two estimates.
+		template <class FUNCTION_T>
+		RESULT_T	SearchForRootFrom(RESULT_T in_best_estimate, RESULT_T in_best_result,
+										RESULT_T in_counter_estimate, RESULT_T in_counter_result,
+										FUNCTION_T& in_function, long in_evaluations) {
 
 			static const	int	kBest = 3; // best
 			static const	int	kCounter = 2; // counter
@@ -101,7 +559,7 @@ namespace roots {
 			RESULT_T	parabolic_result[4] = { 0.0, 0.0, 0.0, 0.0 };
 			RESULT_T	step_size = 0.0;
 
-			RESULT_T	estimate_tolerance = 0.000000001;
+			RESULT_T	estimate_tolerance = GetEstimateTolerance();
 			RESULT_T	result_tolerance = 0.000000001;
 
 			// Discount the cash fcounters based on the counter and curr estimates.
@@ -111,8 +569,10 @@ namespace roots {
 			estimate[kMinus1] = estimate[kCounter];
 			estimate[kMinus2] = 0.0;
 
-			result[kBest] = (in_function)(estimate[kBest]);		//f(b);
-			result[kCounter] = (in_function)(estimate[kCounter]); //f(a)
+			result[kBest] = in_best_result;		//f(b);
+			result[kCounter] = in_counter_result; //f(a)
+			evaluations_ = in_evaluations;
+			iterations_ = 0;
 			result[kMinus1] = result[kCounter];
 			result[kMinus2] = result[kCounter];
 
@@ -124,6 +584,18 @@ namespace roots {
 			
 			methods_available	method_to_use = methods_available::unknown;
 
+			// If either estimate is already the solution there is nothing to search for.
+
+			if (result[kBest] == 0)
+			{
+				return estimate[kBest];
+			}
+
+			if (result[kCounter] == 0)
+			{
+				return estimate[kCounter];
+			}
+
 			// The solution is not between the counter and curr estimates so the root
 			// would not be found.
 
@@ -150,22 +622,22 @@ namespace roots {
 
 			estimate[kMinus1] = estimate[kCounter];
 
-			calc_log.log(debug) << "Count        CurrEstimate   NPV                  CounterEstimate    NPV            Method";
-			calc_log.log(debug) << "-----        ------------   ---                  ---------------    ---            ------";
-			calc_log.log(debug) << count << "     "
+			LOG_IF_LOGGED(calc_log, debug) << "Count        CurrEstimate   NPV                  CounterEstimate    NPV            Method";
+			LOG_IF_LOGGED(calc_log, debug) << "-----        ------------   ---                  ---------------    ---            ------";
+			LOG_IF_LOGGED(calc_log, debug) << count << "     "
 				<< std::fixed << std::setw(15) << std::setprecision(6) << estimate[kBest] << "   "
 				<< std::fixed << std::setw(15) << std::setprecision(6) << result[kBest] << "   "
 				<< std::fixed << std::setw(15) << std::setprecision(6) << estimate[kCounter] << "        "
 				<< std::fixed << std::setw(15) << std::setprecision(6) << result[kCounter];
 
+			Trace(count, methods_available::unknown, estimate[kBest], result[kBest], estimate[kCounter], result[kCounter]);
+
 			// Include a safety condition to prevent excessive looping.
 
 			while (count < kMaxIterations)
 			{
 				count++;
 
-				LogEntry	log_entry(debug);
-
 				// Prefer using the inverse quadratic interpolation over the secant method
 				// (linear interpolation) because it is slightly more efficient and producing
 				// an accurate estimate despite increased calculation complexity.
@@ -224,6 +696,8 @@ namespace roots {
 				// Calculate the result of the function given the new estimate for a solution.
 
 				new_result = (in_function)(new_estimate);
+				evaluations_++;
+				iterations_ = count;
 
 				estimate[kMinus2] = estimate[kMinus1];
 				result[kMinus2] = result[kMinus1];
@@ -255,31 +729,42 @@ namespace roots {
 					std::swap(result[kBest], result[kCounter]);
 				}
 
-				// Debug messages
+				Trace(count, method_to_use, estimate[kBest], result[kBest], estimate[kCounter], result[kCounter]);
 
-				log_entry << count << "     "
-					<< std::fixed << std::setw(15) << std::setprecision(6) << estimate[kBest] << "   "
-					<< std::fixed << std::setw(15) << std::setprecision(6) << result[kBest] << "   "
-					<< std::fixed << std::setw(15) << std::setprecision(6) << estimate[kCounter] << "        "
-					<< std::fixed << std::setw(15) << std::setprecision(6) << result[kCounter];
+				// Debug messages.  Only format them if they will be logged.
 
-				switch (method_to_use)
+				if (calc_log.IsLogged(debug))
 				{
-				case methods_available::quadratic_interpolation:
-					log_entry << "   quadratic_interpolation_estimate method";
-					break;
-				case methods_available::secant:
-					log_entry << "   secant method";
-					break;
-				case methods_available::bisection:
-					log_entry << "   bisection method";
-					break;
-				case methods_available::unknown:
-					log_entry << "   unknown method";
-					break;
+					LogEntry&	log_entry = calc_log.log(debug);
+
+					log_entry << count << "     "
+						<< std::fixed << std::setw(15) << std::setprecision(6) << estimate[kBest] << "   "
+						<< std::fixed << std::setw(15) << std::setprecision(6) << result[kBest] << "   "
+						<< std::fixed << std::setw(15) << std::setprecision(6) << estimate[kCounter] << "        "
+						<< std::fixed << std::setw(15) << std::setprecision(6) << result[kCounter];
+
+					switch (method_to_use)
+					{
+					case methods_available::quadratic_interpolation:
+						log_entry << "   quadratic_interpolation_estimate method";
+						break;
+					case methods_available::secant:
+						log_entry << "   secant method";
+						break;
+					case methods_available::bisection:
+						log_entry << "   bisection method";
+						break;
+					case methods_available::newton:
+						log_entry << "   newton method";
+						break;
+					case methods_available::halley:
+						log_entry << "   halley method";
+						break;
+					case methods_available::unknown:
+						log_entry << "   unknown method";
+						break;
+					}
 				}
-				
-				calc_log.log(log_entry);
 				//cout << calc_log.flush();
 
 				// Stop the loop if the estimates are no longer changing by more than 
@@ -302,8 +787,160 @@ namespace roots {
 			return estimate[kBest];
 		}
 
+		//----------------------------------------------------------------------------------
+		// Search using Newton or Halley steps given the derivatives at the best estimate
+		// and the result at the counter estimate.
+		template <class FUNCTION_T>
+		RESULT_T	SearchForRootNewtonFrom(RESULT_T in_best_estimate, const Derivatives<RESULT_T>& in_best,
+											RESULT_T in_counter_estimate, const Derivatives<RESULT_T>& in_counter,
+											FUNCTION_T& in_function, bool in_use_halley, long in_evaluations) {
+
+			RESULT_T	estimate_tolerance = GetEstimateTolerance();
+			RESULT_T	result_tolerance = 0.000000001;
+
+			static	const	long	kMaxIterations = 100;
+
+			const Derivatives<RESULT_T>&	best = in_best;
+			const Derivatives<RESULT_T>&	counter = in_counter;
+
+			evaluations_ = in_evaluations;
+			iterations_ = 0;
+
+			if (best.value_ == 0)
+			{
+				return in_best_estimate;
+			}
+
+			if (counter.value_ == 0)
+			{
+				return in_counter_estimate;
+			}
+
+			if ((best.value_ * counter.value_) >= 0)
+			{
+				if (best.value_ < 0)
+				{
+					throw RangeException("Results are below the solution.", RangeException::relative_to_solution_e::too_low);
+				}
+				else
+				{
+					throw RangeException("Results are above the solution.", RangeException::relative_to_solution_e::too_high);
+				}
+			}
+
+			// Keep the end of the bracket where the result is below zero and the end where
+			// it is above zero.
+
+			RESULT_T	low_end = (best.value_ < 0) ? in_best_estimate : in_counter_estimate;
+			RESULT_T	high_end = (best.value_ < 0) ? in_counter_estimate : in_best_estimate;
+
+			RESULT_T				estimate = in_best_estimate;
+			Derivatives<RESULT_T>	current = best;
+
+			if (std::abs(counter.value_) < std::abs(best.value_))
+			{
+				estimate = in_counter_estimate;
+				current = counter;
+			}
+
+			RESULT_T	step_size = std::abs(high_end - low_end);
+			RESULT_T	prev_step_size = step_size;
+
+			LOG_IF_LOGGED(calc_log, debug) << "Count        Estimate       NPV                  dNPV               Method";
+			LOG_IF_LOGGED(calc_log, debug) << "-----        --------       ---                  ----               ------";
+
+			Trace(0, methods_available::unknown, estimate, current.value_, current.first_, current.second_);
+
+			for (long count = 1; count <= kMaxIterations; count++)
+			{
+				methods_available	method_to_use = (in_use_halley ? methods_available::halley : methods_available::newton);
+				RESULT_T			new_estimate = estimate;
+				RESULT_T			step = 0.0;
+
+				if (current.first_ != 0.0)
+				{
+					step = current.value_ / current.first_;
+
+					if (in_use_halley)
+					{
+						RESULT_T	denominator = (2.0 * current.first_ * current.first_) - (current.value_ * current.second_);
+
+						if (denominator != 0.0)
+						{
+							step = (2.0 * current.value_ * current.first_) / denominator;
+						}
+					}
+
+					new_estimate = estimate - step;
+				}
+
+				RESULT_T	bracket_min = std::min(low_end, high_end);
+				RESULT_T	bracket_max = std::max(low_end, high_end);
+
+				// Fall back to bisection if the step leaves the bracket, is not a number, or
+				// has not halved over the last two steps.
+
+				if ((current.first_ == 0.0) || !(new_estimate > bracket_min) || !(new_estimate < bracket_max) ||
+					(std::abs(2.0 * step) > prev_step_size))
+				{
+					new_estimate = (low_end + high_end) / 2.0;
+					method_to_use = methods_available::bisection;
+				}
+
+				prev_step_size = step_size;
+				step_size = std::abs(new_estimate - estimate);
+
+				estimate = new_estimate;
+				current = (in_function)(estimate);
+				evaluations_++;
+				iterations_ = count;
+
+				if (current.value_ < 0)
+				{
+					low_end = estimate;
+				}
+				else
+				{
+					high_end = estimate;
+				}
+
+				Trace(count, method_to_use, estimate, current.value_, current.first_, current.second_);
+
+				LOG_IF_LOGGED(calc_log, debug) << count << "     "
+					<< std::fixed << std::setw(15) << std::setprecision(6) << estimate << "   "
+					<< std::fixed << std::setw(15) << std::setprecision(6) << current.value_ << "   "
+					<< std::fixed << std::setw(15) << std::setprecision(6) << current.first_ << "   "
+					<< ((method_to_use == methods_available::bisection) ? "bisection method" :
+						((method_to_use == methods_available::halley) ? "halley method" : "newton method"));
+
+				if ((step_size < estimate_tolerance) || (std::abs(current.value_) < result_tolerance) ||
+					(std::abs(high_end - low_end) < estimate_tolerance))
+				{
+					break;
+				}
+			}
+
+			return estimate;
+		}
+
 		private:
 
+			long	iterations_ = 0;
+			long	evaluations_ = 0;
+
+			//----------------------------------------------------------------------------------
+			// Record a step of the search if a trace is set.
+			void	Trace(long in_iteration, methods_available in_method, const RESULT_T& in_estimate,
+							const RESULT_T& in_result, const RESULT_T& in_counter_estimate,
+							const RESULT_T& in_counter_result)
+			{
+				if (trace_ != nullptr)
+				{
+					trace_->Record(in_iteration, in_method, static_cast<double>(in_estimate), static_cast<double>(in_result),
+									static_cast<double>(in_counter_estimate), static_cast<double>(in_counter_result));
+				}
+			}
+
 			//----------------------------------------------------------------------------------
 			// Return the point at which a secant of an arc crosses the x-axis when it
 			// contains two of the function points.
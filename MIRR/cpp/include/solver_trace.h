@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------
+// Provide capabilities to find solutions/roots for equations.
+
+namespace roots {
+
+	//----------------------------------------------------------------------------------
+	// One step of a search for a root stored as plain values so it can be recorded
+	// without allocating or formatting anything.  The method is a value of
+	// RootFinder::methods_available.  Newton and Halley steps record the first and
+	// second derivatives in place of the counter estimate and its result.
+	struct TraceRecord {
+		std::int32_t	iteration_ = 0;
+		std::int32_t	method_ = 0;
+		double			estimate_ = 0.0;
+		double			result_ = 0.0;
+		double			counter_estimate_ = 0.0;
+		double			counter_result_ = 0.0;
+	};
+
+	//----------------------------------------------------------------------------------
+	// A ring of trace records allocated once.  When it is full the oldest records are
+	// overwritten so the end of a long search is kept.  The records are only formatted
+	// as text when asked for (e.g. after a search fails), so tracing can be left on.
+	// A trace with no capacity is disabled and records nothing.
+	class SolverTrace {
+	public:
+		SolverTrace(std::size_t in_capacity = 0);
+
+		// Allocate room for a number of records and clear the trace.  Zero disables it.
+		void	Reserve(std::size_t in_capacity);
+
+		bool	IsEnabled() const { return !records_.empty(); }
+
+		// Add a record, overwriting the oldest if the trace is full.
+		void	Record(long in_iteration, int in_method, double in_estimate, double in_result,
+						double in_counter_estimate, double in_counter_result)
+		{
+			if (records_.empty())
+			{
+				return;
+			}
+
+			TraceRecord&	record = records_[next_];
+
+			record.iteration_ = static_cast<std::int32_t>(in_iteration);
+			record.method_ = static_cast<std::int32_t>(in_method);
+			record.estimate_ = in_estimate;
+			record.result_ = in_result;
+			record.counter_estimate_ = in_counter_estimate;
+			record.counter_result_ = in_counter_result;
+
+			next_ = (next_ + 1 == records_.size()) ? 0 : next_ + 1;
+			recorded_++;
+		}
+
+		// Remove the records without releasing their memory.
+		void	clear() { next_ = 0; recorded_ = 0; }
+
+		// Return the number of records held and the record at an index, oldest first.
+		std::size_t			size() const;
+		const TraceRecord&	at(std::size_t in_index) const;
+
+		// Return the number of records overwritten because the trace was full.
+		std::size_t	GetDropped() const { return recorded_ - size(); }
+
+		// Write the records as text in the same layout as the search's debug log.
+		void		Format(std::ostream& io_output) const;
+		std::string	ToString() const;
+
+		// Return the name of a RootFinder::methods_available value.
+		static const char*	MethodName(int in_method);
+
+	private:
+		// Properties
+
+		std::vector<TraceRecord>	records_;
+		std::size_t					next_ = 0; // Index the next record is written to.
+		std::size_t					recorded_ = 0; // Records written since cleared.
+	};
+
+	// Print the trace records to the output stream.
+	std::ostream& operator<<(std::ostream& output, const SolverTrace& in_trace);
+}
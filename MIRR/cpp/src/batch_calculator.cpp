@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <thread>
+
+#include "batch_calculator.h"
+
+namespace mirr {
+
+	//----------------------------------------------------------------------------------
+	// Constructor
+	BatchCalculator::BatchCalculator(unsigned in_thread_count)
+	{
+		SetThreadCount(in_thread_count);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Set the number of worker threads.  Zero uses one thread per hardware core.
+	void	BatchCalculator::SetThreadCount(unsigned in_thread_count)
+	{
+		thread_count_ = in_thread_count;
+
+		if (thread_count_ == 0)
+		{
+			thread_count_ = std::max(1u, std::thread::hardware_concurrency());
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	// Search for the rate of each of the cash flow lists.
+	std::vector<BatchResult>	BatchCalculator::GetRates(CashFlowList* in_cash_flows, std::size_t in_count)
+	{
+		return Solve(in_count,
+			[in_cash_flows](Calculator& io_calculator, std::size_t in_index) { return io_calculator.GetRate(in_cash_flows[in_index]); });
+	}
+
+	std::vector<BatchResult>	BatchCalculator::GetRates(std::vector<CashFlowList>& in_cash_flows)
+	{
+		return GetRates(in_cash_flows.data(), in_cash_flows.size());
+	}
+
+	//----------------------------------------------------------------------------------
+	// Search for the rate of each account in a portfolio.
+	std::vector<BatchResult>	BatchCalculator::GetRates(const Portfolio& in_portfolio)
+	{
+		return Solve(in_portfolio.size(),
+			[&in_portfolio](Calculator& io_calculator, std::size_t in_index) { return io_calculator.GetRate(in_portfolio.GetView(in_index)); });
+	}
+
+	//----------------------------------------------------------------------------------
+	// Spread the searches over the workers.  The series are claimed by the workers a
+	// chunk at a time so that a few long series do not leave the other workers idle at
+	// the end of the batch.
+	template <class GET_RATE_T>
+	std::vector<BatchResult>	BatchCalculator::Solve(std::size_t in_count, const GET_RATE_T& in_get_rate)
+	{
+		std::vector<BatchResult>	results(in_count);
+		std::atomic<std::size_t>	next_index(0);
+
+		if (in_count == 0)
+		{
+			return results;
+		}
+
+		// A chunk size of 0 is treated as 1 without changing the setting.
+
+		std::size_t	chunk_size = std::max<std::size_t>(chunk_size_, 1);
+		std::size_t	chunk_count = ((in_count + chunk_size - 1) / chunk_size);
+		unsigned	worker_count = static_cast<unsigned>(std::min<std::size_t>(thread_count_, chunk_count));
+
+		// The calling thread acts as the last worker rather than waiting idle.
+
+		std::vector<std::thread>	workers;
+		workers.reserve(worker_count - 1);
+
+		// If a thread cannot be started, the workers already running must be joined before
+		// they are destroyed (destroying a joinable thread calls std::terminate()).
+
+		try
+		{
+			for (unsigned i = 1; i < worker_count; i++)
+			{
+				workers.push_back(std::thread(&BatchCalculator::SolveChunks<GET_RATE_T>, this,
+									std::ref(next_index), in_count, chunk_size, std::cref(in_get_rate), results.data()));
+			}
+		}
+		catch (...)
+		{
+			for (std::thread& worker : workers)
+			{
+				worker.join();
+			}
+
+			throw;
+		}
+
+		SolveChunks(next_index, in_count, chunk_size, in_get_rate, results.data());
+
+		for (std::thread& worker : workers)
+		{
+			worker.join();
+		}
+
+		return results;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Search for the rates of the series claimed by one worker until none are left.  Any
+	// error raised while searching is recorded against that series only.
+	template <class GET_RATE_T>
+	void	BatchCalculator::SolveChunks(std::atomic<std::size_t>& io_next_index, std::size_t in_count, std::size_t in_chunk_size,
+											const GET_RATE_T& in_get_rate, BatchResult* out_results)
+	{
+		Calculator	calculator;
+		calculator.print_log_ = (log_sink_ != nullptr);
+		calculator.log_sink_ = log_sink_;
+		calculator.options_ = options_;
+		calculator.trace_.Reserve((log_sink_ != nullptr) ? trace_capacity_ : 0);
+
+		while (true)
+		{
+			std::size_t	first = io_next_index.fetch_add(in_chunk_size);
+
+			if (first >= in_count)
+			{
+				break;
+			}
+
+			std::size_t	last = std::min(first + in_chunk_size, in_count);
+
+			for (std::size_t i = first; i < last; i++)
+			{
+				BatchResult&	result = out_results[i];
+
+				auto	start = std::chrono::steady_clock::now();
+
+				try
+				{
+					calculator.calc_log.clear();
+					result.rate_ = in_get_rate(calculator, i);
+					result.status_ = calculator.GetStatus();
+					result.iterations_ = static_cast<std::int32_t>(calculator.GetIterations());
+					result.evaluations_ = static_cast<std::int32_t>(calculator.GetEvaluations());
+					result.residual_ = static_cast<double>(calculator.GetResidual());
+				}
+				catch (std::exception&)
+				{
+					result.rate_ = 0.0;
+					result.status_ = solve_status_e::failed;
+				}
+
+				result.nanoseconds_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+											std::chrono::steady_clock::now() - start).count();
+
+				// The trace is only formatted for the searches that were not solved.
+
+				if ((result.status_ != solve_status_e::solved) && calculator.trace_.IsEnabled())
+				{
+					std::ostringstream	text;
+
+					text << "Series " << i << " " << SolveStatusName(result.status_) << " after "
+						<< calculator.trace_.size() + calculator.trace_.GetDropped() << " steps" << std::endl;
+					calculator.trace_.Format(text);
+
+					log_sink_->Write(text.str());
+				}
+			}
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	// Summarize the results of a batch.  The percentiles are the nearest rank in the
+	// sorted times.
+	BatchStats	CalculateBatchStats(const std::vector<BatchResult>& in_results, double in_seconds)
+	{
+		BatchStats					stats;
+		std::vector<std::int64_t>	nanoseconds;
+		double						evaluations = 0.0;
+
+		stats.count_ = in_results.size();
+		stats.seconds_ = in_seconds;
+		nanoseconds.reserve(in_results.size());
+
+		for (const BatchResult& result : in_results)
+		{
+			switch (result.status_)
+			{
+			case solve_status_e::solved:
+				stats.solved_++;
+				break;
+			case solve_status_e::not_bracketed:
+				stats.not_bracketed_++;
+				break;
+			default:
+				stats.failed_++;
+				break;
+			}
+
+			evaluations += result.evaluations_;
+			nanoseconds.push_back(result.nanoseconds_);
+
+			if (std::isfinite(result.residual_))
+			{
+				stats.max_residual_ = std::max(stats.max_residual_, std::abs(result.residual_));
+			}
+		}
+
+		if (nanoseconds.empty())
+		{
+			return stats;
+		}
+
+		std::sort(nanoseconds.begin(), nanoseconds.end());
+
+		auto	percentile = [&nanoseconds](double in_fraction) {
+			std::size_t	rank = static_cast<std::size_t>(std::ceil(in_fraction * nanoseconds.size()));
+			return nanoseconds[(rank > 0) ? rank - 1 : 0];
+		};
+
+		stats.per_second_ = (in_seconds > 0.0) ? (stats.count_ / in_seconds) : 0.0;
+		stats.mean_evaluations_ = evaluations / stats.count_;
+		stats.p50_nanoseconds_ = percentile(0.50);
+		stats.p90_nanoseconds_ = percentile(0.90);
+		stats.p99_nanoseconds_ = percentile(0.99);
+		stats.p999_nanoseconds_ = percentile(0.999);
+		stats.max_nanoseconds_ = nanoseconds.back();
+
+		return stats;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return the name of a search's outcome for reporting.
+	const char*	SolveStatusName(solve_status_e in_status)
+	{
+		switch (in_status)
+		{
+		case solve_status_e::solved:
+			return "solved";
+		case solve_status_e::not_bracketed:
+			return "not_bracketed";
+		case solve_status_e::failed:
+			return "failed";
+		}
+
+		return "unknown";
+	}
+
+};
@@ -0,0 +1,243 @@
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+#include "cash_flow_file.h"
+#include "mapped_file.h"
+
+namespace mirr {
+
+	static const char			kMagic[8] = { 'M', 'I', 'R', 'R', 'C', 'F', 'C', '\0' };
+	static const std::uint32_t	kVersion = 1;
+	static const std::uint32_t	kByteOrder = 0x01020304;
+	static const std::uint64_t	kSectionAlignment = 64;
+
+	//----------------------------------------------------------------------------------
+	// Return a checksum of a block of bytes.  Each eight byte word is mixed into the
+	// checksum with a multiply and rotate; any bytes left over are mixed in as a final
+	// partial word.
+	std::uint64_t	CalculateChecksum(const void* in_data, std::size_t in_size)
+	{
+		static const std::uint64_t	kPrime = 0x9E3779B185EBCA87ULL;
+
+		const unsigned char*	data = static_cast<const unsigned char*>(in_data);
+		std::uint64_t			checksum = 0xCBF29CE484222325ULL ^ in_size;
+		std::size_t				i = 0;
+
+		for (; i + 8 <= in_size; i += 8)
+		{
+			std::uint64_t	word;
+
+			std::memcpy(&word, data + i, sizeof(word));
+			checksum = ((checksum ^ (word * kPrime)) << 31 | (checksum ^ (word * kPrime)) >> 33) * kPrime;
+		}
+
+		if (i < in_size)
+		{
+			std::uint64_t	word = 0;
+
+			std::memcpy(&word, data + i, in_size - i);
+			checksum = ((checksum ^ (word * kPrime)) << 31 | (checksum ^ (word * kPrime)) >> 33) * kPrime;
+		}
+
+		return checksum ^ (checksum >> 29);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return the size in bytes of each section of a file.
+	static void	GetSectionSizes(const CashFlowFileHeader& in_header, std::uint64_t* out_sizes)
+	{
+		out_sizes[CashFlowFileHeader::offsets] = (in_header.account_count_ + 1) * sizeof(std::uint64_t);
+		out_sizes[CashFlowFileHeader::id_offsets] = (in_header.account_count_ + 1) * sizeof(std::uint64_t);
+		out_sizes[CashFlowFileHeader::start_dates] = in_header.account_count_ * sizeof(dates::Date_t);
+		out_sizes[CashFlowFileHeader::days] = in_header.cash_flow_count_ * sizeof(Day_t);
+		out_sizes[CashFlowFileHeader::amounts] = in_header.cash_flow_count_ * sizeof(double);
+		out_sizes[CashFlowFileHeader::ids] = in_header.ids_size_;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Write a portfolio to a binary cash flow file.  The sections are laid out after the
+	// header, each padded to the alignment, and the header is written with them.
+	file_status_e	WriteCashFlowsBinary(const std::string& in_path, const Portfolio& in_portfolio)
+	{
+		const PortfolioColumns&	columns = in_portfolio.GetColumns();
+		CashFlowFileHeader		header;
+		std::uint64_t			sizes[CashFlowFileHeader::section_count];
+		std::uint64_t			zero_offset = 0;
+
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic_, kMagic, sizeof(kMagic));
+		header.version_ = kVersion;
+		header.byte_order_ = kByteOrder;
+		header.account_count_ = in_portfolio.size();
+		header.cash_flow_count_ = in_portfolio.GetCashFlowCount();
+		header.ids_size_ = (in_portfolio.size() > 0) ? columns.id_offsets_[in_portfolio.size()] : 0;
+
+		// An empty portfolio has no offsets columns so write the single zero offset.
+
+		const void*	sections[CashFlowFileHeader::section_count] = {
+			(in_portfolio.size() > 0) ? static_cast<const void*>(columns.offsets_) : &zero_offset,
+			(in_portfolio.size() > 0) ? static_cast<const void*>(columns.id_offsets_) : &zero_offset,
+			columns.start_dates_, columns.days_, columns.amounts_, columns.ids_
+		};
+
+		GetSectionSizes(header, sizes);
+
+		std::uint64_t	position = ((sizeof(header) + kSectionAlignment - 1) / kSectionAlignment) * kSectionAlignment;
+
+		for (int s = 0; s < CashFlowFileHeader::section_count; s++)
+		{
+			header.positions_[s] = position;
+			header.checksums_[s] = CalculateChecksum(sections[s], static_cast<std::size_t>(sizes[s]));
+			position += ((sizes[s] + kSectionAlignment - 1) / kSectionAlignment) * kSectionAlignment;
+		}
+
+		header.header_checksum_ = CalculateChecksum(&header, offsetof(CashFlowFileHeader, header_checksum_));
+
+		std::ofstream	file(in_path, std::ios::binary | std::ios::trunc);
+
+		if (!file)
+		{
+			return file_status_e::file_not_opened;
+		}
+
+		static const char	kPadding[kSectionAlignment] = {};
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(kPadding, static_cast<std::streamsize>(header.positions_[0] - sizeof(header)));
+
+		for (int s = 0; s < CashFlowFileHeader::section_count; s++)
+		{
+			std::uint64_t	padding = ((sizes[s] + kSectionAlignment - 1) / kSectionAlignment) * kSectionAlignment - sizes[s];
+
+			file.write(static_cast<const char*>(sections[s]), static_cast<std::streamsize>(sizes[s]));
+			file.write(kPadding, static_cast<std::streamsize>(padding));
+		}
+
+		file.close();
+
+		return file ? file_status_e::file_ok : file_status_e::file_write_failed;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Check that a column of offsets starts at zero, never decreases and ends at the
+	// size of the column it indexes, so every account's view is inside the file.
+	static bool	CheckOffsets(const std::uint64_t* in_offsets, std::uint64_t in_count, std::uint64_t in_total)
+	{
+		if (in_offsets[0] != 0)
+		{
+			return false;
+		}
+
+		for (std::uint64_t i = 0; i < in_count; i++)
+		{
+			if (in_offsets[i + 1] < in_offsets[i])
+			{
+				return false;
+			}
+		}
+
+		return (in_offsets[in_count] == in_total);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Map a binary cash flow file and attach the portfolio to its columns.
+	file_status_e	ReadCashFlowsBinary(const std::string& in_path, Portfolio& out_portfolio, bool in_verify_data)
+	{
+		std::shared_ptr<MappedFile>	file = std::make_shared<MappedFile>();
+
+		if (!file->Open(in_path))
+		{
+			return file_status_e::file_not_opened;
+		}
+
+		CashFlowFileHeader	header;
+
+		if (file->size() < sizeof(header))
+		{
+			return file_status_e::file_bad_header;
+		}
+
+		std::memcpy(&header, file->data(), sizeof(header));
+
+		if ((std::memcmp(header.magic_, kMagic, sizeof(kMagic)) != 0) || (header.version_ != kVersion) ||
+			(header.byte_order_ != kByteOrder) ||
+			(header.header_checksum_ != CalculateChecksum(&header, offsetof(CashFlowFileHeader, header_checksum_))))
+		{
+			return file_status_e::file_bad_header;
+		}
+
+		// Check the counts against the size of the file before they are multiplied by the
+		// size of their elements, so that the section sizes of a header with huge counts
+		// cannot wrap around to small ones.  The header checksum only detects damage.
+
+		if ((header.account_count_ >= file->size() / sizeof(std::uint64_t)) ||
+			(header.cash_flow_count_ > file->size() / sizeof(double)) || (header.ids_size_ > file->size()))
+		{
+			return file_status_e::file_bad_layout;
+		}
+
+		std::uint64_t	sizes[CashFlowFileHeader::section_count];
+
+		GetSectionSizes(header, sizes);
+
+		for (int s = 0; s < CashFlowFileHeader::section_count; s++)
+		{
+			if (((header.positions_[s] % kSectionAlignment) != 0) || (header.positions_[s] > file->size()) ||
+				(sizes[s] > file->size() - header.positions_[s]))
+			{
+				return file_status_e::file_bad_layout;
+			}
+
+			if (in_verify_data &&
+				(CalculateChecksum(file->data() + header.positions_[s], static_cast<std::size_t>(sizes[s])) != header.checksums_[s]))
+			{
+				return file_status_e::file_bad_checksum;
+			}
+		}
+
+		PortfolioColumns	columns;
+
+		columns.offsets_ = reinterpret_cast<const std::uint64_t*>(file->data() + header.positions_[CashFlowFileHeader::offsets]);
+		columns.id_offsets_ = reinterpret_cast<const std::uint64_t*>(file->data() + header.positions_[CashFlowFileHeader::id_offsets]);
+		columns.start_dates_ = reinterpret_cast<const dates::Date_t*>(file->data() + header.positions_[CashFlowFileHeader::start_dates]);
+		columns.days_ = reinterpret_cast<const Day_t*>(file->data() + header.positions_[CashFlowFileHeader::days]);
+		columns.amounts_ = reinterpret_cast<const double*>(file->data() + header.positions_[CashFlowFileHeader::amounts]);
+		columns.ids_ = file->data() + header.positions_[CashFlowFileHeader::ids];
+		columns.account_count_ = static_cast<std::size_t>(header.account_count_);
+
+		if (!CheckOffsets(columns.offsets_, header.account_count_, header.cash_flow_count_) ||
+			!CheckOffsets(columns.id_offsets_, header.account_count_, header.ids_size_))
+		{
+			return file_status_e::file_bad_layout;
+		}
+
+		out_portfolio.Attach(columns, file);
+
+		return file_status_e::file_ok;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return a description of the outcome of writing or reading a file.
+	const char*	FileStatusName(file_status_e in_status)
+	{
+		switch (in_status)
+		{
+		case file_status_e::file_ok:
+			return "ok";
+		case file_status_e::file_not_opened:
+			return "could not be opened";
+		case file_status_e::file_bad_header:
+			return "not a cash flow file of this version";
+		case file_status_e::file_bad_layout:
+			return "sections do not fit in the file";
+		case file_status_e::file_bad_checksum:
+			return "checksum is wrong";
+		case file_status_e::file_write_failed:
+			return "could not be written";
+		}
+
+		return "unknown";
+	}
+
+};
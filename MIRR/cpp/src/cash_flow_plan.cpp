@@ -0,0 +1,580 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+
+#include "cash_flow_plan.h"
+#include "npv_kernels.h"
+#include "roots.h"
+
+namespace mirr {
+
+	// The most distinct gaps between cash flows that the discounts can be walked with
+	// and the number of discounts walked from each one calculated with exp().
+	static const std::size_t	kMaxDiscountGaps = 64;
+	static const std::size_t	kDiscountAnchorInterval = 64;
+
+	//----------------------------------------------------------------------------------
+	// Constructors
+	CashFlowPlan::CashFlowPlan(const CashFlowList& in_cash_flows, compounding_e in_compounding)
+		: compounding_(in_compounding)
+	{
+		CashFlowColumns				columns(in_cash_flows);
+		std::vector<std::size_t>	periods;
+
+		Compile(columns.GetDays().data(), columns.GetAmounts().data(), columns.size());
+		CompilePeriodic(in_cash_flows.FindMonthlyGrid(periods), periods, columns.GetAmounts().data());
+	}
+
+	CashFlowPlan::CashFlowPlan(const CashFlowView& in_cash_flows, compounding_e in_compounding)
+		: compounding_(in_compounding)
+	{
+		std::vector<std::size_t>	periods;
+		int							grid_months = in_cash_flows.FindMonthlyGrid(periods);
+
+		if (in_cash_flows.amounts_ != nullptr)
+		{
+			Compile(in_cash_flows.days_, in_cash_flows.amounts_, in_cash_flows.size());
+			CompilePeriodic(grid_months, periods, in_cash_flows.amounts_);
+		}
+		else
+		{
+			Compile(in_cash_flows.days_, in_cash_flows.amounts_double_, in_cash_flows.size());
+			CompilePeriodic(grid_months, periods, in_cash_flows.amounts_double_);
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	// Sum the amounts in each period of the grid.  The periods are in the same order as
+	// the amounts.
+	template <class AMOUNT_T>
+	void	CashFlowPlan::CompilePeriodic(int in_grid_months, const std::vector<std::size_t>& in_periods, const AMOUNT_T* in_amounts)
+	{
+		grid_months_ = in_grid_months;
+
+		if (grid_months_ > 0)
+		{
+			periodic_amounts_.assign(*std::max_element(in_periods.begin(), in_periods.end()) + 1, 0.0);
+
+			for (std::size_t i = 0; i < in_periods.size(); i++)
+			{
+				periodic_amounts_[in_periods[i]] += in_amounts[i];
+			}
+
+			periodic_amounts_double_.assign(periodic_amounts_.begin(), periodic_amounts_.end());
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	// Build the plan from columns of days and amounts in any order.  The cash flows are
+	// sorted by date so the signs can be counted in order; cash flows on the same day
+	// keep their original order.
+	template <class AMOUNT_T>
+	void	CashFlowPlan::Compile(const Day_t* in_days, const AMOUNT_T* in_amounts, std::size_t in_count)
+	{
+		std::vector<std::size_t>	order(in_count);
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(),
+			[in_days](std::size_t in_lhs, std::size_t in_rhs) { return in_days[in_lhs] < in_days[in_rhs]; });
+
+		days_in_range_ = 0;
+
+		if (in_count > 0)
+		{
+			days_in_range_ = in_days[order.back()] - in_days[order.front()];
+		}
+
+		days_.resize(in_count);
+		exponents_.resize(in_count);
+		amounts_.resize(in_count);
+		exponents_double_.resize(in_count);
+		amounts_double_.resize(in_count);
+
+		positive_count_ = 0;
+		negative_count_ = 0;
+		sign_changes_ = 0;
+		sum_amounts_ = 0.0;
+		sum_weighted_amounts_ = 0.0;
+
+		int	prev_sign = 0;
+
+		for (std::size_t i = 0; i < in_count; i++)
+		{
+			std::size_t	from = order[i];
+
+			days_[i] = in_days[from] - in_days[order.front()];
+			exponents_[i] = CalculateExponent(days_[i]);
+			amounts_[i] = static_cast<CashFlowAmt_t>(in_amounts[from]);
+
+			exponents_double_[i] = static_cast<double>(exponents_[i]);
+			amounts_double_[i] = static_cast<double>(amounts_[i]);
+
+			sum_amounts_ += amounts_[i];
+			sum_weighted_amounts_ += exponents_[i] * amounts_[i];
+
+			// Count the signs ignoring any zero amounts.
+
+			int	sign = (amounts_[i] > 0) ? 1 : ((amounts_[i] < 0) ? -1 : 0);
+
+			if (sign > 0)
+			{
+				positive_count_++;
+			}
+			else if (sign < 0)
+			{
+				negative_count_++;
+			}
+
+			if (sign != 0)
+			{
+				if ((prev_sign != 0) && (sign != prev_sign))
+				{
+					sign_changes_++;
+				}
+				prev_sign = sign;
+			}
+		}
+
+		last_exponent_ = (in_count > 0) ? exponents_.back() : 0.0;
+
+		// Find the distinct gaps between consecutive cash flows, giving up once there are
+		// too many to walk the discounts with.
+
+		std::vector<Day_t>	gaps;
+
+		gap_indexes_.assign(in_count, 0);
+
+		for (std::size_t i = 1; (i < in_count) && (gaps.size() <= kMaxDiscountGaps); i++)
+		{
+			Day_t		gap = days_[i] - days_[i - 1];
+			std::size_t	index = std::find(gaps.begin(), gaps.end(), gap) - gaps.begin();
+
+			if (index == gaps.size())
+			{
+				gaps.push_back(gap);
+			}
+
+			gap_indexes_[i] = static_cast<std::uint8_t>(index);
+		}
+
+		gap_exponents_.clear();
+		walk_discounts_ = false;
+
+		if (gaps.size() <= kMaxDiscountGaps)
+		{
+			for (Day_t gap : gaps)
+			{
+				gap_exponents_.push_back(CalculateExponent(gap));
+			}
+
+			walk_discounts_ = (((gaps.size() + (in_count / kDiscountAnchorInterval)) * 2) <= in_count);
+		}
+		else
+		{
+			gap_indexes_.clear();
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	// Calculate sum(amount[k] * x^k) for the amount in each period k of the grid with
+	// x = 1 / (1 + rate).
+	NPV_t	CashFlowPlan::calculatePeriodicNPV(const Rate_t& in_periodic_rate) const
+	{
+		if (in_periodic_rate == -1.0)
+		{
+			return 0.0;
+		}
+
+		return roots::EvaluatePolynomialValue(periodic_amounts_.data(), periodic_amounts_.size(), 1.0L / (1.0L + in_periodic_rate));
+	}
+
+	//----------------------------------------------------------------------------------
+	// Find the root x of the periodic NPV as a polynomial in the discount per period.
+	// The rate is 1 / x - 1.  The root is found in double precision, which is several
+	// times faster than long double, and then polished with one Newton step in long
+	// double.
+	Rate_t	CashFlowPlan::GetPeriodicRate() const
+	{
+		roots::PolynomialRoot<double>	root = roots::FindPositivePolynomialRoot(periodic_amounts_double_.data(), periodic_amounts_double_.size());
+
+		if (!root.found_)
+		{
+			return std::numeric_limits<Rate_t>::quiet_NaN();
+		}
+
+		NPV_t						discount = static_cast<NPV_t>(root.root_);
+		roots::Derivatives<NPV_t>	polynomial = roots::EvaluatePolynomial(periodic_amounts_.data(), periodic_amounts_.size(), discount, false);
+		NPV_t						polished = discount - (polynomial.value_ / polynomial.first_);
+
+		if (std::isfinite(polished) && (polished > 0.0))
+		{
+			discount = polished;
+		}
+
+		return (1.0L / discount) - 1.0L;
+	}
+
+	//----------------------------------------------------------------------------------
+	// The grid has one period fewer than it has points and the plan's rate is
+	// compounded over GetPeriodsInRange() periods, so log(1 + rate) is scaled by their
+	// ratio.
+	Rate_t	CashFlowPlan::ConvertPeriodicRate(const Rate_t& in_periodic_rate) const
+	{
+		Rate_t	periods = static_cast<Rate_t>(periodic_amounts_.size()) - 1.0L;
+
+		return std::expm1(std::log1p(in_periodic_rate) * periods / GetPeriodsInRange());
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return the exponent of a number of days from the first cash flow for the plan's
+	// compounding.
+	Rate_t	CashFlowPlan::CalculateExponent(Day_t in_days) const
+	{
+		static const Rate_t	kDaysInYear = 365.0;
+
+		switch (compounding_)
+		{
+		case compounding_e::annual:
+			// Calculate an annual rate (like XIRR in Excel).
+			return static_cast<Rate_t>(in_days) / kDaysInYear;
+
+		case compounding_e::daily:
+			// Calculate a daily rate.
+			return static_cast<Rate_t>(in_days);
+
+		default:
+			// Calculate a since inception rate.  Cash flows all on one day have no range
+			// to compound over so their exponents are zero rather than 0 / 0.
+			if (days_in_range_ == 0)
+			{
+				return 0.0;
+			}
+
+			return static_cast<Rate_t>(in_days) / static_cast<Rate_t>(days_in_range_);
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	// Call in_function(i, v) with each cash flow's discount v = (1 + rate)^-exponent given
+	// log(1 + rate).  Each is found as exp(-exponent * log(1 + rate)) unless the discounts
+	// are walked.  Then a factor is found once for each distinct gap between consecutive
+	// cash flows, and each discount is the one before it times the factor of its gap.
+	// The rounding error of a factor would compound along the walk, so every
+	// kDiscountAnchorInterval-th discount is found with exp() to re-anchor it, which
+	// keeps the error within about that many units in the last place.
+	template <class VALUE_T, class FUNCTION_T>
+	void	CashFlowPlan::ForEachDiscount(VALUE_T in_log_rate, FUNCTION_T&& in_function) const
+	{
+		std::size_t	count = exponents_.size();
+
+		if (!walk_discounts_)
+		{
+			for (std::size_t i = 0; i < count; i++)
+			{
+				in_function(i, std::exp(-in_log_rate * static_cast<VALUE_T>(exponents_[i])));
+			}
+
+			return;
+		}
+
+		VALUE_T	factors[kMaxDiscountGaps];
+
+		for (std::size_t k = 0; k < gap_exponents_.size(); k++)
+		{
+			factors[k] = std::exp(-in_log_rate * static_cast<VALUE_T>(gap_exponents_[k]));
+		}
+
+		for (std::size_t anchor = 0; anchor < count; anchor += kDiscountAnchorInterval)
+		{
+			std::size_t	last = std::min(anchor + kDiscountAnchorInterval, count);
+			VALUE_T		discount = std::exp(-in_log_rate * static_cast<VALUE_T>(exponents_[anchor]));
+
+			in_function(anchor, discount);
+
+			for (std::size_t i = anchor + 1; i < last; i++)
+			{
+				discount *= factors[gap_indexes_[i]];
+				in_function(i, discount);
+			}
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return the Modified Dietz return.  Each cash flow is weighted by the part of the
+	// range remaining after it, (last exponent - exponent), which is (1 - exponent) for
+	// a since inception rate, and the NPV is linearized as
+	// sum(amount * (1 + rate * (last exponent - exponent))) = 0, so
+	//   rate = -sum(amount) / sum(amount * (last exponent - exponent))
+	// Returns NaN if the weighted cash flows sum to zero.
+	Rate_t	CashFlowPlan::GetModifiedDietzRate() const
+	{
+		NPV_t	weighted_capital = (last_exponent_ * sum_amounts_) - sum_weighted_amounts_;
+
+		if (weighted_capital == 0.0)
+		{
+			return std::numeric_limits<Rate_t>::quiet_NaN();
+		}
+
+		return -sum_amounts_ / weighted_capital;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return the root of NPV(0) + rate * NPV'(0) = 0.  Returns NaN if the derivative
+	// is zero.
+	Rate_t	CashFlowPlan::GetTaylorRate() const
+	{
+		if (sum_weighted_amounts_ == 0.0)
+		{
+			return std::numeric_limits<Rate_t>::quiet_NaN();
+		}
+
+		return sum_amounts_ / sum_weighted_amounts_;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Given a discount rate, calculate the value of the series of cash flows discounted
+	// by that rate.  (1 + rate)^-exponent is found as exp(-exponent * log1p(rate)).
+	NPV_t	CashFlowPlan::calculateNPV(const Rate_t& in_daily_discount_rate) const
+	{
+		return calculateNPV<LongDoublePrecision>(in_daily_discount_rate);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Calculate the NPV with every value rounded to the policy's type.  The exponents
+	// and amounts are rounded as they are read so one plan serves every policy.
+	template <class PRECISION_T>
+	typename PRECISION_T::value_t	CashFlowPlan::calculateNPV(const typename PRECISION_T::value_t& in_daily_discount_rate) const
+	{
+		using value_t = typename PRECISION_T::value_t;
+
+		typename PRECISION_T::sum_t	result;
+
+		// If the discount rate is -100% that implies that all cash flows were
+		// entirely lost.  That means that all have a net present value = 0.
+
+		if (in_daily_discount_rate == -1.0)
+		{
+			return 0.0;
+		}
+
+		if (compounding_ == compounding_e::daily)
+		{
+			return calculateDailyNPV<PRECISION_T>(in_daily_discount_rate);
+		}
+
+		value_t	log_rate = std::log1p(in_daily_discount_rate);
+
+		ForEachDiscount(log_rate,
+			[this, &result](std::size_t in_index, value_t in_discount)
+			{
+				result.Add(static_cast<value_t>(amounts_[in_index]) * in_discount);
+			}
+		);
+
+		return result.Get();
+	}
+
+	//----------------------------------------------------------------------------------
+	// Discount each cash flow by v^days with v = 1 / (1 + rate), building the powers by
+	// multiplication rather than with exp() or pow().  Each power is the product of
+	// O(log days) factors, so it is as accurate as exp() would be.
+	//
+	// With at least as many cash flows as the square root of the range, the powers come
+	// from two tables, low[d] = v^d and high[d] = v^(d * split) for d < split where
+	// split^2 > range, so each cash flow needs one multiplication and building the
+	// tables costs about 2 * split.  Otherwise (or if the range is too long for tables
+	// on the stack) each power is found by repeated squaring from v^(2^k).
+	template <class PRECISION_T>
+	typename PRECISION_T::value_t	CashFlowPlan::calculateDailyNPV(const typename PRECISION_T::value_t& in_daily_discount_rate) const
+	{
+		using value_t = typename PRECISION_T::value_t;
+
+		static const int	kMaxSplitBits = 8;
+		static const int	kMaxBits = 32;
+
+		typename PRECISION_T::sum_t	result;
+		value_t						discount = static_cast<value_t>(1.0) / (static_cast<value_t>(1.0) + in_daily_discount_rate);
+		int							split_bits = 0;
+
+		while ((split_bits <= kMaxSplitBits) && ((static_cast<std::int64_t>(1) << (2 * split_bits)) <= days_in_range_))
+		{
+			split_bits++;
+		}
+
+		Day_t	split = static_cast<Day_t>(1) << split_bits;
+
+		if ((split_bits <= kMaxSplitBits) && (days_.size() >= static_cast<std::size_t>(split)))
+		{
+			value_t	low[1 << kMaxSplitBits];
+			value_t	high[1 << kMaxSplitBits];
+			Day_t	mask = split - 1;
+			Day_t	high_count = (days_in_range_ >> split_bits) + 1;
+
+			low[0] = 1.0;
+			low[1] = discount;
+
+			for (Day_t d = 2; d < split; d++)
+			{
+				low[d] = low[d >> 1] * low[d - (d >> 1)];
+			}
+
+			high[0] = 1.0;
+			high[1] = low[split - 1] * discount;
+
+			for (Day_t d = 2; d < high_count; d++)
+			{
+				high[d] = high[d >> 1] * high[d - (d >> 1)];
+			}
+
+			for (std::size_t i = 0; i < days_.size(); i++)
+			{
+				result.Add(static_cast<value_t>(amounts_[i]) * (low[days_[i] & mask] * high[days_[i] >> split_bits]));
+			}
+		}
+		else
+		{
+			value_t	squares[kMaxBits];
+			int		bits = 1;
+
+			squares[0] = discount;
+
+			while ((bits < kMaxBits) && ((static_cast<std::int64_t>(1) << bits) <= days_in_range_))
+			{
+				squares[bits] = squares[bits - 1] * squares[bits - 1];
+				bits++;
+			}
+
+			for (std::size_t i = 0; i < days_.size(); i++)
+			{
+				value_t	power = 1.0;
+
+				for (Day_t days = days_[i], k = 0; days != 0; days >>= 1, k++)
+				{
+					if ((days & 1) != 0)
+					{
+						power *= squares[k];
+					}
+				}
+
+				result.Add(static_cast<value_t>(amounts_[i]) * power);
+			}
+		}
+
+		return result.Get();
+	}
+
+	//----------------------------------------------------------------------------------
+	// Calculate the NPV and its derivatives with respect to the rate in a single pass.
+	// With v = (1 + rate)^-e for each cash flow:
+	//   NPV   = sum(amount * v)
+	//   NPV'  = -sum(e * amount * v) / (1 + rate)
+	//   NPV'' = sum(e * (e + 1) * amount * v) / (1 + rate)^2
+	NPVDerivatives	CashFlowPlan::calculateNPVDerivatives(const Rate_t& in_daily_discount_rate, bool in_second) const
+	{
+		return calculateNPVDerivatives<LongDoublePrecision>(in_daily_discount_rate, in_second);
+	}
+
+	template <class PRECISION_T>
+	BasicNPVDerivatives<typename PRECISION_T::value_t>	CashFlowPlan::calculateNPVDerivatives(
+															const typename PRECISION_T::value_t& in_daily_discount_rate,
+															bool in_second) const
+	{
+		using value_t = typename PRECISION_T::value_t;
+
+		BasicNPVDerivatives<value_t>	result;
+
+		if (in_daily_discount_rate == -1.0)
+		{
+			return result;
+		}
+
+		value_t	log_rate = std::log1p(in_daily_discount_rate);
+		value_t	inverse_rate = static_cast<value_t>(1.0) / (static_cast<value_t>(1.0) + in_daily_discount_rate);
+
+		typename PRECISION_T::sum_t	npv_sum;
+		typename PRECISION_T::sum_t	first_sum;
+		typename PRECISION_T::sum_t	second_sum;
+
+		ForEachDiscount(log_rate,
+			[this, in_second, &npv_sum, &first_sum, &second_sum](std::size_t in_index, value_t in_discount)
+			{
+				value_t	exponent = static_cast<value_t>(exponents_[in_index]);
+				value_t	discounted_cash_flow = static_cast<value_t>(amounts_[in_index]) * in_discount;
+				value_t	weighted_cash_flow = exponent * discounted_cash_flow;
+
+				npv_sum.Add(discounted_cash_flow);
+				first_sum.Add(weighted_cash_flow);
+
+				if (in_second)
+				{
+					second_sum.Add((exponent + static_cast<value_t>(1.0)) * weighted_cash_flow);
+				}
+			}
+		);
+
+		result.npv_ = npv_sum.Get();
+		result.first_ = -first_sum.Get() * inverse_rate;
+		result.second_ = second_sum.Get() * inverse_rate * inverse_rate;
+
+		return result;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Calculate the NPV in double precision using the vector kernel.
+	double	CashFlowPlan::calculateNPVDouble(double in_daily_discount_rate) const
+	{
+		if (in_daily_discount_rate == -1.0)
+		{
+			return 0.0;
+		}
+
+		return (kernels::GetNPVExponentKernel())(exponents_double_.data(), amounts_double_.data(),
+													exponents_double_.size(), std::log1p(in_daily_discount_rate));
+	}
+
+	//----------------------------------------------------------------------------------
+	// Calculate the NPV at several rates one at a time.
+	void	CashFlowPlan::calculateNPVDouble(const double* in_daily_discount_rates, std::size_t in_rate_count, double* out_npvs) const
+	{
+		for (std::size_t k = 0; k < in_rate_count; k++)
+		{
+			out_npvs[k] = calculateNPVDouble(in_daily_discount_rates[k]);
+		}
+	}
+
+	std::vector<double>	CashFlowPlan::calculateNPVDouble(const std::vector<double>& in_daily_discount_rates) const
+	{
+		std::vector<double>	npvs(in_daily_discount_rates.size());
+
+		calculateNPVDouble(in_daily_discount_rates.data(), in_daily_discount_rates.size(), npvs.data());
+
+		return npvs;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Calculate the NPV at a grid of rates evenly spaced in log(1 + rate) with the grid
+	// kernel.
+	void	CashFlowPlan::calculateNPVGridDouble(double in_first_log_rate, double in_log_rate_step, std::size_t in_count, double* out_npvs) const
+	{
+		(kernels::GetNPVGridKernel())(exponents_double_.data(), amounts_double_.data(), exponents_double_.size(),
+										in_first_log_rate, in_log_rate_step, in_count, out_npvs);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Instantiate the calculations for each numeric policy.
+	template FloatPrecision::value_t	CashFlowPlan::calculateNPV<FloatPrecision>(const FloatPrecision::value_t&) const;
+	template DoublePrecision::value_t	CashFlowPlan::calculateNPV<DoublePrecision>(const DoublePrecision::value_t&) const;
+	template LongDoublePrecision::value_t	CashFlowPlan::calculateNPV<LongDoublePrecision>(const LongDoublePrecision::value_t&) const;
+	template CompensatedDoublePrecision::value_t	CashFlowPlan::calculateNPV<CompensatedDoublePrecision>(const CompensatedDoublePrecision::value_t&) const;
+
+	template BasicNPVDerivatives<FloatPrecision::value_t>
+		CashFlowPlan::calculateNPVDerivatives<FloatPrecision>(const FloatPrecision::value_t&, bool) const;
+	template BasicNPVDerivatives<DoublePrecision::value_t>
+		CashFlowPlan::calculateNPVDerivatives<DoublePrecision>(const DoublePrecision::value_t&, bool) const;
+	template BasicNPVDerivatives<LongDoublePrecision::value_t>
+		CashFlowPlan::calculateNPVDerivatives<LongDoublePrecision>(const LongDoublePrecision::value_t&, bool) const;
+	template BasicNPVDerivatives<CompensatedDoublePrecision::value_t>
+		CashFlowPlan::calculateNPVDerivatives<CompensatedDoublePrecision>(const CompensatedDoublePrecision::value_t&, bool) const;
+
+};
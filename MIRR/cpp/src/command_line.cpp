@@ -0,0 +1,594 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+#include "batch_calculator.h"
+#include "cash_flow_file.h"
+#include "command_line.h"
+#include "csv_reader.h"
+#include "log_sink.h"
+#include "portfolio.h"
+#include "result_file.h"
+
+namespace mirr {
+
+	//----------------------------------------------------------------------------------
+	// Return whether or not a string ends with a suffix.
+	static bool	EndsWith(const std::string& in_text, const char* in_suffix)
+	{
+		std::size_t	length = std::strlen(in_suffix);
+
+		return ((in_text.size() >= length) && (in_text.compare(in_text.size() - length, length, in_suffix) == 0));
+	}
+
+	//----------------------------------------------------------------------------------
+	// Read an unsigned whole number.  Returns false if the text is not one.
+	static bool	ParseCount(const char* in_text, unsigned long& out_value)
+	{
+		char*	end = nullptr;
+
+		if ((*in_text < '0') || (*in_text > '9'))
+		{
+			return false;
+		}
+
+		out_value = std::strtoul(in_text, &end, 10);
+
+		return (*end == '\0');
+	}
+
+	//----------------------------------------------------------------------------------
+	// Read the name of a file format.
+	static bool	ParseFormat(const std::string& in_text, file_format_e& out_format)
+	{
+		if (in_text == "auto")
+		{
+			out_format = file_format_e::format_auto;
+		}
+		else if (in_text == "csv")
+		{
+			out_format = file_format_e::format_csv;
+		}
+		else if (in_text == "binary")
+		{
+			out_format = file_format_e::format_binary;
+		}
+		else
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Read the command line.  Options that take a value accept it as the next argument
+	// or after an '=' (e.g. "--threads 4" or "--threads=4").  The first argument that is
+	// not an option is the input file.
+	bool	ParseCommandLine(int argc, const char* const* argv, CommandLineOptions& out_options, std::string& out_error)
+	{
+		out_options = CommandLineOptions();
+
+		for (int i = 1; i < argc; i++)
+		{
+			std::string	argument = argv[i];
+			std::string	value;
+			bool		has_value = false;
+			bool		used_value = false;
+
+			if ((argument.size() > 2) && (argument.compare(0, 2, "--") == 0) && (argument.find('=') != std::string::npos))
+			{
+				value = argument.substr(argument.find('=') + 1);
+				argument = argument.substr(0, argument.find('='));
+				has_value = true;
+			}
+
+			// Take the value of an option that needs one.
+
+			auto	take_value = [&]() -> bool {
+				if (!has_value)
+				{
+					if (i + 1 >= argc)
+					{
+						out_error = argument + " needs a value";
+						return false;
+					}
+
+					value = argv[++i];
+				}
+
+				used_value = true;
+				return true;
+			};
+
+			unsigned long	count = 0;
+
+			if ((argument == "-h") || (argument == "--help"))
+			{
+				out_options.command_ = command_e::command_help;
+			}
+			else if (argument == "--test")
+			{
+				out_options.command_ = command_e::command_test;
+			}
+			else if (argument == "--bench")
+			{
+				out_options.command_ = command_e::command_bench;
+			}
+			else if ((argument == "-o") || (argument == "--output"))
+			{
+				if (!take_value())
+				{
+					return false;
+				}
+				out_options.output_path_ = value;
+			}
+			else if (argument == "--write-binary")
+			{
+				if (!take_value())
+				{
+					return false;
+				}
+				out_options.binary_path_ = value;
+			}
+			else if (argument == "--log")
+			{
+				if (!take_value())
+				{
+					return false;
+				}
+				out_options.log_path_ = value;
+			}
+			else if ((argument == "--input-format") || (argument == "--output-format"))
+			{
+				if (!take_value())
+				{
+					return false;
+				}
+
+				file_format_e&	format = (argument == "--input-format") ? out_options.input_format_ : out_options.output_format_;
+
+				if (!ParseFormat(value, format))
+				{
+					out_error = argument + " must be auto, csv or binary, not " + value;
+					return false;
+				}
+			}
+			else if ((argument == "-t") || (argument == "--threads"))
+			{
+				if (!take_value())
+				{
+					return false;
+				}
+
+				if (!ParseCount(value.c_str(), count))
+				{
+					out_error = argument + " must be a number of threads, not " + value;
+					return false;
+				}
+				out_options.thread_count_ = static_cast<unsigned>(count);
+			}
+			else if (argument == "--chunk")
+			{
+				if (!take_value())
+				{
+					return false;
+				}
+
+				if (!ParseCount(value.c_str(), count) || (count == 0))
+				{
+					out_error = argument + " must be a number of accounts, not " + value;
+					return false;
+				}
+				out_options.chunk_size_ = count;
+			}
+			else if (argument == "--trace")
+			{
+				if (!take_value())
+				{
+					return false;
+				}
+
+				if (!ParseCount(value.c_str(), count))
+				{
+					out_error = argument + " must be a number of steps, not " + value;
+					return false;
+				}
+				out_options.trace_capacity_ = count;
+			}
+			else if (argument == "--method")
+			{
+				if (!take_value())
+				{
+					return false;
+				}
+
+				if (value == "brent")
+				{
+					out_options.options_.method_ = solver_method_e::brent;
+				}
+				else if (value == "newton")
+				{
+					out_options.options_.method_ = solver_method_e::newton;
+				}
+				else if (value == "halley")
+				{
+					out_options.options_.method_ = solver_method_e::halley;
+				}
+				else
+				{
+					out_error = argument + " must be brent, newton or halley, not " + value;
+					return false;
+				}
+			}
+			else if (argument == "--seed")
+			{
+				if (!take_value())
+				{
+					return false;
+				}
+
+				if (value == "fixed")
+				{
+					out_options.options_.seed_ = seed_strategy_e::fixed_bracket;
+				}
+				else if (value == "dietz")
+				{
+					out_options.options_.seed_ = seed_strategy_e::modified_dietz;
+				}
+				else if (value == "taylor")
+				{
+					out_options.options_.seed_ = seed_strategy_e::taylor;
+				}
+				else
+				{
+					out_error = argument + " must be fixed, dietz or taylor, not " + value;
+					return false;
+				}
+			}
+			else if (argument == "--compounding")
+			{
+				if (!take_value())
+				{
+					return false;
+				}
+
+				if (value == "inception")
+				{
+					out_options.options_.compounding_ = compounding_e::since_inception;
+				}
+				else if (value == "annual")
+				{
+					out_options.options_.compounding_ = compounding_e::annual;
+				}
+				else if (value == "daily")
+				{
+					out_options.options_.compounding_ = compounding_e::daily;
+				}
+				else
+				{
+					out_error = argument + " must be inception, annual or daily, not " + value;
+					return false;
+				}
+			}
+			else if (argument == "--precision")
+			{
+				if (!take_value())
+				{
+					return false;
+				}
+
+				if (value == "full")
+				{
+					out_options.options_.precision_ = solve_precision_e::full_precision;
+				}
+				else if (value == "mixed")
+				{
+					out_options.options_.precision_ = solve_precision_e::mixed_precision;
+				}
+				else
+				{
+					out_error = argument + " must be full or mixed, not " + value;
+					return false;
+				}
+			}
+			else if (argument == "--seed-width")
+			{
+				if (!take_value())
+				{
+					return false;
+				}
+
+				char*	end = nullptr;
+				double	width = std::strtod(value.c_str(), &end);
+
+				if (value.empty() || (*end != '\0') || !(width > 0.0))
+				{
+					out_error = argument + " must be a positive number, not " + value;
+					return false;
+				}
+				out_options.options_.seed_width_ = width;
+			}
+			else if (argument == "--verify")
+			{
+				out_options.verify_ = true;
+			}
+			else if (argument == "--stats")
+			{
+				out_options.print_stats_ = true;
+			}
+			else if ((argument.size() > 1) && (argument[0] == '-'))
+			{
+				out_error = "unknown option " + argument;
+				return false;
+			}
+			else if (out_options.input_path_.empty())
+			{
+				out_options.input_path_ = argument;
+			}
+			else
+			{
+				out_error = "more than one input file: " + argument;
+				return false;
+			}
+
+			if (has_value && !used_value)
+			{
+				out_error = argument + " does not take a value";
+				return false;
+			}
+
+			if (used_value && value.empty())
+			{
+				out_error = argument + " needs a value";
+				return false;
+			}
+		}
+
+		if ((out_options.trace_capacity_ > 0) && out_options.log_path_.empty())
+		{
+			out_error = "--trace needs --log to write the traces to";
+			return false;
+		}
+
+		if ((out_options.command_ == command_e::command_solve) && out_options.input_path_.empty())
+		{
+			out_error = "no input file";
+			return false;
+		}
+
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Write a description of the command line.
+	void	PrintUsage(std::ostream& io_stream)
+	{
+		io_stream
+			<< "usage: mirr [options] input\n"
+			<< "  Find the rate of return of every account in a file of cash flows.  The input is\n"
+			<< "  CSV with lines of account_id,date,amount (dates YYYY-MM-DD) or a binary cash\n"
+			<< "  flow file.  The results are one line per account of\n"
+			<< "  account_id,rate,status,iterations,evaluations.\n"
+			<< "\n"
+			<< "  -o, --output PATH        write the results here (default: standard output as CSV)\n"
+			<< "  --output-format FORMAT   auto, csv or binary (auto: binary if PATH ends in .bin)\n"
+			<< "  --input-format FORMAT    auto, csv or binary (auto: from the file's header)\n"
+			<< "  --write-binary PATH      also write the input as a binary cash flow file\n"
+			<< "  --verify                 check the checksums of a binary input file\n"
+			<< "  -t, --threads N          worker threads (default 0: one per core)\n"
+			<< "  --chunk N                accounts a worker claims at a time (default 64)\n"
+			<< "  --method METHOD          brent, newton or halley (default brent)\n"
+			<< "  --seed SEED              fixed, dietz or taylor (default fixed)\n"
+			<< "  --seed-width W           half width of a seeded bracket in log(1 + rate) (default 0.01)\n"
+			<< "  --compounding RATE       inception (over the whole range), annual (like XIRR) or daily\n"
+			<< "                           (default inception)\n"
+			<< "  --precision PRECISION    full, or mixed to search in double and polish in long double\n"
+			<< "                           (default full)\n"
+			<< "  --log PATH               write the solvers' logs here\n"
+			<< "  --trace N                also log the last N steps of each search that is not solved\n"
+			<< "  --stats                  print throughput and latency percentiles to standard error\n"
+			<< "  --test                   run the tests\n"
+			<< "  --bench                  run the benchmarks\n"
+			<< "  -h, --help               print this description\n";
+	}
+
+	//----------------------------------------------------------------------------------
+	// Read the input in whichever format it is in.  Returns false after describing the
+	// problem if it cannot be read.
+	static bool	ReadInput(const CommandLineOptions& in_options, Portfolio& out_portfolio, std::size_t& out_bytes)
+	{
+		file_format_e	format = in_options.input_format_;
+		file_status_e	status = file_status_e::file_ok;
+
+		out_bytes = 0;
+
+		if (format != file_format_e::format_csv)
+		{
+			status = ReadCashFlowsBinary(in_options.input_path_, out_portfolio, in_options.verify_);
+
+			if ((status == file_status_e::file_bad_header) && (format == file_format_e::format_auto))
+			{
+				format = file_format_e::format_csv;
+			}
+			else if (status != file_status_e::file_ok)
+			{
+				std::cerr << "mirr: " << in_options.input_path_ << ": " << FileStatusName(status) << std::endl;
+				return false;
+			}
+		}
+
+		if (format == file_format_e::format_csv)
+		{
+			CsvReadStats	stats;
+
+			if (!ReadCashFlowsCsv(in_options.input_path_, in_options.thread_count_, out_portfolio, stats))
+			{
+				std::cerr << "mirr: " << in_options.input_path_ << ": could not be read" << std::endl;
+				return false;
+			}
+
+			if (stats.bad_rows_ > 0)
+			{
+				std::cerr << "mirr: " << in_options.input_path_ << ": skipped " << stats.bad_rows_
+					<< " rows that could not be read, the first at offset " << stats.first_bad_offset_ << std::endl;
+			}
+
+			out_bytes = stats.bytes_;
+		}
+
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Read, solve and write, timing each step for the statistics.
+	int		RunCommandLine(const CommandLineOptions& in_options)
+	{
+		using clock = std::chrono::steady_clock;
+
+		Portfolio	portfolio;
+		std::size_t	bytes = 0;
+
+		auto	start = clock::now();
+
+		if (!ReadInput(in_options, portfolio, bytes))
+		{
+			return 2;
+		}
+
+		auto	read = clock::now();
+
+		if (!in_options.binary_path_.empty())
+		{
+			file_status_e	status = WriteCashFlowsBinary(in_options.binary_path_, portfolio);
+
+			if (status != file_status_e::file_ok)
+			{
+				std::cerr << "mirr: " << in_options.binary_path_ << ": " << FileStatusName(status) << std::endl;
+				return 3;
+			}
+		}
+
+		BatchCalculator	batch(in_options.thread_count_);
+
+		batch.chunk_size_ = in_options.chunk_size_;
+		batch.trace_capacity_ = in_options.trace_capacity_;
+		batch.options_ = in_options.options_;
+
+		std::unique_ptr<logging::AsyncFdSink>	log_sink;
+
+		if (!in_options.log_path_.empty())
+		{
+			log_sink.reset(new logging::AsyncFdSink(in_options.log_path_));
+
+			if (!log_sink->IsOpen())
+			{
+				std::cerr << "mirr: " << in_options.log_path_ << ": could not be opened" << std::endl;
+				return 3;
+			}
+
+			batch.log_sink_ = log_sink.get();
+		}
+
+		auto	solve = clock::now();
+
+		std::vector<BatchResult>	results = batch.GetRates(portfolio);
+
+		auto	solved = clock::now();
+
+		if (log_sink)
+		{
+			log_sink->Flush();
+		}
+
+		// Write the results.
+
+		file_format_e	format = in_options.output_format_;
+
+		if (format == file_format_e::format_auto)
+		{
+			format = EndsWith(in_options.output_path_, ".bin") ? file_format_e::format_binary : file_format_e::format_csv;
+		}
+
+		if (format == file_format_e::format_binary)
+		{
+			file_status_e	status = in_options.output_path_.empty() ? file_status_e::file_not_opened
+										: WriteResultsBinary(in_options.output_path_, results);
+
+			if (status != file_status_e::file_ok)
+			{
+				std::cerr << "mirr: " << (in_options.output_path_.empty() ? "binary results need an output file" : in_options.output_path_)
+					<< ": " << FileStatusName(status) << std::endl;
+				return 3;
+			}
+		}
+		else if (in_options.output_path_.empty())
+		{
+			WriteResultsCsv(std::cout, portfolio, results);
+
+			if (!std::cout)
+			{
+				return 3;
+			}
+		}
+		else
+		{
+			std::ofstream	file(in_options.output_path_, std::ios::binary | std::ios::trunc);
+
+			WriteResultsCsv(file, portfolio, results);
+			file.close();
+
+			if (!file)
+			{
+				std::cerr << "mirr: " << in_options.output_path_ << ": " << FileStatusName(file_status_e::file_write_failed) << std::endl;
+				return 3;
+			}
+		}
+
+		auto	written = clock::now();
+
+		if (in_options.print_stats_)
+		{
+			auto	milliseconds = [](clock::time_point in_start, clock::time_point in_finish) {
+				return std::chrono::duration<double, std::milli>(in_finish - in_start).count();
+			};
+
+			BatchStats	stats = CalculateBatchStats(results, std::chrono::duration<double>(solved - solve).count());
+
+			std::cerr << std::fixed << std::setprecision(1)
+				<< "accounts      " << stats.count_ << " (" << stats.solved_ << " solved, " << stats.not_bracketed_
+				<< " not bracketed, " << stats.failed_ << " failed)\n"
+				<< "cash flows    " << portfolio.GetCashFlowCount() << "\n"
+				<< "threads       " << batch.GetThreadCount() << "\n"
+				<< "read          " << milliseconds(start, read) << " ms";
+
+			if (bytes > 0)
+			{
+				std::cerr << "  " << (bytes / std::max(std::chrono::duration<double>(read - start).count(), 1e-9) / 1e6) << " MB/s";
+			}
+
+			std::cerr << "\n"
+				<< "solve         " << milliseconds(solve, solved) << " ms  " << stats.per_second_ << " accounts/s  "
+				<< (portfolio.GetCashFlowCount() / std::max(stats.seconds_, 1e-9) / 1e6) << " M cash flows/s\n"
+				<< "write         " << milliseconds(solved, written) << " ms\n"
+				<< std::setprecision(2)
+				<< "evaluations   " << stats.mean_evaluations_ << " per account\n"
+				<< "latency us    p50 " << (stats.p50_nanoseconds_ / 1e3) << "  p90 " << (stats.p90_nanoseconds_ / 1e3)
+				<< "  p99 " << (stats.p99_nanoseconds_ / 1e3) << "  p99.9 " << (stats.p999_nanoseconds_ / 1e3)
+				<< "  max " << (stats.max_nanoseconds_ / 1e3) << std::endl;
+
+			if (in_options.options_.precision_ == solve_precision_e::mixed_precision)
+			{
+				std::cerr << "residual      max " << std::scientific << stats.max_residual_ << std::fixed << std::endl;
+			}
+		}
+
+		return 0;
+	}
+
+};
@@ -0,0 +1,429 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+#include "csv_reader.h"
+#include "mapped_file.h"
+
+namespace mirr {
+
+	//----------------------------------------------------------------------------------
+	// An account id as the characters in the text being parsed.
+	struct AccountKey {
+		const char*		data_;
+		std::uint32_t	size_;
+
+		bool	operator==(const AccountKey& in_rhs) const
+		{
+			return (size_ == in_rhs.size_) && (std::memcmp(data_, in_rhs.data_, size_) == 0);
+		}
+	};
+
+	//----------------------------------------------------------------------------------
+	// Hash an account id (FNV-1a).
+	struct AccountKeyHash {
+		std::size_t	operator()(const AccountKey& in_key) const
+		{
+			std::uint64_t	hash = 14695981039346656037ULL;
+
+			for (std::uint32_t i = 0; i < in_key.size_; i++)
+			{
+				hash = (hash ^ static_cast<unsigned char>(in_key.data_[i])) * 1099511628211ULL;
+			}
+
+			return static_cast<std::size_t>(hash);
+		}
+	};
+
+	using AccountIndex_t = std::unordered_map<AccountKey, std::uint32_t, AccountKeyHash>;
+
+	//----------------------------------------------------------------------------------
+	// A row parsed by a thread.  The account is the thread's own index for it.
+	struct CsvRow {
+		std::uint32_t	account_;
+		dates::Date_t	date_;
+		double			amount_;
+	};
+
+	//----------------------------------------------------------------------------------
+	// The rows and accounts one thread found in its chunk.
+	struct CsvChunk {
+		const char*					first_ = nullptr;
+		const char*					last_ = nullptr;
+		std::vector<CsvRow>			rows_;
+		std::vector<AccountKey>		accounts_;			// The thread's accounts in order of appearance.
+		std::vector<std::uint64_t>	account_counts_;	// Rows for each of the thread's accounts.
+		std::vector<std::uint32_t>	global_accounts_;	// The portfolio's index for each account.
+		std::vector<std::uint64_t>	cursors_;			// Next position to write each account's rows.
+		std::size_t					bad_rows_ = 0;
+		std::size_t					first_bad_offset_ = 0;
+	};
+
+	//----------------------------------------------------------------------------------
+	// Parse an amount.  from_chars() is used where the library supports it for doubles;
+	// otherwise the field is copied so strtod() sees a terminated string.
+	static bool	ParseAmount(const char* in_first, const char* in_last, double& out_amount)
+	{
+		if (in_first == in_last)
+		{
+			return false;
+		}
+
+#if defined(__cpp_lib_to_chars) && (__cpp_lib_to_chars >= 201611L)
+		std::from_chars_result	result = std::from_chars(in_first, in_last, out_amount);
+
+		return (result.ec == std::errc()) && (result.ptr == in_last);
+#else
+		char		buffer[64];
+		std::size_t	length = static_cast<std::size_t>(in_last - in_first);
+
+		if (length >= sizeof(buffer))
+		{
+			return false;
+		}
+
+		std::memcpy(buffer, in_first, length);
+		buffer[length] = '\0';
+
+		char*	end = nullptr;
+
+		out_amount = std::strtod(buffer, &end);
+
+		return (end == buffer + length);
+#endif
+	}
+
+	//----------------------------------------------------------------------------------
+	// Parse the rows of one chunk.  Rows of the same account are usually together so
+	// the previous row's account is checked before looking the id up.
+	static void	ParseChunk(const char* in_text, CsvChunk& io_chunk)
+	{
+		AccountIndex_t	account_index;
+		const char*		line = io_chunk.first_;
+		AccountKey		previous_key = { nullptr, 0 };
+		std::uint32_t	previous_account = 0;
+
+		while (line < io_chunk.last_)
+		{
+			const char*	line_end = static_cast<const char*>(std::memchr(line, '\n', io_chunk.last_ - line));
+			const char*	next_line = (line_end == nullptr) ? io_chunk.last_ : line_end + 1;
+
+			if (line_end == nullptr)
+			{
+				line_end = io_chunk.last_;
+			}
+
+			const char*	field_end = line_end;
+
+			if ((field_end > line) && (field_end[-1] == '\r'))
+			{
+				field_end--;
+			}
+
+			if (field_end == line)
+			{
+				line = next_line; // Skip blank lines.
+				continue;
+			}
+
+			const char*	first_comma = static_cast<const char*>(std::memchr(line, ',', field_end - line));
+			const char*	second_comma = (first_comma == nullptr) ? nullptr :
+								static_cast<const char*>(std::memchr(first_comma + 1, ',', field_end - (first_comma + 1)));
+
+			CsvRow	row;
+			bool	parsed = (second_comma != nullptr) && (first_comma > line) &&
+							(dates::ParseDate(first_comma + 1, static_cast<std::size_t>(second_comma - (first_comma + 1)), row.date_) == dates::parse_status_e::parsed) &&
+							ParseAmount(second_comma + 1, field_end, row.amount_);
+
+			if (!parsed)
+			{
+				// The first line of the file may be a header.
+
+				if (line != in_text)
+				{
+					if (io_chunk.bad_rows_ == 0)
+					{
+						io_chunk.first_bad_offset_ = static_cast<std::size_t>(line - in_text);
+					}
+					io_chunk.bad_rows_++;
+				}
+
+				line = next_line;
+				continue;
+			}
+
+			AccountKey	key = { line, static_cast<std::uint32_t>(first_comma - line) };
+
+			if (!(key == previous_key))
+			{
+				AccountIndex_t::iterator	found = account_index.find(key);
+
+				if (found == account_index.end())
+				{
+					previous_account = static_cast<std::uint32_t>(io_chunk.accounts_.size());
+					account_index.insert(std::make_pair(key, previous_account));
+					io_chunk.accounts_.push_back(key);
+					io_chunk.account_counts_.push_back(0);
+				}
+				else
+				{
+					previous_account = found->second;
+				}
+
+				previous_key = key;
+			}
+
+			row.account_ = previous_account;
+			io_chunk.account_counts_[previous_account]++;
+			io_chunk.rows_.push_back(row);
+
+			line = next_line;
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	// Run a function for each of a number of threads, using the calling thread for the
+	// last one.
+	template <class FUNCTION_T>
+	static void	RunOnThreads(unsigned in_thread_count, FUNCTION_T in_function)
+	{
+		std::vector<std::thread>	workers;
+
+		workers.reserve(in_thread_count - 1);
+
+		// If a thread cannot be started (or the calling thread's part fails), the workers
+		// already running must be joined before they are destroyed (destroying a joinable
+		// thread calls std::terminate()).
+
+		try
+		{
+			for (unsigned t = 0; t + 1 < in_thread_count; t++)
+			{
+				workers.push_back(std::thread(in_function, t));
+			}
+
+			in_function(in_thread_count - 1);
+		}
+		catch (...)
+		{
+			for (std::thread& worker : workers)
+			{
+				worker.join();
+			}
+
+			throw;
+		}
+
+		for (std::thread& worker : workers)
+		{
+			worker.join();
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	// Parse cash flows from text in memory.  The steps are:
+	//   1. Split the text into a chunk per thread at line ends and parse them.
+	//   2. Give each account found by any thread its index in the portfolio, in order of
+	//      first appearance, and count its rows.
+	//   3. Have each thread copy its rows to their positions in the columns.
+	//   4. Find each account's start date and count its days from it.
+	void	ParseCashFlowsCsv(const char* in_text, std::size_t in_size, unsigned in_thread_count,
+								Portfolio& out_portfolio, CsvReadStats& out_stats)
+	{
+		unsigned	thread_count = in_thread_count;
+
+		if (thread_count == 0)
+		{
+			thread_count = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		// Small inputs are not worth splitting.
+
+		static const std::size_t	kMinChunkSize = 64 * 1024;
+
+		thread_count = static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(thread_count, in_size / kMinChunkSize)));
+
+		std::vector<CsvChunk>	chunks(thread_count);
+		const char*				text_end = in_text + in_size;
+
+		for (unsigned t = 0; t < thread_count; t++)
+		{
+			const char*	first = (t == 0) ? in_text : chunks[t - 1].last_;
+			const char*	last = (t + 1 == thread_count) ? text_end : in_text + (in_size / thread_count) * (t + 1);
+
+			if (last < first)
+			{
+				last = first;
+			}
+
+			if (last < text_end)
+			{
+				const char*	line_end = static_cast<const char*>(std::memchr(last, '\n', text_end - last));
+
+				last = (line_end == nullptr) ? text_end : line_end + 1;
+			}
+
+			chunks[t].first_ = first;
+			chunks[t].last_ = last;
+		}
+
+		RunOnThreads(thread_count, [&](unsigned in_thread) { ParseChunk(in_text, chunks[in_thread]); });
+
+		// Give each account its index in the portfolio.
+
+		AccountIndex_t				account_index;
+		std::vector<AccountKey>		accounts;
+		std::vector<std::uint64_t>	account_counts;
+
+		for (CsvChunk& chunk : chunks)
+		{
+			chunk.global_accounts_.resize(chunk.accounts_.size());
+
+			for (std::size_t i = 0; i < chunk.accounts_.size(); i++)
+			{
+				AccountIndex_t::iterator	found = account_index.find(chunk.accounts_[i]);
+				std::uint32_t				account = 0;
+
+				if (found == account_index.end())
+				{
+					account = static_cast<std::uint32_t>(accounts.size());
+					account_index.insert(std::make_pair(chunk.accounts_[i], account));
+					accounts.push_back(chunk.accounts_[i]);
+					account_counts.push_back(0);
+				}
+				else
+				{
+					account = found->second;
+				}
+
+				chunk.global_accounts_[i] = account;
+				account_counts[account] += chunk.account_counts_[i];
+			}
+		}
+
+		PortfolioStorage	storage;
+		std::size_t			account_count = accounts.size();
+
+		storage.offsets_.resize(account_count + 1);
+		storage.offsets_[0] = 0;
+
+		for (std::size_t a = 0; a < account_count; a++)
+		{
+			storage.offsets_[a + 1] = storage.offsets_[a] + account_counts[a];
+		}
+
+		// Each thread's rows for an account follow those of the threads before it, so the
+		// rows stay in file order.
+
+		std::vector<std::uint64_t>	next_positions(storage.offsets_.begin(), storage.offsets_.end() - 1);
+
+		for (CsvChunk& chunk : chunks)
+		{
+			chunk.cursors_.resize(chunk.accounts_.size());
+
+			for (std::size_t i = 0; i < chunk.accounts_.size(); i++)
+			{
+				chunk.cursors_[i] = next_positions[chunk.global_accounts_[i]];
+				next_positions[chunk.global_accounts_[i]] += chunk.account_counts_[i];
+			}
+		}
+
+		std::size_t	row_count = static_cast<std::size_t>(storage.offsets_[account_count]);
+
+		storage.days_.resize(row_count);
+		storage.amounts_.resize(row_count);
+		storage.start_dates_.resize(account_count);
+
+		RunOnThreads(thread_count, [&](unsigned in_thread) {
+			CsvChunk&	chunk = chunks[in_thread];
+
+			for (const CsvRow& row : chunk.rows_)
+			{
+				std::uint64_t	position = chunk.cursors_[row.account_]++;
+
+				storage.days_[position] = row.date_;
+				storage.amounts_[position] = row.amount_;
+			}
+
+			// Release the rows as soon as they are copied.
+
+			std::vector<CsvRow>().swap(chunk.rows_);
+		});
+
+		// Count each account's days from its earliest cash flow.
+
+		RunOnThreads(thread_count, [&](unsigned in_thread) {
+			std::size_t	first_account = (account_count * in_thread) / thread_count;
+			std::size_t	last_account = (account_count * (in_thread + 1)) / thread_count;
+
+			for (std::size_t a = first_account; a < last_account; a++)
+			{
+				Day_t*	first = storage.days_.data() + storage.offsets_[a];
+				Day_t*	last = storage.days_.data() + storage.offsets_[a + 1];
+				Day_t	start_date = *std::min_element(first, last);
+
+				storage.start_dates_[a] = start_date;
+
+				for (Day_t* day = first; day < last; day++)
+				{
+					*day -= start_date;
+				}
+			}
+		});
+
+		// Copy each account's id once.
+
+		storage.id_offsets_.resize(account_count + 1);
+		storage.id_offsets_[0] = 0;
+
+		for (std::size_t a = 0; a < account_count; a++)
+		{
+			storage.ids_.insert(storage.ids_.end(), accounts[a].data_, accounts[a].data_ + accounts[a].size_);
+			storage.id_offsets_[a + 1] = storage.ids_.size();
+		}
+
+		out_stats = CsvReadStats();
+		out_stats.bytes_ = in_size;
+		out_stats.rows_ = row_count;
+		out_stats.threads_ = thread_count;
+
+		for (CsvChunk& chunk : chunks)
+		{
+			if ((out_stats.bad_rows_ == 0) && (chunk.bad_rows_ > 0))
+			{
+				out_stats.first_bad_offset_ = chunk.first_bad_offset_;
+			}
+			out_stats.bad_rows_ += chunk.bad_rows_;
+		}
+
+		out_portfolio.Assign(std::move(storage));
+	}
+
+	//----------------------------------------------------------------------------------
+	// Map the file and parse it.  The file is unmapped once the cash flows and ids have
+	// been copied to the portfolio's columns.
+	bool	ReadCashFlowsCsv(const std::string& in_path, unsigned in_thread_count,
+								Portfolio& out_portfolio, CsvReadStats& out_stats)
+	{
+		MappedFile	file;
+
+		if (!file.Open(in_path))
+		{
+			return false;
+		}
+
+		ParseCashFlowsCsv(file.data(), file.size(), in_thread_count, out_portfolio, out_stats);
+
+		return true;
+	}
+
+};
@@ -75,6 +75,30 @@ namespace dates {
 		return mktime(&result);
 	}
 
+	//----------------------------------------------------------------------------------
+	// Return the date n months after (or before if negative) the date provided.  The
+	// months are counted from year 0 so that negative months borrow years correctly.
+	Date_t AddMonths(Date_t in_date, int months)
+	{
+		CivilDate	date = CivilFromDays(in_date);
+
+		bool	isLastDayInMonth = (static_cast<int>(date.day_) == GetDaysInMonth(date.year_, date.month_ - 1));
+
+		int	total_months = (date.year_ * 12) + static_cast<int>(date.month_ - 1) + months;
+		int	year = ((total_months >= 0) ? total_months : total_months - 11) / 12;
+		int	month = total_months - (year * 12); // 0 to 11
+
+		int	day;
+
+		if (isLastDayInMonth) {
+			day = GetDaysInMonth(year, month); // Last day of month maps to last day of result month
+		} else {
+			day = std::min(static_cast<int>(date.day_), GetDaysInMonth(year, month));
+		}
+
+		return DaysFromCivil(year, static_cast<unsigned>(month + 1), static_cast<unsigned>(day));
+	}
+
 	//----------------------------------------------------------------------------------
 	// Return the difference between two date/times in seconds.
 	double GetDifferenceSeconds(const time_t& in_lhs, const time_t& in_rhs)
@@ -101,6 +125,18 @@ namespace dates {
 		return std::string(buffer);
 	}
 
+	//----------------------------------------------------------------------------------
+	// Return a string representation (as YYYY-MM-DD) of a date.
+	std::string	Date2String(Date_t in_date)
+	{
+		CivilDate			date = CivilFromDays(in_date);
+		std::stringstream	buffer;
+
+		buffer << std::setfill('0') << std::setw(4) << date.year_ << "-"
+			<< std::setw(2) << date.month_ << "-" << std::setw(2) << date.day_;
+		return buffer.str();
+	}
+
 	//----------------------------------------------------------------------------------
 	// Return a string representation of a time.
 	std::string	Time2String(const time_t& in_date)
@@ -114,17 +150,92 @@ namespace dates {
 	}
 
 	//----------------------------------------------------------------------------------
-	// Given a string date (as YYYY-MM-DD), return a time structure for it.
-	time_t	MakeDate(const std::string& in_date)
+	// Given a string date (as YYYY-MM-DD), return the days since 1970-01-01 for it.  The
+	// days are calculated from the parts of the date rather than with mktime() so they
+	// do not depend on the time zone or daylight saving time.
+	Date_t	MakeDate(const std::string& in_date)
 	{
 		std::tm t = {};
 		std::istringstream ss(in_date);
 		ss.imbue(std::locale());
 		ss >> std::get_time(&t, "%Y-%m-%d");
 
-		std::time_t new_date = std::mktime(&t);
+		return DaysFromCivil(t.tm_year + 1900, static_cast<unsigned>(t.tm_mon + 1), static_cast<unsigned>(t.tm_mday));
+	}
+
+	//----------------------------------------------------------------------------------
+	// Parse a date as YYYY-MM-DD.  Each character's offset from '0' is checked as an
+	// unsigned value so a non-digit (above or below '0' to '9') is one comparison, and
+	// the checks are combined so there is a single branch for a well-formed date.
+	parse_status_e	ParseDate(const char* in_text, std::size_t in_length, Date_t& out_date)
+	{
+		if (in_length != 10)
+		{
+			return parse_status_e::bad_length;
+		}
+
+		const unsigned char*	text = reinterpret_cast<const unsigned char*>(in_text);
+
+		unsigned	y0 = static_cast<unsigned>(text[0] - '0');
+		unsigned	y1 = static_cast<unsigned>(text[1] - '0');
+		unsigned	y2 = static_cast<unsigned>(text[2] - '0');
+		unsigned	y3 = static_cast<unsigned>(text[3] - '0');
+		unsigned	m0 = static_cast<unsigned>(text[5] - '0');
+		unsigned	m1 = static_cast<unsigned>(text[6] - '0');
+		unsigned	d0 = static_cast<unsigned>(text[8] - '0');
+		unsigned	d1 = static_cast<unsigned>(text[9] - '0');
+
+		bool	bad = (y0 > 9) | (y1 > 9) | (y2 > 9) | (y3 > 9) | (m0 > 9) | (m1 > 9) | (d0 > 9) | (d1 > 9) |
+						(text[4] != '-') | (text[7] != '-');
+
+		if (bad)
+		{
+			return parse_status_e::bad_character;
+		}
+
+		int			year = static_cast<int>((y0 * 1000) + (y1 * 100) + (y2 * 10) + y3);
+		unsigned	month = (m0 * 10) + m1;
+		unsigned	day = (d0 * 10) + d1;
+
+		if ((month < 1) || (month > 12))
+		{
+			return parse_status_e::bad_month;
+		}
+
+		if ((day < 1) || (static_cast<int>(day) > GetDaysInMonth(year, static_cast<int>(month) - 1)))
+		{
+			return parse_status_e::bad_day;
+		}
+
+		out_date = DaysFromCivil(year, month, day);
+
+		return parse_status_e::parsed;
+	}
+
+	parse_status_e	ParseDate(const std::string& in_text, Date_t& out_date)
+	{
+		return ParseDate(in_text.data(), in_text.size(), out_date);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return a description of the outcome of parsing a date.
+	const char*	ParseStatusName(parse_status_e in_status)
+	{
+		switch (in_status)
+		{
+		case parse_status_e::parsed:
+			return "parsed";
+		case parse_status_e::bad_length:
+			return "not 10 characters (YYYY-MM-DD)";
+		case parse_status_e::bad_character:
+			return "not formatted as YYYY-MM-DD";
+		case parse_status_e::bad_month:
+			return "month not 01 to 12";
+		case parse_status_e::bad_day:
+			return "day not in the month";
+		}
 
-		return new_date;
+		return "unknown";
 	}
 
 
@@ -0,0 +1,68 @@
+#include "incremental_calculator.h"
+
+namespace mirr {
+
+	//----------------------------------------------------------------------------------
+	// Constructor
+	IncrementalCalculator::IncrementalCalculator()
+	{
+		calculator_.print_log_ = false;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Add a cash flow to the list.
+	void	IncrementalCalculator::push_back(const CashFlow& in_new)
+	{
+		CashFlow	cash_flow = in_new;
+
+		cash_flows_.push_back(cash_flow);
+		changed_ = true;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return the rate of the cash flows.  Appending a cash flow after the last one
+	// changes the range and so every cash flow's exponent, so the plan is compiled
+	// again; only the search is shortened by starting from the previous rate.
+	Rate_t	IncrementalCalculator::GetRate()
+	{
+		if (has_rate_ && !changed_)
+		{
+			return rate_;
+		}
+
+		CashFlowPlan	plan(cash_flows_, calculator_.options_.compounding_);
+
+		if (has_rate_)
+		{
+			rate_ = calculator_.GetRate(plan, rate_);
+		}
+		else
+		{
+			rate_ = calculator_.GetRate(plan);
+		}
+
+		has_rate_ = (calculator_.GetStatus() == solve_status_e::solved);
+		changed_ = false;
+
+		return rate_;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Forget the previous rate.
+	void	IncrementalCalculator::Reset()
+	{
+		has_rate_ = false;
+		changed_ = true;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Remove all of the cash flows and the previous rate.
+	void	IncrementalCalculator::clear()
+	{
+		cash_flows_.clear();
+		rate_ = 0.0;
+		has_rate_ = false;
+		changed_ = false;
+	}
+
+};
@@ -40,7 +40,8 @@ namespace logging {
 	// to an output (e.g. file) as each entry is logged.  Note that even if the priority 
 	// is lower than the level being logged, the entry gets included in the log list but
 	// excluded when the log is flushed so the caller can change the level later (e.g. 
-	// when an exception is detected).
+	// when an exception is detected).  Use LOG_IF_LOGGED() instead to skip formatting
+	// entries that will be excluded.
 	LogEntry&	Log::log(LogEntry& in_entry)
 	{
 		std::vector<LogEntry>::push_back(in_entry);
@@ -93,6 +94,14 @@ namespace logging {
 		return *this;
 	}
 
+	//----------------------------------------------------------------------------------
+	// Take the contents of the log from another log by swapping the entries.
+	void	Log::MoveFrom(Log& io_from)
+	{
+		swap(io_from);
+		level_logged_ = io_from.level_logged_;
+	}
+
 	//----------------------------------------------------------------------------------
 	// Copy the contents of the log from another log.
 	void	Log::CopyFrom(const Log& in_from)
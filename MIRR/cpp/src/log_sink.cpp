@@ -0,0 +1,316 @@
+#include <chrono>
+#include <fcntl.h>
+#include <utility>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <share.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "log_sink.h"
+
+//----------------------------------------------------------------------------------
+// Provide a facility to record events in a log.
+
+namespace logging {
+
+	//----------------------------------------------------------------------------------
+	// Write log text to the stream.
+	void	StreamSink::Write(const std::string& in_text)
+	{
+		std::lock_guard<std::mutex>	lock(mutex_);
+
+		output_ << in_text;
+	}
+
+	void	StreamSink::Flush()
+	{
+		std::lock_guard<std::mutex>	lock(mutex_);
+
+		output_.flush();
+	}
+
+	//----------------------------------------------------------------------------------
+	// Constructor.  The capacity is rounded up to a power of two so that the index of a
+	// slot is found with a mask.
+	SpscQueue::SpscQueue(std::size_t in_capacity)
+		: head_(0), tail_(0)
+	{
+		std::size_t	capacity = 1;
+
+		while (capacity < in_capacity)
+		{
+			capacity <<= 1;
+		}
+
+		slots_.resize(capacity);
+		mask_ = capacity - 1;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Add text to the queue.  The indexes only ever increase; the slot is the index
+	// masked by the capacity.
+	bool	SpscQueue::TryPush(const std::string& in_text)
+	{
+		std::size_t	tail = tail_.load(std::memory_order_relaxed);
+
+		if (tail - head_.load(std::memory_order_acquire) > mask_)
+		{
+			return false;
+		}
+
+		slots_[tail & mask_].assign(in_text);
+		tail_.store(tail + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Take the oldest text from the queue.  Swapping rather than moving leaves the
+	// consumer's old memory in the slot for the producer to reuse.
+	bool	SpscQueue::TryPop(std::string& io_text)
+	{
+		std::size_t	head = head_.load(std::memory_order_relaxed);
+
+		if (head == tail_.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		io_text.swap(slots_[head & mask_]);
+		head_.store(head + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Identify each sink so a thread's cached queue for a destroyed sink is never
+	// mistaken for a queue of a new sink at the same address.
+	static std::atomic<std::uint64_t>	next_sink_id(1);
+
+	//----------------------------------------------------------------------------------
+	// Constructors
+	AsyncFdSink::AsyncFdSink(int in_fd, std::size_t in_queue_capacity)
+		: fd_(in_fd), queue_capacity_(in_queue_capacity)
+	{
+		Start();
+	}
+
+	AsyncFdSink::AsyncFdSink(const std::string& in_path, std::size_t in_queue_capacity)
+		: queue_capacity_(in_queue_capacity)
+	{
+#if defined(_WIN32)
+		_sopen_s(&fd_, in_path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _SH_DENYNO, _S_IREAD | _S_IWRITE);
+#else
+		fd_ = ::open(in_path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+		owns_fd_ = (fd_ >= 0);
+
+		Start();
+	}
+
+	void	AsyncFdSink::Start()
+	{
+		id_ = next_sink_id.fetch_add(1);
+		queue_count_.store(0);
+		stop_.store(false);
+		busy_.store(false);
+		written_.store(0);
+
+		writer_ = std::thread(&AsyncFdSink::WriteQueued, this);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Destructor.  The writer drains every queue before it stops.
+	AsyncFdSink::~AsyncFdSink()
+	{
+		stop_.store(true, std::memory_order_release);
+
+		if (writer_.joinable())
+		{
+			writer_.join();
+		}
+
+		if (owns_fd_)
+		{
+#if defined(_WIN32)
+			_close(fd_);
+#else
+			::close(fd_);
+#endif
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return the calling thread's queue.  Each thread remembers its queues for the sinks
+	// it has written to, so the lock is only taken the first time a thread writes.
+	AsyncFdSink::ProducerQueue&	AsyncFdSink::GetQueue()
+	{
+		static thread_local std::vector<std::pair<std::uint64_t, ProducerQueue*>>	thread_queues;
+
+		for (std::pair<std::uint64_t, ProducerQueue*>& thread_queue : thread_queues)
+		{
+			if (thread_queue.first == id_)
+			{
+				return *thread_queue.second;
+			}
+		}
+
+		std::lock_guard<std::mutex>	lock(queues_mutex_);
+
+		queues_.push_back(std::unique_ptr<ProducerQueue>(new ProducerQueue(queue_capacity_)));
+		queue_count_.store(queues_.size(), std::memory_order_release);
+		thread_queues.push_back(std::make_pair(id_, queues_.back().get()));
+
+		return *queues_.back();
+	}
+
+	//----------------------------------------------------------------------------------
+	// Queue the text for the background thread.  This never waits: if the thread's
+	// queue is full the text is dropped.
+	void	AsyncFdSink::Write(const std::string& in_text)
+	{
+		ProducerQueue&	producer = GetQueue();
+
+		if (!producer.queue_.TryPush(in_text))
+		{
+			producer.dropped_.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	// Wait until the background thread has written everything queued so far.  The
+	// queues are checked before the busy flag because the writer sets the flag before
+	// it takes any text.
+	void	AsyncFdSink::Flush()
+	{
+		while (!AllEmpty() || busy_.load())
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+	}
+
+	bool	AsyncFdSink::AllEmpty() const
+	{
+		std::lock_guard<std::mutex>	lock(queues_mutex_);
+
+		for (const std::unique_ptr<ProducerQueue>& producer : queues_)
+		{
+			if (!producer->queue_.empty())
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	std::size_t	AsyncFdSink::GetDropped() const
+	{
+		std::lock_guard<std::mutex>	lock(queues_mutex_);
+		std::size_t					dropped = 0;
+
+		for (const std::unique_ptr<ProducerQueue>& producer : queues_)
+		{
+			dropped += producer->dropped_.load(std::memory_order_relaxed);
+		}
+
+		return dropped;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Move the queued text to the output until the sink is destroyed.  The text from
+	// each pass over the queues is gathered into one buffer so it is written with as
+	// few calls as possible.  The list of queues is only copied when a thread has added
+	// one so the lock is rarely taken.
+	void	AsyncFdSink::WriteQueued()
+	{
+		static const std::size_t	kMaxBuffer = 64 * 1024;
+
+		std::vector<ProducerQueue*>	producers;
+		std::string					buffer;
+		std::string					text;
+
+		while (true)
+		{
+			bool	stopping = stop_.load(std::memory_order_acquire);
+
+			if (producers.size() != queue_count_.load(std::memory_order_acquire))
+			{
+				std::lock_guard<std::mutex>	lock(queues_mutex_);
+
+				producers.clear();
+
+				for (std::unique_ptr<ProducerQueue>& producer : queues_)
+				{
+					producers.push_back(producer.get());
+				}
+			}
+
+			busy_.store(true);
+
+			std::size_t	taken = 0;
+
+			for (ProducerQueue* producer : producers)
+			{
+				while (producer->queue_.TryPop(text))
+				{
+					buffer.append(text);
+					text.clear();
+					taken++;
+
+					if (buffer.size() >= kMaxBuffer)
+					{
+						WriteFd(buffer);
+						buffer.clear();
+					}
+				}
+			}
+
+			WriteFd(buffer);
+			buffer.clear();
+			written_.fetch_add(taken, std::memory_order_relaxed);
+
+			busy_.store(false);
+
+			if (taken == 0)
+			{
+				if (stopping)
+				{
+					break;
+				}
+
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+			}
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	// Write a buffer to the file descriptor, continuing after partial writes.  Text is
+	// discarded if the descriptor is not open or the write fails.
+	void	AsyncFdSink::WriteFd(const std::string& in_buffer)
+	{
+		const char*	data = in_buffer.data();
+		std::size_t	remaining = in_buffer.size();
+
+		while ((remaining > 0) && (fd_ >= 0))
+		{
+#if defined(_WIN32)
+			int		count = _write(fd_, data, static_cast<unsigned int>(remaining));
+#else
+			long	count = static_cast<long>(::write(fd_, data, remaining));
+#endif
+			if (count <= 0)
+			{
+				break;
+			}
+
+			data += count;
+			remaining -= static_cast<std::size_t>(count);
+		}
+	}
+
+}
@@ -1,16 +1,94 @@
-#pragma once
+#include <iostream>
+#include <string>
 
+#include "command_line.h"
 #include "mirr_test.h"
+#include "mirr_bench.h"
 
 //----------------------------------------------------------------------------------
-//	Main entry point for test to calculate modified IRR.
+//	Run the tests.  Returns whether or not they all matched.
 //----------------------------------------------------------------------------------
-int main(int argc, char argv[]) {
+static bool	RunTests() {
 
-	//TestCashFlowList();
-	//TestNPV();
-	TestMIRR();
+	bool	matched = true;
 
-	return 0;
+	matched &= TestDates();
+	matched &= TestParseDate();
+	matched &= TestCashFlowList();
+	matched &= TestCashFlowListAssign();
+	matched &= TestNPV();
+	matched &= TestCashFlowColumns();
+	matched &= TestCashFlowPlan();
+	matched &= TestCompounding();
+	matched &= TestDiscountWalk();
+	matched &= TestPeriodicCashFlows();
+	matched &= TestMultiRateNPV();
+	matched &= TestMIRR();
+	matched &= TestPrecision();
+	matched &= TestMixedPrecision();
+	matched &= TestBracketLowestRate();
+	matched &= TestFindRates();
+	matched &= TestBatchCalculator();
+	matched &= TestIncrementalCalculator();
+	matched &= TestSolverTrace();
+	matched &= TestAsyncLogSink();
+	matched &= TestCsvReader();
+	matched &= TestCashFlowFile();
+	matched &= TestCommandLine();
 
-}
\ No newline at end of file
+	return matched;
+
+}
+
+//----------------------------------------------------------------------------------
+//	Run the benchmarks.
+//----------------------------------------------------------------------------------
+static void	RunBenchmarks() {
+
+	BenchNPVKernels();
+	BenchMultiRateNPV();
+	BenchCompounding();
+	BenchDiscountWalk();
+	BenchPeriodicCashFlows();
+	BenchSolverMethods();
+	BenchCallableOverhead();
+	BenchSeedStrategies();
+	BenchSolverLogging();
+	BenchDateParsing();
+	BenchBulkLoad();
+	BenchCsvIngest();
+	BenchCashFlowFile();
+	BenchPrecision();
+	BenchMixedPrecision();
+
+}
+
+//----------------------------------------------------------------------------------
+//	Main entry point: find the rate of every account in a file of cash flows, or run
+//	the tests or benchmarks.
+//----------------------------------------------------------------------------------
+int main(int argc, char* argv[]) {
+
+	mirr::CommandLineOptions	options;
+	std::string					error;
+
+	if (!mirr::ParseCommandLine(argc, argv, options, error)) {
+		std::cerr << "mirr: " << error << std::endl;
+		mirr::PrintUsage(std::cerr);
+		return 1;
+	}
+
+	switch (options.command_) {
+	case mirr::command_e::command_help:
+		mirr::PrintUsage(std::cout);
+		return 0;
+	case mirr::command_e::command_test:
+		return RunTests() ? 0 : 4;
+	case mirr::command_e::command_bench:
+		RunBenchmarks();
+		return 0;
+	default:
+		return mirr::RunCommandLine(options);
+	}
+
+}
@@ -0,0 +1,150 @@
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mapped_file.h"
+
+namespace mirr {
+
+	//----------------------------------------------------------------------------------
+	// Constructor and destructor
+	MappedFile::MappedFile(const std::string& in_path)
+	{
+		Open(in_path);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	//----------------------------------------------------------------------------------
+	// Map a file read-only.  On POSIX systems the kernel is told the file will be read
+	// sequentially so it reads ahead.
+	bool	MappedFile::Open(const std::string& in_path)
+	{
+		Close();
+
+#if defined(_WIN32)
+		HANDLE	file = CreateFileA(in_path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+									FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER	file_size;
+
+		if (!GetFileSizeEx(file, &file_size))
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		size_ = static_cast<std::size_t>(file_size.QuadPart);
+		file_handle_ = file;
+
+		if (size_ > 0)
+		{
+			HANDLE	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+			if (mapping == NULL)
+			{
+				Close();
+				return false;
+			}
+
+			mapping_handle_ = mapping;
+			data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+
+			if (data_ == nullptr)
+			{
+				Close();
+				return false;
+			}
+		}
+#else
+		int	fd = ::open(in_path.c_str(), O_RDONLY);
+
+		if (fd < 0)
+		{
+			return false;
+		}
+
+		struct stat	file_status;
+
+		if (::fstat(fd, &file_status) != 0)
+		{
+			::close(fd);
+			return false;
+		}
+
+		size_ = static_cast<std::size_t>(file_status.st_size);
+
+		if (size_ > 0)
+		{
+			void*	mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+
+			if (mapping == MAP_FAILED)
+			{
+				::close(fd);
+				size_ = 0;
+				return false;
+			}
+
+			::madvise(mapping, size_, MADV_SEQUENTIAL);
+			data_ = static_cast<const char*>(mapping);
+		}
+
+		// The mapping stays valid after the file is closed.
+
+		::close(fd);
+#endif
+
+		open_ = true;
+
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Unmap the file.
+	void	MappedFile::Close()
+	{
+#if defined(_WIN32)
+		if (data_ != nullptr)
+		{
+			UnmapViewOfFile(data_);
+		}
+
+		if (mapping_handle_ != nullptr)
+		{
+			CloseHandle(mapping_handle_);
+		}
+
+		if (file_handle_ != nullptr)
+		{
+			CloseHandle(file_handle_);
+		}
+
+		mapping_handle_ = nullptr;
+		file_handle_ = nullptr;
+#else
+		if (data_ != nullptr)
+		{
+			::munmap(const_cast<char*>(data_), size_);
+		}
+#endif
+
+		data_ = nullptr;
+		size_ = 0;
+		open_ = false;
+	}
+
+};
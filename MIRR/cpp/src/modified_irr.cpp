@@ -1,6 +1,11 @@
 #include "modified_irr.h"
+#include "cash_flow_plan.h"
 #include "date_math.h"
 #include "roots.h"
+#include "npv_kernels.h"
+
+#include <cmath>
+#include <limits>
 
 namespace mirr {
 
@@ -33,8 +38,7 @@ namespace mirr {
 	// another.
 	bool	CashFlow::operator<(const CashFlow& in_rhs)
 	{
-		double	difference = dates::GetDifferenceSeconds(date_, in_rhs.date_);
-		return (difference < 0);
+		return (date_ < in_rhs.date_);
 	}
 
 	//----------------------------------------------------------------------------------
@@ -42,8 +46,7 @@ namespace mirr {
 	// another.
 	bool	CashFlow::operator>(const CashFlow& in_rhs)
 	{
-		double	difference = dates::GetDifferenceSeconds(date_, in_rhs.date_);
-		return (difference > 0);
+		return (date_ > in_rhs.date_);
 	}
 
 	//----------------------------------------------------------------------------------
@@ -80,6 +83,7 @@ namespace mirr {
 		insert(begin(), in_rhs.begin(), in_rhs.end());
 		start_date_ = in_rhs.start_date_;
 		end_date_ = in_rhs.end_date_;
+		sorted_ = in_rhs.sorted_;
 	}
 
 	//----------------------------------------------------------------------------------
@@ -90,12 +94,21 @@ namespace mirr {
 		if (size() == 0)
 		{
 			start_date_ = in_new.date_;
+			in_new.days_from_start_ = 0;
+			sorted_ = true;
 		} else
 		{
-			long	days_from_start = std::lround(dates::GetDifferenceDays(in_new.date_, start_date_));
+			long	days_from_start = static_cast<long>(in_new.date_ - start_date_);
+
+			if (in_new.date_ < back().date_)
+			{
+				sorted_ = false;
+			}
+
 			if (days_from_start < 0)
 			{
 				start_date_ = in_new.date_;
+				days_from_start = 0; // The new cash flow is the start.
 
 				if (size() > 0)
 				{
@@ -105,7 +118,7 @@ namespace mirr {
 
 					for (CashFlow& cash_flow : (*this))
 					{
-						cash_flow.days_from_start_ = std::lround(dates::GetDifferenceDays(cash_flow.date_, start_date_));
+						cash_flow.days_from_start_ = static_cast<long>(cash_flow.date_ - start_date_);
 					}
 				}
 			}
@@ -117,35 +130,175 @@ namespace mirr {
 
 	}
 
+	//----------------------------------------------------------------------------------
+	// Replace the cash flows with ones in any order.
+	void	CashFlowList::Assign(const std::vector<CashFlow>& in_cash_flows)
+	{
+		clear();
+		insert(begin(), in_cash_flows.begin(), in_cash_flows.end());
+		Finalize();
+	}
+
+	//----------------------------------------------------------------------------------
+	// Sort the cash flows by date, merge the cash flows on the same day and calculate
+	// the days from the start.  The merged amounts are added in their original order.
+	void	CashFlowList::Finalize()
+	{
+		std::stable_sort(begin(), end(),
+			[](const CashFlow& in_lhs, const CashFlow& in_rhs) { return in_lhs.date_ < in_rhs.date_; });
+
+		std::size_t	merged_count = 0;
+
+		for (std::size_t i = 0; i < size(); i++)
+		{
+			if ((merged_count > 0) && ((*this)[merged_count - 1].date_ == (*this)[i].date_))
+			{
+				(*this)[merged_count - 1].amount_ += (*this)[i].amount_;
+			}
+			else
+			{
+				if (merged_count != i)
+				{
+					(*this)[merged_count] = (*this)[i];
+				}
+				merged_count++;
+			}
+		}
+
+		erase(begin() + merged_count, end());
+
+		if (size() > 0)
+		{
+			start_date_ = front().date_;
+			end_date_ = back().date_;
+		}
+
+		for (CashFlow& cash_flow : (*this))
+		{
+			cash_flow.days_from_start_ = static_cast<long>(cash_flow.date_ - start_date_);
+		}
+
+		sorted_ = true;
+	}
+
 	//----------------------------------------------------------------------------------
 	// Return the number of days between the start and end dates of the list.
 	long	CashFlowList::GetDaysInRange()
 	{
 		long	result = 0;
 
-		if (size() > 0)
+		if ((size() > 0) && sorted_)
+		{
+			start_date_ = front().date_;
+			end_date_ = back().date_;
+			result = static_cast<long>(end_date_ - start_date_);
+		}
+		else if (size() > 0)
 		{
 			std::vector<CashFlow>::const_iterator start = std::min_element(std::begin(*this), std::end(*this));
 			std::vector<CashFlow>::const_iterator end = std::max_element(std::begin(*this), std::end(*this));
 
 			start_date_ = (*start).date_;
 			end_date_ = (*end).date_;
-			result = std::lround(dates::GetDifferenceDays((*end).date_, (*start).date_));
+			result = static_cast<long>((*end).date_ - (*start).date_);
 		}
 
 		return result;
 	}
 
+	//----------------------------------------------------------------------------------
+	// Find the grid of months that in_count dates from the earliest, in_start_date, fall
+	// on.  Each date's months from the first are counted from their calendar months and
+	// it is only on the grid if AddMonths() of the first date by that many months is the
+	// date.  The grid is the greatest common divisor of the months.
+	template <class DATE_FUNCTION_T>
+	static int	FindMonthlyGrid(dates::Date_t in_start_date, std::size_t in_count, DATE_FUNCTION_T&& in_date,
+								std::vector<std::size_t>& out_periods)
+	{
+		int					grid_months = 0;
+		dates::CivilDate	start = dates::CivilFromDays(in_start_date);
+
+		out_periods.clear();
+		out_periods.reserve(in_count);
+
+		for (std::size_t i = 0; i < in_count; i++)
+		{
+			dates::Date_t		cash_flow_date = (in_date)(i);
+			dates::CivilDate	date = dates::CivilFromDays(cash_flow_date);
+			int					months = ((date.year_ - start.year_) * 12) + (static_cast<int>(date.month_) - static_cast<int>(start.month_));
+
+			if (dates::AddMonths(in_start_date, months) != cash_flow_date)
+			{
+				out_periods.clear();
+				return 0;
+			}
+
+			for (int divisor = months; divisor != 0; )
+			{
+				int	remainder = grid_months % divisor;
+
+				grid_months = divisor;
+				divisor = remainder;
+			}
+
+			out_periods.push_back(static_cast<std::size_t>(months));
+		}
+
+		if (grid_months == 0)
+		{
+			// The cash flows are all on the same day.
+			out_periods.clear();
+			return 0;
+		}
+
+		for (std::size_t& period : out_periods)
+		{
+			period /= static_cast<std::size_t>(grid_months);
+		}
+
+		return grid_months;
+	}
+
+	int		CashFlowList::FindMonthlyGrid(std::vector<std::size_t>& out_periods) const
+	{
+		out_periods.clear();
+
+		if (size() < 2)
+		{
+			return 0;
+		}
+
+		dates::Date_t	start_date = sorted_ ? front().date_ :
+							std::min_element(begin(), end(),
+								[](const CashFlow& in_lhs, const CashFlow& in_rhs) { return in_lhs.date_ < in_rhs.date_; })->date_;
+
+		return mirr::FindMonthlyGrid(start_date, size(), [this](std::size_t in_index) { return (*this)[in_index].date_; }, out_periods);
+	}
+
 	//----------------------------------------------------------------------------------
 	// Given a discount rate, calculate the value of the serie sof 
 	// cash flows discounted by that rate.
 	NPV_t	CashFlowList::calculateNPV(const Rate_t& in_daily_discount_rate)
 	{
-		NPV_t	result = 0.0;
-		Rate_t	power_rate = (1.0 + in_daily_discount_rate);
-		Rate_t	discount_exponent = 0.0;
-		Rate_t	discount_denom = 1.0;
-		NPV_t	discounted_cash_flow = 0.0;
+		return calculateNPV<LongDoublePrecision>(in_daily_discount_rate);
+	}
+
+	NPV_t	CashFlowList::calculateNPV(const Rate_t& in_daily_discount_rate, compounding_e in_compounding)
+	{
+		return calculateNPV<LongDoublePrecision>(in_daily_discount_rate, in_compounding);
+	}
+
+	template <class PRECISION_T>
+	typename PRECISION_T::value_t	CashFlowList::calculateNPV(const typename PRECISION_T::value_t& in_daily_discount_rate,
+																compounding_e in_compounding)
+	{
+		using value_t = typename PRECISION_T::value_t;
+
+		typename PRECISION_T::sum_t	result;
+		value_t	power_rate = (static_cast<value_t>(1.0) + in_daily_discount_rate);
+		value_t	discount_exponent = 0.0;
+		value_t	discount_denom = 1.0;
+		value_t	discounted_cash_flow = 0.0;
 
 		static const double	kDaysInYear = 365.0;
 
@@ -158,20 +311,28 @@ namespace mirr {
 			return 0.0;
 		}
 
-		CashFlowList::iterator	last_cash_flow = std::max_element(begin(), end());
+		CashFlowList::iterator	last_cash_flow = sorted_ ? (end() - 1) : std::max_element(begin(), end());
 
 		for (CashFlow& cash_flow : *this)
 		{
-			// Calculate a since inception rate.
-			
-			discount_exponent = static_cast<Rate_t>(cash_flow.days_from_start_) 
-									/ static_cast<Rate_t>((*last_cash_flow).days_from_start_);
-
-			// Calculate an annual rate (like XIRR in Excel).
-			//discount_exponent = static_cast<Rate_t>(cash_flow.days_from_start_) / static_cast<Rate_t>(kDaysInYear);
-
-			// Calculate an daily rate.
-			//discount_exponent = static_cast<Rate_t>(cash_flow.days_from_start_);
+			switch (in_compounding)
+			{
+			case compounding_e::annual:
+				// Calculate an annual rate (like XIRR in Excel).
+				discount_exponent = static_cast<value_t>(cash_flow.days_from_start_) / static_cast<value_t>(kDaysInYear);
+				break;
+
+			case compounding_e::daily:
+				// Calculate an daily rate.
+				discount_exponent = static_cast<value_t>(cash_flow.days_from_start_);
+				break;
+
+			default:
+				// Calculate a since inception rate.
+				discount_exponent = static_cast<value_t>(cash_flow.days_from_start_) 
+										/ static_cast<value_t>((*last_cash_flow).days_from_start_);
+				break;
+			}
 
 			// Calculate the denominator as the compounded discount rate raised 
 			// to the power of the number of subperiods.
@@ -180,82 +341,639 @@ namespace mirr {
 
 			if (discount_denom != 0.0) // For divide by zero
 			{
-				discounted_cash_flow = static_cast<NPV_t>(cash_flow.amount_) / discount_denom;
-				result += discounted_cash_flow;
+				discounted_cash_flow = static_cast<value_t>(cash_flow.amount_) / discount_denom;
+				result.Add(discounted_cash_flow);
+			}
+		}
+
+		return result.Get();
+	}
+
+	// Instantiate the calculation for each numeric policy.
+	template FloatPrecision::value_t	CashFlowList::calculateNPV<FloatPrecision>(const FloatPrecision::value_t&, compounding_e);
+	template DoublePrecision::value_t	CashFlowList::calculateNPV<DoublePrecision>(const DoublePrecision::value_t&, compounding_e);
+	template LongDoublePrecision::value_t	CashFlowList::calculateNPV<LongDoublePrecision>(const LongDoublePrecision::value_t&, compounding_e);
+	template CompensatedDoublePrecision::value_t	CashFlowList::calculateNPV<CompensatedDoublePrecision>(const CompensatedDoublePrecision::value_t&, compounding_e);
+
+	//----------------------------------------------------------------------------------
+	// Given a discount rate, calculate the value of the series of cash flows discounted
+	// by that rate.  This is the same calculation as the list's but it reads the
+	// contiguous columns and the latest day is already known.
+	NPV_t	CashFlowView::calculateNPV(const Rate_t& in_daily_discount_rate) const
+	{
+		NPV_t	result = 0.0;
+		Rate_t	power_rate = (1.0 + in_daily_discount_rate);
+		Rate_t	last_day = static_cast<Rate_t>(last_day_);
+		Rate_t	discount_denom = 1.0;
+
+		if (in_daily_discount_rate == -1.0)
+		{
+			return 0.0;
+		}
+
+		for (std::size_t i = 0; i < size_; i++)
+		{
+			// Calculate a since inception rate.
+
+			discount_denom = std::pow(power_rate, static_cast<Rate_t>(days_[i]) / last_day);
+
+			if (discount_denom != 0.0) // For divide by zero
+			{
+				result += ((amounts_ != nullptr) ? static_cast<NPV_t>(amounts_[i]) : static_cast<NPV_t>(amounts_double_[i])) / discount_denom;
 			}
 		}
 
 		return result;
 	}
 
+	//----------------------------------------------------------------------------------
+	// Find the grid of months the cash flows fall on as for a list.  The dates are the
+	// start date plus the days, so a view without a start date is never on a grid.
+	int		CashFlowView::FindMonthlyGrid(std::vector<std::size_t>& out_periods) const
+	{
+		out_periods.clear();
+
+		if ((start_date_ == nullptr) || (size_ < 2))
+		{
+			return 0;
+		}
+
+		dates::Date_t	start_date = *start_date_ + *std::min_element(days_, days_ + size_);
+
+		return mirr::FindMonthlyGrid(start_date, size_,
+					[this](std::size_t in_index) { return static_cast<dates::Date_t>(*start_date_ + days_[in_index]); }, out_periods);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Calculate the NPV in double precision.  The power is found as
+	// exp(days * log(1 + rate) / last_day) so that the kernel only evaluates exp().
+	double	CashFlowView::calculateNPVDouble(double in_daily_discount_rate) const
+	{
+		if (in_daily_discount_rate == -1.0)
+		{
+			return 0.0;
+		}
+
+		double	scale = std::log1p(in_daily_discount_rate) / static_cast<double>(last_day_);
+
+		return (kernels::GetNPVKernel())(days_, amounts_double_, size_, scale);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Constructor
+	CashFlowColumns::CashFlowColumns(const CashFlowList& in_cash_flows)
+	{
+		Assign(in_cash_flows);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Replace the columns with the cash flows in the list.
+	void	CashFlowColumns::Assign(const CashFlowList& in_cash_flows)
+	{
+		clear();
+		days_.reserve(in_cash_flows.size());
+		amounts_.reserve(in_cash_flows.size());
+		amounts_double_.reserve(in_cash_flows.size());
+
+		for (const CashFlow& cash_flow : in_cash_flows)
+		{
+			push_back(static_cast<Day_t>(cash_flow.days_from_start_), cash_flow.amount_);
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	// Add a cash flow to the end of the columns.
+	void	CashFlowColumns::push_back(Day_t in_days_from_start, const CashFlowAmt_t& in_amount)
+	{
+		days_.push_back(in_days_from_start);
+		amounts_.push_back(in_amount);
+		amounts_double_.push_back(static_cast<double>(in_amount));
+		last_day_ = std::max(last_day_, in_days_from_start);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Remove all of the cash flows.
+	void	CashFlowColumns::clear()
+	{
+		days_.clear();
+		amounts_.clear();
+		amounts_double_.clear();
+		last_day_ = 0;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return a view of the columns for calculations.
+	CashFlowView	CashFlowColumns::GetView() const
+	{
+		CashFlowView	view;
+
+		view.days_ = days_.data();
+		view.amounts_ = amounts_.data();
+		view.amounts_double_ = amounts_double_.data();
+		view.size_ = days_.size();
+		view.last_day_ = last_day_;
+
+		return view;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Compile the cash flows into a plan once so that each NPV calculated during the
+	// search does not need to find the last cash flow or recalculate the exponents.
+	template <class PRECISION_T>
+	typename BasicCalculator<PRECISION_T>::value_t	BasicCalculator<PRECISION_T>::GetRate(CashFlowList& in_cash_flows)
+	{
+		CashFlowPlan	plan(in_cash_flows, options_.compounding_);
+
+		return GetRate(plan);
+	}
+
+	template <class PRECISION_T>
+	typename BasicCalculator<PRECISION_T>::value_t	BasicCalculator<PRECISION_T>::GetRate(const CashFlowView& in_cash_flows)
+	{
+		CashFlowPlan	plan(in_cash_flows, options_.compounding_);
+
+		return GetRate(plan);
+	}
+
 	//----------------------------------------------------------------------------------
 	// Using a root finding routine to iteratively search for the solution/root 
 	// to make the series of cash flows equal zero.
-	Rate_t Calculator::GetRate(CashFlowList& in_cash_flows)
+	template <class PRECISION_T>
+	typename BasicCalculator<PRECISION_T>::value_t	BasicCalculator<PRECISION_T>::GetRate(const CashFlowPlan& in_plan)
 	{
-		Rate_t	result = 0.0;
-		Rate_t	low_estimate = -0.99999;
-		Rate_t	high_estimate = +1.0;
-		
-		static const	int	kMaxIterations = 100;
+		value_t	result = 0.0;
+		value_t	low_estimate = static_cast<value_t>(-0.99999);
+		value_t	high_estimate = +1.0;
 
-		int				count = 0;
-		bool			searching = true;
+		status_ = solve_status_e::failed;
+		iterations_ = 0;
+		evaluations_ = 0;
+		residual_ = std::numeric_limits<value_t>::quiet_NaN();
+		trace_.clear();
 
-		roots::RootFinder<Rate_t>	root_finder;
-		roots::RangeException::relative_to_solution_e	err_cause = roots::RangeException::relative_to_solution_e::unknown;
+		// Without both positive and negative cash flows the NPV never crosses zero so
+		// there is no range of estimates to search for.
 
-		// Wrap the call to the root finding in a loop.  The root finding
-		// algorithm expects initial estimates that are on either side (+ and -)
-		// of the eventual solution.  This loop is to adjust the estimates
-		// passed to the routine until bracketing estimates are found.
+		if (!in_plan.HasRoot())
+		{
+			status_ = solve_status_e::not_bracketed;
+			return result;
+		}
+
+		// The NPV of cash flows on a grid of months is close to a polynomial in the
+		// discount per period whose root is found by Horner's scheme with no exp() or
+		// pow().  Converted to the plan's compounding it is usually within a few Newton
+		// steps of the rate.
 
-		while (searching)
+		if (options_.periodic_ && (options_.precision_ == solve_precision_e::full_precision) && in_plan.IsPeriodic())
 		{
-			try
+			Rate_t	periodic_rate = in_plan.GetPeriodicRate();
+			value_t	estimate = static_cast<value_t>(in_plan.ConvertPeriodicRate(periodic_rate));
+
+			if (std::isfinite(estimate) && (estimate > -1.0))
 			{
-				err_cause = roots::RangeException::relative_to_solution_e::unknown;
+				return SearchFromRate(in_plan, estimate, "periodic estimate");
+			}
+		}
+
+		// The root finding algorithm expects initial estimates that are on either side
+		// (+ and -) of the eventual solution.  Widen the estimates until they are.  The
+		// range is grown in terms of log(1 + rate) so that it can extend to very high rates
+		// in a few steps while never reaching a rate of -100% or below.  The estimates are
+		// for the whole range so they are scaled to the plan's compounding, e.g. to the
+		// equivalent daily rates.
+
+		value_t	periods = static_cast<value_t>(in_plan.GetPeriodsInRange());
+		value_t	log_low_estimate = std::log1p(low_estimate) / periods;
+		value_t	log_high_estimate = std::log1p(high_estimate) / periods;
+
+		// A seed calculated from the cash flows is usually close to the rate so start with
+		// a narrow range around it instead.  If the seed cannot be calculated (or is not
+		// above -100%) use the fixed range.
+
+		value_t	seed = std::numeric_limits<value_t>::quiet_NaN();
+
+		switch (options_.seed_)
+		{
+		case seed_strategy_e::modified_dietz:
+			seed = static_cast<value_t>(in_plan.GetModifiedDietzRate());
+			break;
+		case seed_strategy_e::taylor:
+			seed = static_cast<value_t>(in_plan.GetTaylorRate());
+			break;
+		case seed_strategy_e::fixed_bracket:
+			break;
+		}
+
+		if (std::isfinite(seed) && (seed > -1.0))
+		{
+			value_t	log_seed = std::log1p(seed);
+			value_t	seed_width = static_cast<value_t>(options_.seed_width_) / periods;
+
+			log_low_estimate = log_seed - seed_width;
+			log_high_estimate = log_seed + seed_width;
+		}
+
+		return SearchFromEstimates(in_plan, log_low_estimate, log_high_estimate);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Search again starting from the rate found before the cash flows changed.  When one
+	// cash flow is appended the rate usually moves only slightly, so unbracketed Newton
+	// steps from the previous rate converge in one to three evaluations.  If they do not
+	// (e.g. the NPV has an extremum nearby) fall back to searching a bracket seeded around
+	// the previous rate.
+	template <class PRECISION_T>
+	typename BasicCalculator<PRECISION_T>::value_t	BasicCalculator<PRECISION_T>::GetRate(const CashFlowPlan& in_plan, const value_t& in_previous_rate)
+	{
+		value_t	result = 0.0;
+
+		status_ = solve_status_e::failed;
+		iterations_ = 0;
+		evaluations_ = 0;
+		residual_ = std::numeric_limits<value_t>::quiet_NaN();
+		trace_.clear();
+
+		if (!in_plan.HasRoot())
+		{
+			status_ = solve_status_e::not_bracketed;
+			return result;
+		}
+
+		if (!std::isfinite(in_previous_rate) || (in_previous_rate <= -1.0))
+		{
+			return GetRate(in_plan);
+		}
+
+		return SearchFromRate(in_plan, in_previous_rate, "warm start");
+	}
+
+	//----------------------------------------------------------------------------------
+	// Take up to four Newton steps from the estimate and search a bracket seeded around
+	// it if they do not converge.
+	template <class PRECISION_T>
+	typename BasicCalculator<PRECISION_T>::value_t	BasicCalculator<PRECISION_T>::SearchFromRate(const CashFlowPlan& in_plan,
+																		const value_t& in_estimate, const char* in_description)
+	{
+		value_t	result = 0.0;
+
+		static const	long	kMaxPolishIterations = 4;
+
+		roots::RootFinder<value_t>	root_finder;
+
+		root_finder.trace_ = &trace_;
+
+		bool	polished = root_finder.PolishRoot(in_estimate,
+							[&in_plan](const value_t& in_rate) -> roots::Derivatives<value_t>
+							{
+								roots::Derivatives<value_t>				result;
+								BasicNPVDerivatives<value_t>	npv = in_plan.calculateNPVDerivatives<PRECISION_T>(in_rate, false);
+
+								result.value_ = npv.npv_;
+								result.first_ = npv.first_;
+
+								return result;
+							},
+							false, kMaxPolishIterations, result
+						);
+
+		iterations_ += root_finder.GetIterations();
+		evaluations_ += root_finder.GetEvaluations();
+
+		if (polished && (result > -1.0))
+		{
+			calc_log.MoveFrom(root_finder.calc_log);
+			status_ = solve_status_e::solved;
+
+			LOG_IF_LOGGED(calc_log, info) << "IRR = " << result << " (" << in_description << " from " << in_estimate << ")" << endl;
+
+			PrintLog();
+
+			return result;
+		}
 
-				result = root_finder.SearchForRoot(low_estimate, high_estimate,
-								[this, &in_cash_flows](const Rate_t& in_rate) -> Rate_t
+		long	polish_iterations = iterations_;
+		long	polish_evaluations = evaluations_;
+		value_t	log_estimate = std::log1p(in_estimate);
+		value_t	seed_width = static_cast<value_t>(options_.seed_width_ / in_plan.GetPeriodsInRange());
+
+		result = SearchFromEstimates(in_plan, log_estimate - seed_width, log_estimate + seed_width);
+
+		iterations_ += polish_iterations;
+		evaluations_ += polish_evaluations;
+
+		return result;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Widen the estimates until they bracket the rate and search the bracket.
+	template <class PRECISION_T>
+	typename BasicCalculator<PRECISION_T>::value_t	BasicCalculator<PRECISION_T>::SearchFromEstimates(const CashFlowPlan& in_plan,
+																		value_t in_log_low_estimate, value_t in_log_high_estimate)
+	{
+		if (options_.precision_ == solve_precision_e::mixed_precision)
+		{
+			return SearchMixedPrecision(in_plan, in_log_low_estimate, in_log_high_estimate);
+		}
+
+		value_t	result = 0.0;
+
+		static const	long	kMaxExpansions = 60;
+
+		// The low end of the bracket is not widened past the lowest rate above -100% that
+		// value_t can represent.  Below it expm1() returns exactly -1, where the NPV is
+		// taken to be zero, and that would be mistaken for a root.
+
+		const value_t	kLowestLogRate = std::log(std::numeric_limits<value_t>::epsilon());
+
+		roots::RootFinder<value_t>	root_finder;
+
+		root_finder.trace_ = &trace_;
+
+		status_ = solve_status_e::failed;
+		iterations_ = 0;
+		evaluations_ = 0;
+		residual_ = std::numeric_limits<value_t>::quiet_NaN();
+
+		roots::Bracket<value_t>	bracket = roots::FindBracket(in_log_low_estimate, in_log_high_estimate,
+									[&in_plan](const value_t& in_log_rate) -> value_t
+									{
+										return in_plan.calculateNPV<PRECISION_T>(std::expm1(in_log_rate));
+									},
+									kMaxExpansions, static_cast<value_t>(1.6), kLowestLogRate
+								);
+
+		evaluations_ += bracket.evaluations_;
+
+		if (!bracket.found_)
+		{
+			status_ = solve_status_e::not_bracketed;
+			LOG_IF_LOGGED(calc_log, info) << "IRR not bracketed after " << bracket.evaluations_ << " evaluations" << endl;
+
+			PrintLog();
+
+			return result;
+		}
+
+		// If the bracket had to be widened it can span several orders of magnitude of the
+		// rate, so search it in terms of log(1 + rate) as well.  Otherwise search the rate
+		// directly.
+
+		bool	use_log_rate = (bracket.evaluations_ > 2);
+
+		if (!use_log_rate)
+		{
+			bracket.low_ = std::expm1(bracket.low_);
+			bracket.high_ = std::expm1(bracket.high_);
+		}
+
+		if (options_.method_ == solver_method_e::brent)
+		{
+			result = root_finder.SearchForRoot(bracket,
+							[&in_plan, use_log_rate](const value_t& in_rate) -> value_t
+							{
+								return in_plan.calculateNPV<PRECISION_T>(use_log_rate ? std::expm1(in_rate) : in_rate);
+							}
+						);
+		}
+		else
+		{
+			// Newton only needs the first derivative so skip the second.  With
+			// x = log(1 + rate), dNPV/dx = NPV' * (1 + rate) and
+			// d2NPV/dx2 = NPV'' * (1 + rate)^2 + NPV' * (1 + rate).
+
+			bool	use_halley = (options_.method_ == solver_method_e::halley);
+
+			result = root_finder.SearchForRootNewton(bracket,
+							[&in_plan, use_halley, use_log_rate](const value_t& in_rate) -> roots::Derivatives<value_t>
+							{
+								roots::Derivatives<value_t>	result;
+
+								if (use_log_rate)
 								{
-									return in_cash_flows.calculateNPV(in_rate);
+									value_t							power_rate = std::exp(in_rate);
+									BasicNPVDerivatives<value_t>	npv = in_plan.calculateNPVDerivatives<PRECISION_T>(std::expm1(in_rate), use_halley);
+
+									result.value_ = npv.npv_;
+									result.first_ = npv.first_ * power_rate;
+									result.second_ = (npv.second_ * power_rate * power_rate) + result.first_;
+								}
+								else
+								{
+									BasicNPVDerivatives<value_t>	npv = in_plan.calculateNPVDerivatives<PRECISION_T>(in_rate, use_halley);
+
+									result.value_ = npv.npv_;
+									result.first_ = npv.first_;
+									result.second_ = npv.second_;
+								}
+
+								return result;
+							},
+							use_halley
+						);
+		}
+
+		if (use_log_rate)
+		{
+			result = std::expm1(result);
+		}
+
+		iterations_ += root_finder.GetIterations();
+		evaluations_ += root_finder.GetEvaluations();
+		calc_log.MoveFrom(root_finder.calc_log);
+		status_ = solve_status_e::solved;
+
+		LOG_IF_LOGGED(calc_log, info) << "IRR = " << result << endl;
+
+		PrintLog();
+
+		return result;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Find the bracket and search it with Brent's method using the double vector kernel,
+	// which is several times faster than the calculator's own NPV, and then take up to
+	// two Newton steps from that rate with the NPV in the calculator's precision.  The
+	// double search is within its tolerance of the rate so one step is usually enough.
+	// The NPV at the final rate is kept as the residual.  Amounts near the limits of
+	// double can make the double NPV infinite or NaN where the calculator's is not; the
+	// rate is then reported as not bracketed if the ends of the bracket or the search
+	// are affected and as failed if the search gives a rate that is not finite.
+	template <class PRECISION_T>
+	typename BasicCalculator<PRECISION_T>::value_t	BasicCalculator<PRECISION_T>::SearchMixedPrecision(const CashFlowPlan& in_plan,
+																		value_t in_log_low_estimate, value_t in_log_high_estimate)
+	{
+		double	search_result = 0.0;
+		value_t	result = 0.0;
+
+		static const	long	kMaxExpansions = 60;
+		static const	long	kMaxPolishIterations = 2;
+
+		// As in SearchFromEstimates(), keep the low end above a rate of -100% in double.
+
+		const double	kLowestLogRate = std::log(std::numeric_limits<double>::epsilon());
+
+		roots::RootFinder<double>	root_finder;
+
+		root_finder.trace_ = &trace_;
+
+		status_ = solve_status_e::failed;
+		iterations_ = 0;
+		evaluations_ = 0;
+		residual_ = std::numeric_limits<value_t>::quiet_NaN();
+
+		roots::Bracket<double>	bracket = roots::FindBracket(static_cast<double>(in_log_low_estimate), static_cast<double>(in_log_high_estimate),
+									[&in_plan](const double& in_log_rate) -> double
+									{
+										return in_plan.calculateNPVDouble(std::expm1(in_log_rate));
+									},
+									kMaxExpansions, 1.6, kLowestLogRate
+								);
+
+		evaluations_ += bracket.evaluations_;
+
+		if (!bracket.found_)
+		{
+			status_ = solve_status_e::not_bracketed;
+			LOG_IF_LOGGED(calc_log, info) << "IRR not bracketed after " << bracket.evaluations_ << " evaluations" << endl;
+
+			PrintLog();
+
+			return result;
+		}
+
+		if (!std::isfinite(bracket.low_result_) || !std::isfinite(bracket.high_result_))
+		{
+			status_ = solve_status_e::not_bracketed;
+			LOG_IF_LOGGED(calc_log, info) << "IRR not bracketed: the double NPV is " << bracket.low_result_ << " and "
+				<< bracket.high_result_ << " at the ends of the bracket" << endl;
+
+			PrintLog();
+
+			return result;
+		}
+
+		bool	use_log_rate = (bracket.evaluations_ > 2);
+
+		if (!use_log_rate)
+		{
+			bracket.low_ = std::expm1(bracket.low_);
+			bracket.high_ = std::expm1(bracket.high_);
+		}
+
+		// The search still throws if the NPV inside the bracket does not keep the sign
+		// change, e.g. if it overflows there.
+
+		try
+		{
+			search_result = root_finder.SearchForRoot(bracket,
+								[&in_plan, use_log_rate](const double& in_rate) -> double
+								{
+									return in_plan.calculateNPVDouble(use_log_rate ? std::expm1(in_rate) : in_rate);
 								}
 							);
-				calc_log = root_finder.calc_log;
-			}
-			catch (roots::RangeException err)
-			{
-				// If the root was not within the range attempted, shift the range up or down
-				// depending on the exception and estimate again.
+		}
+		catch (roots::RangeException& in_exception)
+		{
+			iterations_ += root_finder.GetIterations();
+			evaluations_ += root_finder.GetEvaluations();
+			calc_log.MoveFrom(root_finder.calc_log);
+			status_ = solve_status_e::not_bracketed;
+			LOG_IF_LOGGED(calc_log, info) << "IRR not bracketed in the search: " << in_exception.what() << endl;
 
-				Rate_t	difference = std::abs(high_estimate - low_estimate);
-				
-				err_cause = err.relative_position_;
-				if (err_cause == roots::RangeException::relative_to_solution_e::too_low)
-				{
-					low_estimate = high_estimate;
-					high_estimate += difference;
-				}
-				else
+			PrintLog();
+
+			return result;
+		}
+
+		if (use_log_rate)
+		{
+			search_result = std::expm1(search_result);
+		}
+
+		iterations_ += root_finder.GetIterations();
+		evaluations_ += root_finder.GetEvaluations();
+		calc_log.MoveFrom(root_finder.calc_log);
+
+		if (!std::isfinite(search_result))
+		{
+			LOG_IF_LOGGED(calc_log, info) << "IRR search in double precision gave " << search_result << endl;
+
+			PrintLog();
+
+			return result;
+		}
+
+		// Polish the rate with the original cash flows.  If the steps do not converge (or
+		// leave the valid range) keep the double rate; the residual shows how close it is.
+
+		roots::RootFinder<value_t>	polisher;
+		value_t						polished = 0.0;
+
+		polisher.trace_ = &trace_;
+		result = static_cast<value_t>(search_result);
+
+		if (polisher.PolishRoot(result,
+				[&in_plan](const value_t& in_rate) -> roots::Derivatives<value_t>
 				{
-					high_estimate = low_estimate;
-					low_estimate -= difference;
-				}
-			}
+					roots::Derivatives<value_t>		result;
+					BasicNPVDerivatives<value_t>	npv = in_plan.calculateNPVDerivatives<PRECISION_T>(in_rate, false);
 
-			// Check if another iteration is required.
+					result.value_ = npv.npv_;
+					result.first_ = npv.first_;
 
-			searching = ((count < kMaxIterations) &&
-						(err_cause != roots::RangeException::relative_to_solution_e::unknown) &&
-						(err_cause != roots::RangeException::relative_to_solution_e::within_range));
+					return result;
+				},
+				false, kMaxPolishIterations, polished) && (polished > -1.0))
+		{
+			result = polished;
 		}
 
-		calc_log.log(info) << "IRR = " << result << endl;
-		cout << calc_log.flush();
+		iterations_ += polisher.GetIterations();
+		evaluations_ += polisher.GetEvaluations();
+		calc_log.MoveFrom(polisher.calc_log);
+
+		residual_ = in_plan.calculateNPV<PRECISION_T>(result);
+		evaluations_++;
+		status_ = solve_status_e::solved;
+
+		LOG_IF_LOGGED(calc_log, info) << "IRR = " << result << " (mixed precision, residual " << residual_ << ")" << endl;
+
+		PrintLog();
 
 		return result;
 	}
 
+	//----------------------------------------------------------------------------------
+	// Write the log to the sink or the console if it is printed.  Writing to a sink that
+	// queues the text (e.g. AsyncFdSink) keeps a search from waiting for the output.
+	template <class PRECISION_T>
+	void	BasicCalculator<PRECISION_T>::PrintLog()
+	{
+		if (print_log_)
+		{
+			if (log_sink_ != nullptr)
+			{
+				std::string	text = calc_log.flush();
+
+				if (!text.empty())
+				{
+					log_sink_->Write(text);
+				}
+			}
+			else
+			{
+				cout << calc_log.flush();
+			}
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	// Instantiate the calculator for each numeric policy.
+	template class BasicCalculator<FloatPrecision>;
+	template class BasicCalculator<DoublePrecision>;
+	template class BasicCalculator<LongDoublePrecision>;
+	template class BasicCalculator<CompensatedDoublePrecision>;
+
 };
 
@@ -0,0 +1,642 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "npv_kernels.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MIRR_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// Compilers other than MSVC only allow the intrinsics in functions marked with the
+// instructions they use.  MSVC supports the AVX-512 intrinsics from VS2017 onwards.
+
+#if defined(_MSC_VER)
+#define MIRR_TARGET_AVX2
+#define MIRR_TARGET_AVX512
+#if (_MSC_VER >= 1911)
+#define MIRR_KERNELS_AVX512 1
+#endif
+#else
+#define MIRR_TARGET_AVX2	__attribute__((target("avx2,fma")))
+#define MIRR_TARGET_AVX512	__attribute__((target("avx512f")))
+#define MIRR_KERNELS_AVX512 1
+#endif
+
+//----------------------------------------------------------------------------------
+// Provide kernels that calculate the NPV of columns of cash flows in double precision.
+
+namespace mirr {
+namespace kernels {
+
+	// The exponent is clamped to the range in which exp() is a finite normal double.
+
+	static const double	kExpMax = 709.0;
+	static const double	kExpMin = -708.0;
+
+	// exp(x) = 2^n * exp(r) where n = round(x / ln2) and r = x - n * ln2.  ln2 is split
+	// so that n * kLn2Hi is exact.  The Taylor series of exp(r) to r^13 is accurate to
+	// about 1 ulp for |r| <= ln2 / 2.
+
+	static const double	kLog2e = 1.4426950408889634074;
+	static const double	kLn2Hi = 6.93145751953125e-1;
+	static const double	kLn2Lo = 1.42860682030941723212e-6;
+	static const int	kExpTerms = 14;
+	static const double	kExpCoefficients[kExpTerms] = {
+		1.0 / 6227020800.0,	// 1/13!
+		1.0 / 479001600.0,	// 1/12!
+		1.0 / 39916800.0,	// 1/11!
+		1.0 / 3628800.0,	// 1/10!
+		1.0 / 362880.0,		// 1/9!
+		1.0 / 40320.0,		// 1/8!
+		1.0 / 5040.0,		// 1/7!
+		1.0 / 720.0,		// 1/6!
+		1.0 / 120.0,		// 1/5!
+		1.0 / 24.0,			// 1/4!
+		1.0 / 6.0,			// 1/3!
+		1.0 / 2.0,			// 1/2!
+		1.0,				// 1/1!
+		1.0					// 1/0!
+	};
+
+	// The number of scales of a grid whose discounts are found from one exp().
+
+	static const std::size_t	kGridBlockSize = 8;
+
+	//----------------------------------------------------------------------------------
+	// Calculate the NPV one cash flow at a time.  This is used when the processor has
+	// no vector instructions and for the cash flows left over after the last full vector.
+	double	NPVScalar(const std::int32_t* in_days, const double* in_amounts, std::size_t in_count, double in_scale)
+	{
+		double	result = 0.0;
+
+		for (std::size_t i = 0; i < in_count; i++)
+		{
+			result += in_amounts[i] * std::exp(-in_scale * static_cast<double>(in_days[i]));
+		}
+
+		return result;
+	}
+
+	double	NPVExponentsScalar(const double* in_exponents, const double* in_amounts, std::size_t in_count, double in_scale)
+	{
+		double	result = 0.0;
+
+		for (std::size_t i = 0; i < in_count; i++)
+		{
+			result += in_amounts[i] * std::exp(-in_scale * in_exponents[i]);
+		}
+
+		return result;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Calculate the NPV at a grid of scales.  The scales are taken a block at a time;
+	// each cash flow's discount at the first scale of a block and its factor from one
+	// scale to the next are found with exp(), and the rest of the block's discounts by
+	// multiplying.  Starting each block with exp() keeps the rounding error of the
+	// products to a few ulps.  A block of one scale needs no factor.
+	void	NPVGridScalar(const double* in_exponents, const double* in_amounts, std::size_t in_count,
+							double in_first_scale, double in_scale_step, std::size_t in_scale_count, double* out_npvs)
+	{
+		for (std::size_t first = 0; first < in_scale_count; first += kGridBlockSize)
+		{
+			std::size_t	block_size = std::min(kGridBlockSize, in_scale_count - first);
+			double		block_scale = in_first_scale + first * in_scale_step;
+			double		sums[kGridBlockSize] = {};
+
+			for (std::size_t i = 0; i < in_count; i++)
+			{
+				double	discount = std::exp(-block_scale * in_exponents[i]);
+				double	factor = (block_size > 1) ? std::exp(-in_scale_step * in_exponents[i]) : 1.0;
+
+				for (std::size_t k = 0; k < block_size; k++)
+				{
+					sums[k] += in_amounts[i] * discount;
+					discount *= factor;
+				}
+			}
+
+			std::copy(sums, sums + block_size, out_npvs + first);
+		}
+	}
+
+#if defined(MIRR_KERNELS_X86)
+
+	//----------------------------------------------------------------------------------
+	// Calculate exp() of four doubles.
+	MIRR_TARGET_AVX2
+	static inline __m256d	ExpAvx2(__m256d in_x)
+	{
+		__m256d	x = _mm256_min_pd(_mm256_max_pd(in_x, _mm256_set1_pd(kExpMin)), _mm256_set1_pd(kExpMax));
+		__m256d	n = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(kLog2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+
+		__m256d	r = _mm256_fnmadd_pd(n, _mm256_set1_pd(kLn2Hi), x);
+		r = _mm256_fnmadd_pd(n, _mm256_set1_pd(kLn2Lo), r);
+
+		__m256d	p = _mm256_set1_pd(kExpCoefficients[0]);
+
+		for (int i = 1; i < kExpTerms; i++)
+		{
+			p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(kExpCoefficients[i]));
+		}
+
+		// Build 2^n directly in the exponent bits of a double.
+
+		__m256i	biased = _mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n)), _mm256_set1_epi64x(1023));
+		__m256d	two_n = _mm256_castsi256_pd(_mm256_slli_epi64(biased, 52));
+
+		return _mm256_mul_pd(p, two_n);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Calculate the NPV four cash flows at a time.  Two accumulators are used so that
+	// consecutive multiply-adds do not wait on each other.
+	MIRR_TARGET_AVX2
+	double	NPVAvx2(const std::int32_t* in_days, const double* in_amounts, std::size_t in_count, double in_scale)
+	{
+		__m256d		scale = _mm256_set1_pd(-in_scale);
+		__m256d		sum_0 = _mm256_setzero_pd();
+		__m256d		sum_1 = _mm256_setzero_pd();
+		std::size_t	i = 0;
+
+		for (; (i + 8) <= in_count; i += 8)
+		{
+			__m256d	days_0 = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in_days + i)));
+			__m256d	days_1 = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in_days + i + 4)));
+
+			sum_0 = _mm256_fmadd_pd(_mm256_loadu_pd(in_amounts + i), ExpAvx2(_mm256_mul_pd(scale, days_0)), sum_0);
+			sum_1 = _mm256_fmadd_pd(_mm256_loadu_pd(in_amounts + i + 4), ExpAvx2(_mm256_mul_pd(scale, days_1)), sum_1);
+		}
+
+		for (; (i + 4) <= in_count; i += 4)
+		{
+			__m256d	days_0 = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in_days + i)));
+
+			sum_0 = _mm256_fmadd_pd(_mm256_loadu_pd(in_amounts + i), ExpAvx2(_mm256_mul_pd(scale, days_0)), sum_0);
+		}
+
+		sum_0 = _mm256_add_pd(sum_0, sum_1);
+
+		__m128d	sum_2 = _mm_add_pd(_mm256_castpd256_pd128(sum_0), _mm256_extractf128_pd(sum_0, 1));
+		double	result = _mm_cvtsd_f64(_mm_add_sd(sum_2, _mm_unpackhi_pd(sum_2, sum_2)));
+
+		return result + NPVScalar(in_days + i, in_amounts + i, in_count - i, in_scale);
+	}
+
+	MIRR_TARGET_AVX2
+	double	NPVExponentsAvx2(const double* in_exponents, const double* in_amounts, std::size_t in_count, double in_scale)
+	{
+		__m256d		scale = _mm256_set1_pd(-in_scale);
+		__m256d		sum_0 = _mm256_setzero_pd();
+		__m256d		sum_1 = _mm256_setzero_pd();
+		std::size_t	i = 0;
+
+		for (; (i + 8) <= in_count; i += 8)
+		{
+			sum_0 = _mm256_fmadd_pd(_mm256_loadu_pd(in_amounts + i), ExpAvx2(_mm256_mul_pd(scale, _mm256_loadu_pd(in_exponents + i))), sum_0);
+			sum_1 = _mm256_fmadd_pd(_mm256_loadu_pd(in_amounts + i + 4), ExpAvx2(_mm256_mul_pd(scale, _mm256_loadu_pd(in_exponents + i + 4))), sum_1);
+		}
+
+		for (; (i + 4) <= in_count; i += 4)
+		{
+			sum_0 = _mm256_fmadd_pd(_mm256_loadu_pd(in_amounts + i), ExpAvx2(_mm256_mul_pd(scale, _mm256_loadu_pd(in_exponents + i))), sum_0);
+		}
+
+		sum_0 = _mm256_add_pd(sum_0, sum_1);
+
+		__m128d	sum_2 = _mm_add_pd(_mm256_castpd256_pd128(sum_0), _mm256_extractf128_pd(sum_0, 1));
+		double	result = _mm_cvtsd_f64(_mm_add_sd(sum_2, _mm_unpackhi_pd(sum_2, sum_2)));
+
+		return result + NPVExponentsScalar(in_exponents + i, in_amounts + i, in_count - i, in_scale);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Calculate the NPV at a grid of scales as for the scalar kernel with four cash flows
+	// in the lanes.  The cash flows left over after the last full vector use the scalar
+	// kernel.
+	MIRR_TARGET_AVX2
+	void	NPVGridAvx2(const double* in_exponents, const double* in_amounts, std::size_t in_count,
+							double in_first_scale, double in_scale_step, std::size_t in_scale_count, double* out_npvs)
+	{
+		std::size_t	vector_count = in_count - (in_count % 4);
+		__m256d		step = _mm256_set1_pd(-in_scale_step);
+
+		for (std::size_t first = 0; first < in_scale_count; first += kGridBlockSize)
+		{
+			std::size_t	block_size = std::min(kGridBlockSize, in_scale_count - first);
+			double		block_scale = in_first_scale + first * in_scale_step;
+			__m256d		scale = _mm256_set1_pd(-block_scale);
+			__m256d		sums[kGridBlockSize];
+
+			for (std::size_t k = 0; k < kGridBlockSize; k++)
+			{
+				sums[k] = _mm256_setzero_pd();
+			}
+
+			for (std::size_t i = 0; i < vector_count; i += 4)
+			{
+				__m256d	exponents = _mm256_loadu_pd(in_exponents + i);
+				__m256d	amounts = _mm256_loadu_pd(in_amounts + i);
+				__m256d	discount = ExpAvx2(_mm256_mul_pd(scale, exponents));
+				__m256d	factor = (block_size > 1) ? ExpAvx2(_mm256_mul_pd(step, exponents)) : _mm256_set1_pd(1.0);
+
+				for (std::size_t k = 0; k < block_size; k++)
+				{
+					sums[k] = _mm256_fmadd_pd(amounts, discount, sums[k]);
+					discount = _mm256_mul_pd(discount, factor);
+				}
+			}
+
+			// Add the lanes of each sum: the halves first, then the pair left.
+
+			for (std::size_t k = 0; k < block_size; k++)
+			{
+				__m128d	pair = _mm_add_pd(_mm256_castpd256_pd128(sums[k]), _mm256_extractf128_pd(sums[k], 1));
+
+				out_npvs[first + k] = _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+			}
+		}
+
+		if (vector_count < in_count)
+		{
+			double	remainder[kGridBlockSize];
+
+			for (std::size_t first = 0; first < in_scale_count; first += kGridBlockSize)
+			{
+				std::size_t	block_size = std::min(kGridBlockSize, in_scale_count - first);
+
+				NPVGridScalar(in_exponents + vector_count, in_amounts + vector_count, in_count - vector_count,
+								in_first_scale + first * in_scale_step, in_scale_step, block_size, remainder);
+
+				for (std::size_t k = 0; k < block_size; k++)
+				{
+					out_npvs[first + k] += remainder[k];
+				}
+			}
+		}
+	}
+
+#else
+
+	double	NPVAvx2(const std::int32_t* in_days, const double* in_amounts, std::size_t in_count, double in_scale)
+	{
+		return NPVScalar(in_days, in_amounts, in_count, in_scale);
+	}
+
+	double	NPVExponentsAvx2(const double* in_exponents, const double* in_amounts, std::size_t in_count, double in_scale)
+	{
+		return NPVExponentsScalar(in_exponents, in_amounts, in_count, in_scale);
+	}
+
+	void	NPVGridAvx2(const double* in_exponents, const double* in_amounts, std::size_t in_count,
+							double in_first_scale, double in_scale_step, std::size_t in_scale_count, double* out_npvs)
+	{
+		NPVGridScalar(in_exponents, in_amounts, in_count, in_first_scale, in_scale_step, in_scale_count, out_npvs);
+	}
+
+#endif
+
+#if defined(MIRR_KERNELS_X86) && defined(MIRR_KERNELS_AVX512)
+
+	//----------------------------------------------------------------------------------
+	// Calculate exp() of eight doubles.  scalef applies the 2^n directly.
+	MIRR_TARGET_AVX512
+	static inline __m512d	ExpAvx512(__m512d in_x)
+	{
+		__m512d	x = _mm512_min_pd(_mm512_max_pd(in_x, _mm512_set1_pd(kExpMin)), _mm512_set1_pd(kExpMax));
+		__m512d	n = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(kLog2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+
+		__m512d	r = _mm512_fnmadd_pd(n, _mm512_set1_pd(kLn2Hi), x);
+		r = _mm512_fnmadd_pd(n, _mm512_set1_pd(kLn2Lo), r);
+
+		__m512d	p = _mm512_set1_pd(kExpCoefficients[0]);
+
+		for (int i = 1; i < kExpTerms; i++)
+		{
+			p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(kExpCoefficients[i]));
+		}
+
+		return _mm512_scalef_pd(p, n);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Calculate the NPV eight cash flows at a time.  The cash flows left over after the
+	// last full vector are loaded with a mask rather than calculated one at a time.
+	MIRR_TARGET_AVX512
+	double	NPVAvx512(const std::int32_t* in_days, const double* in_amounts, std::size_t in_count, double in_scale)
+	{
+		__m512d		scale = _mm512_set1_pd(-in_scale);
+		__m512d		sum_0 = _mm512_setzero_pd();
+		__m512d		sum_1 = _mm512_setzero_pd();
+		std::size_t	i = 0;
+
+		for (; (i + 16) <= in_count; i += 16)
+		{
+			__m512d	days_0 = _mm512_cvtepi32_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in_days + i)));
+			__m512d	days_1 = _mm512_cvtepi32_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in_days + i + 8)));
+
+			sum_0 = _mm512_fmadd_pd(_mm512_loadu_pd(in_amounts + i), ExpAvx512(_mm512_mul_pd(scale, days_0)), sum_0);
+			sum_1 = _mm512_fmadd_pd(_mm512_loadu_pd(in_amounts + i + 8), ExpAvx512(_mm512_mul_pd(scale, days_1)), sum_1);
+		}
+
+		for (; i < in_count; i += 8)
+		{
+			std::size_t	remaining = in_count - i;
+			__mmask8	mask = (remaining >= 8) ? static_cast<__mmask8>(0xFF) : static_cast<__mmask8>((1u << remaining) - 1);
+
+			__m512i	days_loaded = _mm512_maskz_loadu_epi32(static_cast<__mmask16>(mask), in_days + i);
+			__m512d	days_0 = _mm512_cvtepi32_pd(_mm512_castsi512_si256(days_loaded));
+			__m512d	amounts_0 = _mm512_maskz_loadu_pd(mask, in_amounts + i);
+
+			sum_0 = _mm512_fmadd_pd(amounts_0, ExpAvx512(_mm512_mul_pd(scale, days_0)), sum_0);
+		}
+
+		return _mm512_reduce_add_pd(_mm512_add_pd(sum_0, sum_1));
+	}
+
+	MIRR_TARGET_AVX512
+	double	NPVExponentsAvx512(const double* in_exponents, const double* in_amounts, std::size_t in_count, double in_scale)
+	{
+		__m512d		scale = _mm512_set1_pd(-in_scale);
+		__m512d		sum_0 = _mm512_setzero_pd();
+		__m512d		sum_1 = _mm512_setzero_pd();
+		std::size_t	i = 0;
+
+		for (; (i + 16) <= in_count; i += 16)
+		{
+			sum_0 = _mm512_fmadd_pd(_mm512_loadu_pd(in_amounts + i), ExpAvx512(_mm512_mul_pd(scale, _mm512_loadu_pd(in_exponents + i))), sum_0);
+			sum_1 = _mm512_fmadd_pd(_mm512_loadu_pd(in_amounts + i + 8), ExpAvx512(_mm512_mul_pd(scale, _mm512_loadu_pd(in_exponents + i + 8))), sum_1);
+		}
+
+		for (; i < in_count; i += 8)
+		{
+			std::size_t	remaining = in_count - i;
+			__mmask8	mask = (remaining >= 8) ? static_cast<__mmask8>(0xFF) : static_cast<__mmask8>((1u << remaining) - 1);
+
+			__m512d	exponents_0 = _mm512_maskz_loadu_pd(mask, in_exponents + i);
+			__m512d	amounts_0 = _mm512_maskz_loadu_pd(mask, in_amounts + i);
+
+			sum_0 = _mm512_fmadd_pd(amounts_0, ExpAvx512(_mm512_mul_pd(scale, exponents_0)), sum_0);
+		}
+
+		return _mm512_reduce_add_pd(_mm512_add_pd(sum_0, sum_1));
+	}
+
+	//----------------------------------------------------------------------------------
+	// Calculate the NPV at a grid of scales as for AVX2 with eight cash flows in the
+	// lanes.  The cash flows left over after the last full vector are loaded with a mask.
+	MIRR_TARGET_AVX512
+	void	NPVGridAvx512(const double* in_exponents, const double* in_amounts, std::size_t in_count,
+							double in_first_scale, double in_scale_step, std::size_t in_scale_count, double* out_npvs)
+	{
+		__m512d	step = _mm512_set1_pd(-in_scale_step);
+
+		for (std::size_t first = 0; first < in_scale_count; first += kGridBlockSize)
+		{
+			std::size_t	block_size = std::min(kGridBlockSize, in_scale_count - first);
+			double		block_scale = in_first_scale + first * in_scale_step;
+			__m512d		scale = _mm512_set1_pd(-block_scale);
+			__m512d		sums[kGridBlockSize];
+
+			for (std::size_t k = 0; k < kGridBlockSize; k++)
+			{
+				sums[k] = _mm512_setzero_pd();
+			}
+
+			for (std::size_t i = 0; i < in_count; i += 8)
+			{
+				std::size_t	remaining = in_count - i;
+				__mmask8	mask = (remaining >= 8) ? static_cast<__mmask8>(0xFF) : static_cast<__mmask8>((1u << remaining) - 1);
+				__m512d		exponents = _mm512_maskz_loadu_pd(mask, in_exponents + i);
+				__m512d		amounts = _mm512_maskz_loadu_pd(mask, in_amounts + i);
+				__m512d		discount = ExpAvx512(_mm512_mul_pd(scale, exponents));
+				__m512d		factor = (block_size > 1) ? ExpAvx512(_mm512_mul_pd(step, exponents)) : _mm512_set1_pd(1.0);
+
+				for (std::size_t k = 0; k < block_size; k++)
+				{
+					sums[k] = _mm512_fmadd_pd(amounts, discount, sums[k]);
+					discount = _mm512_mul_pd(discount, factor);
+				}
+			}
+
+			for (std::size_t k = 0; k < block_size; k++)
+			{
+				out_npvs[first + k] = _mm512_reduce_add_pd(sums[k]);
+			}
+		}
+	}
+
+#else
+
+	double	NPVAvx512(const std::int32_t* in_days, const double* in_amounts, std::size_t in_count, double in_scale)
+	{
+		return NPVAvx2(in_days, in_amounts, in_count, in_scale);
+	}
+
+	double	NPVExponentsAvx512(const double* in_exponents, const double* in_amounts, std::size_t in_count, double in_scale)
+	{
+		return NPVExponentsAvx2(in_exponents, in_amounts, in_count, in_scale);
+	}
+
+	void	NPVGridAvx512(const double* in_exponents, const double* in_amounts, std::size_t in_count,
+							double in_first_scale, double in_scale_step, std::size_t in_scale_count, double* out_npvs)
+	{
+		NPVGridAvx2(in_exponents, in_amounts, in_count, in_first_scale, in_scale_step, in_scale_count, out_npvs);
+	}
+
+#endif
+
+#if defined(MIRR_KERNELS_X86)
+
+	//----------------------------------------------------------------------------------
+	// Read the registers returned by the CPUID instruction for a leaf and sub-leaf.
+	static void	ReadCPUID(unsigned in_leaf, unsigned in_sub_leaf, unsigned out_registers[4])
+	{
+#if defined(_MSC_VER)
+		int	registers[4] = { 0, 0, 0, 0 };
+		__cpuidex(registers, static_cast<int>(in_leaf), static_cast<int>(in_sub_leaf));
+		for (int i = 0; i < 4; i++)
+		{
+			out_registers[i] = static_cast<unsigned>(registers[i]);
+		}
+#else
+		__cpuid_count(in_leaf, in_sub_leaf, out_registers[0], out_registers[1], out_registers[2], out_registers[3]);
+#endif
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return which register states the operating system saves on a context switch.
+	static unsigned long long	ReadXCR0()
+	{
+#if defined(_MSC_VER)
+		return _xgetbv(0);
+#else
+		unsigned	eax = 0;
+		unsigned	edx = 0;
+		__asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+	}
+
+#endif
+
+	//----------------------------------------------------------------------------------
+	// Return the widest instruction set that both the processor and this build support.
+	// The processor flags are not enough on their own: the operating system must also
+	// save the wider registers.
+	instruction_set_e	DetectInstructionSet()
+	{
+		instruction_set_e	result = instruction_set_e::scalar;
+
+#if defined(MIRR_KERNELS_X86)
+		unsigned	registers[4] = { 0, 0, 0, 0 };
+
+		ReadCPUID(0, 0, registers);
+		unsigned	max_leaf = registers[0];
+
+		if (max_leaf < 7)
+		{
+			return result;
+		}
+
+		ReadCPUID(1, 0, registers);
+		bool	has_osxsave = ((registers[2] & (1u << 27)) != 0);
+		bool	has_fma = ((registers[2] & (1u << 12)) != 0);
+
+		if (!has_osxsave)
+		{
+			return result;
+		}
+
+		unsigned long long	xcr0 = ReadXCR0();
+		bool	os_saves_ymm = ((xcr0 & 0x06) == 0x06);
+		bool	os_saves_zmm = ((xcr0 & 0xE6) == 0xE6);
+
+		ReadCPUID(7, 0, registers);
+		bool	has_avx2 = ((registers[1] & (1u << 5)) != 0);
+		bool	has_avx512f = ((registers[1] & (1u << 16)) != 0);
+
+		if (has_avx2 && has_fma && os_saves_ymm)
+		{
+			result = instruction_set_e::avx2;
+		}
+
+#if defined(MIRR_KERNELS_AVX512)
+		if (has_avx512f && os_saves_zmm)
+		{
+			result = instruction_set_e::avx512;
+		}
+#endif
+#endif
+
+		return result;
+	}
+
+	//----------------------------------------------------------------------------------
+	// The instruction set in use.  It is detected the first time a kernel is requested.
+
+	static const int				kNotDetected = -1;
+	static std::atomic<int>			instruction_set_in_use(kNotDetected);
+
+	//----------------------------------------------------------------------------------
+	// Return the instruction set of the kernel currently in use.
+	instruction_set_e	GetInstructionSet()
+	{
+		int	instruction_set = instruction_set_in_use.load(std::memory_order_relaxed);
+
+		if (instruction_set == kNotDetected)
+		{
+			instruction_set = DetectInstructionSet();
+			instruction_set_in_use.store(instruction_set, std::memory_order_relaxed);
+		}
+
+		return static_cast<instruction_set_e>(instruction_set);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Use the kernel for a particular instruction set (e.g. to compare them).
+	void	SetInstructionSet(instruction_set_e in_instruction_set)
+	{
+		instruction_set_e	detected = DetectInstructionSet();
+
+		if (in_instruction_set > detected)
+		{
+			in_instruction_set = detected;
+		}
+
+		instruction_set_in_use.store(in_instruction_set, std::memory_order_relaxed);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return the kernel for the instruction set in use.
+	npv_kernel_t	GetNPVKernel()
+	{
+		switch (GetInstructionSet())
+		{
+		case instruction_set_e::avx512:
+			return &NPVAvx512;
+		case instruction_set_e::avx2:
+			return &NPVAvx2;
+		case instruction_set_e::scalar:
+			return &NPVScalar;
+		}
+
+		return &NPVScalar;
+	}
+
+	npv_exponent_kernel_t	GetNPVExponentKernel()
+	{
+		switch (GetInstructionSet())
+		{
+		case instruction_set_e::avx512:
+			return &NPVExponentsAvx512;
+		case instruction_set_e::avx2:
+			return &NPVExponentsAvx2;
+		case instruction_set_e::scalar:
+			return &NPVExponentsScalar;
+		}
+
+		return &NPVExponentsScalar;
+	}
+
+	npv_grid_kernel_t	GetNPVGridKernel()
+	{
+		switch (GetInstructionSet())
+		{
+		case instruction_set_e::avx512:
+			return &NPVGridAvx512;
+		case instruction_set_e::avx2:
+			return &NPVGridAvx2;
+		case instruction_set_e::scalar:
+			return &NPVGridScalar;
+		}
+
+		return &NPVGridScalar;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return the name of an instruction set for reporting.
+	const char*	InstructionSetName(instruction_set_e in_instruction_set)
+	{
+		switch (in_instruction_set)
+		{
+		case instruction_set_e::avx512:
+			return "avx512";
+		case instruction_set_e::avx2:
+			return "avx2";
+		case instruction_set_e::scalar:
+			return "scalar";
+		}
+
+		return "unknown";
+	}
+
+}
+}
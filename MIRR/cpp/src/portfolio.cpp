@@ -0,0 +1,112 @@
+#include <algorithm>
+
+#include "portfolio.h"
+
+namespace mirr {
+
+	//----------------------------------------------------------------------------------
+	// Take the other portfolio's columns, leaving it empty.  Moving the vectors keeps
+	// their memory so the column pointers stay valid.
+	Portfolio::Portfolio(Portfolio&& io_other)
+		: columns_(io_other.columns_), storage_(std::move(io_other.storage_)), owner_(std::move(io_other.owner_))
+	{
+		io_other.clear();
+	}
+
+	Portfolio&	Portfolio::operator=(Portfolio&& io_other)
+	{
+		if (this != &io_other)
+		{
+			columns_ = io_other.columns_;
+			storage_ = std::move(io_other.storage_);
+			owner_ = std::move(io_other.owner_);
+
+			io_other.clear();
+		}
+
+		return *this;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Take the columns built in memory.  Moving the vectors keeps their memory so the
+	// column pointers stay valid if the portfolio is moved.
+	void	Portfolio::Assign(PortfolioStorage&& in_storage)
+	{
+		owner_.reset();
+		storage_ = std::move(in_storage);
+
+		columns_ = PortfolioColumns();
+		columns_.offsets_ = storage_.offsets_.data();
+		columns_.days_ = storage_.days_.data();
+		columns_.amounts_ = storage_.amounts_.data();
+		columns_.start_dates_ = storage_.start_dates_.data();
+		columns_.id_offsets_ = storage_.id_offsets_.data();
+		columns_.ids_ = storage_.ids_.data();
+		columns_.account_count_ = storage_.start_dates_.size();
+	}
+
+	//----------------------------------------------------------------------------------
+	// Use columns held elsewhere.
+	void	Portfolio::Attach(const PortfolioColumns& in_columns, std::shared_ptr<const void> in_owner)
+	{
+		storage_ = PortfolioStorage();
+		columns_ = in_columns;
+		owner_ = in_owner;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Remove all of the accounts.
+	void	Portfolio::clear()
+	{
+		columns_ = PortfolioColumns();
+		storage_ = PortfolioStorage();
+		owner_.reset();
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return the total number of cash flows.
+	std::size_t	Portfolio::GetCashFlowCount() const
+	{
+		if (columns_.account_count_ == 0)
+		{
+			return 0;
+		}
+
+		return static_cast<std::size_t>(columns_.offsets_[columns_.account_count_]);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return a view of one account's cash flows.  Only the double amounts are stored so
+	// the view has no long double amounts.  The view has the account's start date so a
+	// plan built from it can find a grid of months.
+	CashFlowView	Portfolio::GetView(std::size_t in_account) const
+	{
+		CashFlowView	view;
+		std::size_t		first = static_cast<std::size_t>(columns_.offsets_[in_account]);
+		std::size_t		last = static_cast<std::size_t>(columns_.offsets_[in_account + 1]);
+
+		view.days_ = columns_.days_ + first;
+		view.amounts_ = nullptr;
+		view.amounts_double_ = columns_.amounts_ + first;
+		view.size_ = last - first;
+		view.start_date_ = columns_.start_dates_ + in_account;
+
+		if (view.size_ > 0)
+		{
+			view.last_day_ = *std::max_element(view.days_, view.days_ + view.size_);
+		}
+
+		return view;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return an account's id.
+	std::string	Portfolio::GetAccountId(std::size_t in_account) const
+	{
+		std::size_t	first = static_cast<std::size_t>(columns_.id_offsets_[in_account]);
+		std::size_t	last = static_cast<std::size_t>(columns_.id_offsets_[in_account + 1]);
+
+		return std::string(columns_.ids_ + first, last - first);
+	}
+
+};
@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <cmath>
+
+#include "rate_roots.h"
+#include "roots.h"
+
+namespace mirr {
+
+	//----------------------------------------------------------------------------------
+	// An interval of log(1 + rate) in which the NPV changes sign, refined by the Illinois
+	// variant of false position so neither end stays fixed for long.
+	struct RootInterval {
+		double	low_ = 0.0;
+		double	high_ = 0.0;
+		double	low_npv_ = 0.0;
+		double	high_npv_ = 0.0;
+		double	estimate_ = 0.0;
+		int		kept_side_ = 0;		// Which end was kept by the last step: -1 low, 1 high.
+		long	evaluations_ = 0;
+		bool	converged_ = false;
+	};
+
+	//----------------------------------------------------------------------------------
+	// Return -1, 0 or 1 for the sign of a value.
+	static int	Sign(double in_value)
+	{
+		return (in_value > 0.0) ? 1 : ((in_value < 0.0) ? -1 : 0);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Scan, refine and polish.  The scan uses the double precision grid kernel and the
+	// refining the double precision kernel, both in log(1 + rate); the polishing uses the full precision NPV and its
+	// derivative in the rate itself.
+	RateRoots	FindRates(const CashFlowPlan& in_plan, const RootScanOptions& in_options)
+	{
+		static const double	kTolerance = 1e-13;
+		static const long	kMaxPolishIterations = 4;
+
+		RateRoots	result;
+
+		result.sign_changes_ = in_plan.GetSignChanges();
+
+		if (!in_plan.HasRoot() || (in_options.grid_points_ < 2) || !(in_options.low_rate_ > -1.0) ||
+			!(in_options.high_rate_ > in_options.low_rate_))
+		{
+			return result;
+		}
+
+		// Scan the grid.
+
+		std::size_t			points = in_options.grid_points_;
+		double				periods = static_cast<double>(in_plan.GetPeriodsInRange());
+		double				log_low = static_cast<double>(std::log1p(in_options.low_rate_)) / periods;
+		double				log_high = static_cast<double>(std::log1p(in_options.high_rate_)) / periods;
+		double				log_step = (log_high - log_low) / (points - 1);
+		std::vector<double>	logs(points);
+		std::vector<double>	rates;
+		std::vector<double>	npvs(points);
+
+		for (std::size_t g = 0; g < points; g++)
+		{
+			logs[g] = log_low + log_step * g;
+		}
+
+		in_plan.calculateNPVGridDouble(log_low, log_step, points, npvs.data());
+		result.passes_ = 1;
+
+		std::vector<RootInterval>	intervals;
+		std::vector<double>			exact;
+
+		for (std::size_t g = 0; g < points; g++)
+		{
+			if (npvs[g] == 0.0)
+			{
+				exact.push_back(logs[g]);
+			}
+			else if ((g + 1 < points) && (Sign(npvs[g]) * Sign(npvs[g + 1]) < 0))
+			{
+				RootInterval	interval;
+
+				interval.low_ = logs[g];
+				interval.high_ = logs[g + 1];
+				interval.low_npv_ = npvs[g];
+				interval.high_npv_ = npvs[g + 1];
+				interval.estimate_ = interval.low_;
+				intervals.push_back(interval);
+			}
+		}
+
+		// Refine the intervals together.  Each step takes a false position estimate in
+		// every interval that has not converged and calculates the NPV at all of them.
+		// When the same end is kept twice its NPV is halved so the estimates approach the
+		// root from both sides.
+
+		std::vector<std::size_t>	active;
+
+		for (long iteration = 0; iteration < in_options.max_iterations_; iteration++)
+		{
+			active.clear();
+			rates.clear();
+
+			for (std::size_t j = 0; j < intervals.size(); j++)
+			{
+				RootInterval&	interval = intervals[j];
+
+				if (interval.converged_)
+				{
+					continue;
+				}
+
+				interval.estimate_ = (interval.low_ * interval.high_npv_ - interval.high_ * interval.low_npv_)
+										/ (interval.high_npv_ - interval.low_npv_);
+
+				if (!(interval.estimate_ > interval.low_) || !(interval.estimate_ < interval.high_))
+				{
+					interval.estimate_ = 0.5 * (interval.low_ + interval.high_);
+				}
+
+				active.push_back(j);
+				rates.push_back(std::expm1(interval.estimate_));
+			}
+
+			if (active.empty())
+			{
+				break;
+			}
+
+			npvs.resize(rates.size());
+			in_plan.calculateNPVDouble(rates.data(), rates.size(), npvs.data());
+			result.passes_++;
+
+			for (std::size_t a = 0; a < active.size(); a++)
+			{
+				RootInterval&	interval = intervals[active[a]];
+				double			npv = npvs[a];
+
+				interval.evaluations_++;
+
+				if (Sign(npv) == 0)
+				{
+					interval.low_ = interval.estimate_;
+					interval.high_ = interval.estimate_;
+				}
+				else if (Sign(npv) == Sign(interval.low_npv_))
+				{
+					interval.low_ = interval.estimate_;
+					interval.low_npv_ = npv;
+
+					if (interval.kept_side_ == 1)
+					{
+						interval.high_npv_ *= 0.5;
+					}
+					interval.kept_side_ = 1;
+				}
+				else
+				{
+					interval.high_ = interval.estimate_;
+					interval.high_npv_ = npv;
+
+					if (interval.kept_side_ == -1)
+					{
+						interval.low_npv_ *= 0.5;
+					}
+					interval.kept_side_ = -1;
+				}
+
+				interval.converged_ = ((interval.high_ - interval.low_) <= kTolerance * (1.0 + std::abs(interval.estimate_)));
+			}
+		}
+
+		// Polish each estimate in full precision.  The polished rate is only used if it
+		// stays in the interval, so two estimates cannot polish to the same root.
+
+		auto	npv_derivatives = [&in_plan](const Rate_t& in_rate) -> roots::Derivatives<Rate_t> {
+			roots::Derivatives<Rate_t>	derivatives;
+			NPVDerivatives				npv = in_plan.calculateNPVDerivatives(in_rate, false);
+
+			derivatives.value_ = npv.npv_;
+			derivatives.first_ = npv.first_;
+
+			return derivatives;
+		};
+
+		for (double log_rate : exact)
+		{
+			RateRoot	root;
+
+			root.rate_ = std::expm1(static_cast<Rate_t>(log_rate));
+			root.npv_ = in_plan.calculateNPV(root.rate_);
+			root.status_ = solve_status_e::solved;
+			root.evaluations_ = 1;
+			result.roots_.push_back(root);
+		}
+
+		for (RootInterval& interval : intervals)
+		{
+			roots::RootFinder<Rate_t>	root_finder;
+			RateRoot					root;
+			Rate_t						polished = 0.0;
+			Rate_t						estimate = std::expm1(static_cast<Rate_t>(0.5 * (interval.low_ + interval.high_)));
+
+			root.flags_ = root_flag_e::root_sign_change;
+			root.rate_ = estimate;
+			root.status_ = interval.converged_ ? solve_status_e::solved : solve_status_e::failed;
+
+			if (root_finder.PolishRoot(estimate, npv_derivatives, false, kMaxPolishIterations, polished) &&
+				(std::log1p(polished) >= interval.low_ - kTolerance) && (std::log1p(polished) <= interval.high_ + kTolerance))
+			{
+				root.rate_ = polished;
+				root.status_ = solve_status_e::solved;
+				root.flags_ |= root_flag_e::root_polished;
+			}
+
+			root.npv_ = in_plan.calculateNPV(root.rate_);
+			root.evaluations_ = interval.evaluations_ + root_finder.GetEvaluations() + 1;
+			result.roots_.push_back(root);
+		}
+
+		std::sort(result.roots_.begin(), result.roots_.end(),
+			[](const RateRoot& in_lhs, const RateRoot& in_rhs) { return in_lhs.rate_ < in_rhs.rate_; });
+
+		// Mark the rate the caller selected.
+
+		const Rate_t&	selected = in_options.selected_rate_;
+
+		if (!std::isnan(selected))
+		{
+			RateRoot*	nearest = nullptr;
+
+			for (RateRoot& root : result.roots_)
+			{
+				if ((nearest == nullptr) || (std::abs(root.rate_ - selected) < std::abs(nearest->rate_ - selected)))
+				{
+					nearest = &root;
+				}
+			}
+
+			if ((nearest != nullptr) && (std::abs(nearest->rate_ - selected) <= 1e-6 * (1.0 + std::abs(selected))))
+			{
+				nearest->flags_ |= root_flag_e::root_selected;
+			}
+		}
+
+		return result;
+	}
+
+};
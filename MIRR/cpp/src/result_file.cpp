@@ -0,0 +1,156 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "mapped_file.h"
+#include "result_file.h"
+
+namespace mirr {
+
+	static const char			kMagic[8] = { 'M', 'I', 'R', 'R', 'R', 'E', 'S', '\0' };
+	static const std::uint32_t	kVersion = 1;
+	static const std::uint32_t	kByteOrder = 0x01020304;
+	static const std::uint64_t	kRecordPosition = 64;
+
+	//----------------------------------------------------------------------------------
+	// Write the results as CSV.  The lines are formatted into a buffer that is written a
+	// block at a time rather than formatting each field through the stream.
+	void	WriteResultsCsv(std::ostream& io_stream, const Portfolio& in_portfolio, const std::vector<BatchResult>& in_results)
+	{
+		static const std::size_t	kBlockSize = 1 << 16;
+
+		std::string	buffer;
+		char		line[64];
+
+		buffer.reserve(kBlockSize + 512);
+		buffer.append("account_id,rate,status,iterations,evaluations\n");
+
+		for (std::size_t i = 0; (i < in_results.size()) && (i < in_portfolio.size()); i++)
+		{
+			const BatchResult&	result = in_results[i];
+
+			buffer.append(in_portfolio.GetAccountId(i));
+
+			int	length = std::snprintf(line, sizeof(line), ",%.17g,%s,%d,%d\n", static_cast<double>(result.rate_),
+										SolveStatusName(result.status_), result.iterations_, result.evaluations_);
+
+			buffer.append(line, static_cast<std::size_t>(length));
+
+			if (buffer.size() >= kBlockSize)
+			{
+				io_stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+				buffer.clear();
+			}
+		}
+
+		io_stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+		io_stream.flush();
+	}
+
+	//----------------------------------------------------------------------------------
+	// Write the results as a binary file.
+	file_status_e	WriteResultsBinary(const std::string& in_path, const std::vector<BatchResult>& in_results)
+	{
+		std::vector<ResultRecord>	records(in_results.size());
+
+		for (std::size_t i = 0; i < in_results.size(); i++)
+		{
+			ResultRecord&	record = records[i];
+
+			std::memset(&record, 0, sizeof(record));
+			record.rate_ = static_cast<double>(in_results[i].rate_);
+			record.status_ = static_cast<std::int32_t>(in_results[i].status_);
+			record.iterations_ = in_results[i].iterations_;
+			record.evaluations_ = in_results[i].evaluations_;
+			record.nanoseconds_ = in_results[i].nanoseconds_;
+		}
+
+		ResultFileHeader	header;
+
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic_, kMagic, sizeof(kMagic));
+		header.version_ = kVersion;
+		header.byte_order_ = kByteOrder;
+		header.count_ = records.size();
+		header.record_position_ = kRecordPosition;
+		header.record_size_ = sizeof(ResultRecord);
+		header.checksum_ = CalculateChecksum(records.data(), records.size() * sizeof(ResultRecord));
+		header.header_checksum_ = CalculateChecksum(&header, offsetof(ResultFileHeader, header_checksum_));
+
+		std::ofstream	file(in_path, std::ios::binary | std::ios::trunc);
+
+		if (!file)
+		{
+			return file_status_e::file_not_opened;
+		}
+
+		static const char	kPadding[kRecordPosition] = {};
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(kPadding, static_cast<std::streamsize>(kRecordPosition - sizeof(header)));
+		file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(ResultRecord)));
+		file.close();
+
+		return file ? file_status_e::file_ok : file_status_e::file_write_failed;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Read the results back from a binary file.
+	file_status_e	ReadResultsBinary(const std::string& in_path, std::vector<BatchResult>& out_results)
+	{
+		MappedFile	file;
+
+		out_results.clear();
+
+		if (!file.Open(in_path))
+		{
+			return file_status_e::file_not_opened;
+		}
+
+		ResultFileHeader	header;
+
+		if (file.size() < sizeof(header))
+		{
+			return file_status_e::file_bad_header;
+		}
+
+		std::memcpy(&header, file.data(), sizeof(header));
+
+		if ((std::memcmp(header.magic_, kMagic, sizeof(kMagic)) != 0) || (header.version_ != kVersion) ||
+			(header.byte_order_ != kByteOrder) || (header.record_size_ != sizeof(ResultRecord)) ||
+			(header.header_checksum_ != CalculateChecksum(&header, offsetof(ResultFileHeader, header_checksum_))))
+		{
+			return file_status_e::file_bad_header;
+		}
+
+		if ((header.record_position_ > file.size()) ||
+			(header.count_ > (file.size() - header.record_position_) / sizeof(ResultRecord)))
+		{
+			return file_status_e::file_bad_layout;
+		}
+
+		const char*	records = file.data() + header.record_position_;
+
+		if (CalculateChecksum(records, static_cast<std::size_t>(header.count_ * sizeof(ResultRecord))) != header.checksum_)
+		{
+			return file_status_e::file_bad_checksum;
+		}
+
+		out_results.resize(static_cast<std::size_t>(header.count_));
+
+		for (std::size_t i = 0; i < out_results.size(); i++)
+		{
+			ResultRecord	record;
+
+			std::memcpy(&record, records + i * sizeof(ResultRecord), sizeof(record));
+			out_results[i].rate_ = record.rate_;
+			out_results[i].status_ = static_cast<solve_status_e>(record.status_);
+			out_results[i].iterations_ = record.iterations_;
+			out_results[i].evaluations_ = record.evaluations_;
+			out_results[i].nanoseconds_ = record.nanoseconds_;
+		}
+
+		return file_status_e::file_ok;
+	}
+
+};
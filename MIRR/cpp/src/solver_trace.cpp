@@ -0,0 +1,99 @@
+#include <iomanip>
+#include <sstream>
+
+#include "solver_trace.h"
+
+namespace roots {
+
+	//----------------------------------------------------------------------------------
+	// Constructor
+	SolverTrace::SolverTrace(std::size_t in_capacity)
+	{
+		Reserve(in_capacity);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Allocate room for a number of records and clear the trace.
+	void	SolverTrace::Reserve(std::size_t in_capacity)
+	{
+		records_.assign(in_capacity, TraceRecord());
+		clear();
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return the number of records held.
+	std::size_t	SolverTrace::size() const
+	{
+		return (recorded_ < records_.size()) ? recorded_ : records_.size();
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return the record at an index, oldest first.  Once the trace has wrapped around
+	// the oldest record is the one that will be overwritten next.
+	const TraceRecord&	SolverTrace::at(std::size_t in_index) const
+	{
+		if (recorded_ <= records_.size())
+		{
+			return records_.at(in_index);
+		}
+
+		return records_.at((next_ + in_index) % records_.size());
+	}
+
+	//----------------------------------------------------------------------------------
+	// Return the name of a RootFinder::methods_available value.
+	const char*	SolverTrace::MethodName(int in_method)
+	{
+		static const char*	kNames[] = { "unknown", "quadratic_interpolation", "secant", "bisection", "newton", "halley" };
+
+		if ((in_method < 0) || (in_method >= static_cast<int>(sizeof(kNames) / sizeof(kNames[0]))))
+		{
+			return "unknown";
+		}
+
+		return kNames[in_method];
+	}
+
+	//----------------------------------------------------------------------------------
+	// Write the records as text in the same layout as the search's debug log.
+	void	SolverTrace::Format(std::ostream& io_output) const
+	{
+		if (GetDropped() > 0)
+		{
+			io_output << "(" << GetDropped() << " earlier steps dropped)" << std::endl;
+		}
+
+		io_output << "Count        CurrEstimate   NPV                  CounterEstimate    NPV            Method" << std::endl;
+		io_output << "-----        ------------   ---                  ---------------    ---            ------" << std::endl;
+
+		for (std::size_t i = 0; i < size(); i++)
+		{
+			const TraceRecord&	record = at(i);
+
+			io_output << record.iteration_ << "     "
+				<< std::fixed << std::setw(15) << std::setprecision(6) << record.estimate_ << "   "
+				<< std::fixed << std::setw(15) << std::setprecision(6) << record.result_ << "   "
+				<< std::fixed << std::setw(15) << std::setprecision(6) << record.counter_estimate_ << "        "
+				<< std::fixed << std::setw(15) << std::setprecision(6) << record.counter_result_ << "   "
+				<< MethodName(record.method_) << " method" << std::endl;
+		}
+	}
+
+	std::string	SolverTrace::ToString() const
+	{
+		std::stringstream	result;
+
+		Format(result);
+
+		return result.str();
+	}
+
+	//----------------------------------------------------------------------------------
+	// Print the trace records to the output stream.
+	std::ostream& operator<<(std::ostream& output, const SolverTrace& in_trace)
+	{
+		in_trace.Format(output);
+		return output;
+	}
+
+}